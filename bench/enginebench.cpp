@@ -0,0 +1,519 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// engine hot paths at 512, 4k and 32k channels.
+// qontrejour-bench -o result.csv,csv for machine readable output,
+// -tickcounter or -perf for other backends.
+
+#include "core/dmxmanager.h"
+#include "core/interpreter.h"
+#include "core/levelkernel.h"
+
+#include <QTest>
+#include <QLoggingCategory>
+
+#define BENCH_CHANNEL_COUNT_MAX 32000 // id is qint16
+#define BENCH_SCRIPT_COMMAND_COUNT 10000
+#define BENCH_SCRIPT_RANGE_SIZE 48
+
+class EngineBench
+    : public QObject
+{
+
+  Q_OBJECT
+
+private :
+
+  QList<DmxChannel *> getL_channel(int t_channelCount) const;
+  void addChannelCountData();
+
+private slots :
+
+  void initTestCase();
+
+  void groupLevelChanged_data(){ addChannelCountData(); }
+  void groupLevelChanged();
+  void channelUpdate_data(){ addChannelCountData(); }
+  void channelUpdate();
+  void goGo_data(){ addChannelCountData(); }
+  void goGo();
+  void patchEdit_data(){ addChannelCountData(); }
+  void patchEdit();
+  void addScene_data(){ addChannelCountData(); }
+  void addScene();
+  void clearScenes_data(){ addChannelCountData(); }
+  void clearScenes();
+  void channelSelection_data(){ addChannelCountData(); }
+  void channelSelection();
+  void levelKernels_data(){ addChannelCountData(); }
+  void levelKernels();
+  void selectedChannelLevels_data(){ addChannelCountData(); }
+  void selectedChannelLevels();
+  void effectWaveform_data(){ addChannelCountData(); }
+  void effectWaveform();
+  void effectEngineUpdate_data(){ addChannelCountData(); }
+  void effectEngineUpdate();
+  void interpreterRecieveData_data(){ addChannelCountData(); }
+  void interpreterRecieveData();
+  void interpreterRunScript_data(){ addChannelCountData(); }
+  void interpreterRunScript();
+
+};
+
+QList<DmxChannel *> EngineBench::getL_channel(int t_channelCount) const
+{
+  QList<DmxChannel *> L_channel;
+  L_channel.reserve(t_channelCount);
+  for (int i = 0;
+       i < t_channelCount;
+       i++)
+  {
+    L_channel.append(MANAGER->getChannel(i));
+  }
+  return L_channel;
+}
+
+void EngineBench::addChannelCountData()
+{
+  QTest::addColumn<int>("channelCount");
+  QTest::newRow("512") << 512;
+  QTest::newRow("4k") << 4096;
+  QTest::newRow("32k") << BENCH_CHANNEL_COUNT_MAX;
+}
+
+void EngineBench::initTestCase()
+{
+  // interpreter and engine debug output would be measured too
+  QLoggingCategory::setFilterRules("default.debug=false");
+
+  // manager only creates DEFAULT_CHANNEL_COUNT channels,
+  // add the others like it does
+  auto rootChannel = MANAGER->getRootChannel();
+  auto outputEngine = MANAGER->getDmxEngine()->getOutputEngine();
+  for (int i = rootChannel->getL_childValueSize();
+       i < BENCH_CHANNEL_COUNT_MAX;
+       i++)
+  {
+    auto channel = ShowArena::instance()->createChannel();
+    channel->setid(i);
+    rootChannel->addChildValue(channel);
+    connect(channel,
+            SIGNAL(levelChanged(id,dmx)),
+            outputEngine,
+            SLOT(onChannelLevelChanged(id,dmx)));
+  }
+  QCOMPARE(MANAGER->getChannelCount(), BENCH_CHANNEL_COUNT_MAX);
+}
+
+// one group on every channel, level changes down to the channels
+void EngineBench::groupLevelChanged()
+{
+  QFETCH(int, channelCount);
+
+  RootValue rootGroup(ValueType::RootChannelGroup);
+  ChannelGroupEngine groupEngine(&rootGroup);
+  connect(&groupEngine,
+          SIGNAL(channelLevelChangedFromGroup(id,dmx)),
+          MANAGER->getDmxEngine()->getChannelEngine(),
+          SLOT(onChannelLevelChangedFromGroup(id,dmx)));
+
+  auto group = ShowArena::instance()->createChannelGroup();
+  group->setid(0);
+  QHash<DmxChannel *, dmx> H_controledChannel_storedLevel;
+  const auto L_channel = getL_channel(channelCount);
+  for (const auto &item
+       : L_channel)
+  {
+    H_controledChannel_storedLevel.insert(item,
+                                          MAX_DMX);
+  }
+  group->setH_controledChannel_storedLevel(H_controledChannel_storedLevel);
+  rootGroup.addChildValue(group);
+  groupEngine.addNewGroup(group);
+
+  dmx level = MAX_DMX;
+  QBENCHMARK
+  {
+    groupEngine.groupLevelChanged(0,
+                                  level);
+    level = level == MAX_DMX ? MAX_DMX / 2 : MAX_DMX;
+  }
+  groupEngine.groupLevelChanged(0,
+                                NULL_DMX);
+  ShowArena::instance()->destroyValue(group);
+}
+
+void EngineBench::channelUpdate()
+{
+  QFETCH(int, channelCount);
+
+  const auto L_channel = getL_channel(channelCount);
+  QBENCHMARK
+  {
+    for (const auto &item
+         : L_channel)
+    {
+      item->update();
+    }
+  }
+}
+
+// step 0 to a scene on every channel. Only building and
+// starting the fades is measured, not the fades themselves
+void EngineBench::goGo()
+{
+  QFETCH(int, channelCount);
+
+  auto cueEngine = MANAGER->getDmxEngine()->getCueEngine();
+  QHash<DmxChannel *, dmx> H_controledChannel_storedLevel;
+  const auto L_channel = getL_channel(channelCount);
+  for (const auto &item
+       : L_channel)
+  {
+    H_controledChannel_storedLevel.insert(item,
+                                          MAX_DMX);
+  }
+  auto scene = cueEngine->createScene(L_channel);
+  scene->setH_controledChannel_storedLevel(H_controledChannel_storedLevel);
+  cueEngine->recordNextCueInMainSeq(scene);
+  // selection only moves when fades are finished
+  cueEngine->setSelectedCueStep(scene->getStepNumber() - 1);
+
+  QBENCHMARK
+  {
+    cueEngine->goGo();
+    cueEngine->stop();
+    cueEngine->clear();
+    disconnect(cueEngine,
+               &QParallelAnimationGroup::finished,
+               nullptr,
+               nullptr);
+  }
+  cueEngine->setSelectedCueStep(0);
+}
+
+// move one output between two channels on a straight patch
+void EngineBench::patchEdit()
+{
+  QFETCH(int, channelCount);
+
+  DmxPatch patch;
+  QMultiMap<id, Uid_Id> MM_patch;
+  for (int i = 0;
+       i < channelCount;
+       i++)
+  {
+    MM_patch.insert(i,
+                    Uid_Id(i / UNIVERSE_OUTPUT_COUNT_DEFAULT,
+                           i % UNIVERSE_OUTPUT_COUNT_DEFAULT));
+  }
+  patch.setMM_patch(MM_patch);
+
+  const Uid_Id lastOutput(MM_patch.last());
+  const id lastChannelId = static_cast<id>(channelCount - 1);
+  QBENCHMARK
+  {
+    patch.addOutputToChannel(0,
+                             lastOutput);
+    patch.addOutputToChannel(lastChannelId,
+                             lastOutput);
+  }
+}
+
+// channelCount empty steps appended to a new sequence
+void EngineBench::addScene()
+{
+  QFETCH(int, channelCount);
+
+  auto showArena = ShowArena::instance();
+  QList<DmxScene *> L_scene;
+  L_scene.reserve(channelCount);
+  for (int i = 0;
+       i < channelCount;
+       i++)
+  {
+    L_scene.append(showArena->createScene());
+  }
+
+  QBENCHMARK
+  {
+    Sequence seq;
+    for (const auto &item
+         : std::as_const(L_scene))
+    {
+      seq.addScene(item);
+    }
+    // seq destroys what it holds, scenes are used again
+    seq.setL_childScene(QList<DmxScene *>{seq.getScene(static_cast<id>(0))});
+  }
+  for (const auto &item
+       : std::as_const(L_scene))
+  {
+    showArena->destroyValue(item);
+  }
+}
+
+// a show of channelCount cues closed at once
+void EngineBench::clearScenes()
+{
+  QFETCH(int, channelCount);
+
+  auto showArena = ShowArena::instance();
+  Sequence seq;
+  QBENCHMARK
+  {
+    for (int i = 0;
+         i < channelCount;
+         i++)
+    {
+      seq.addScene(showArena->createScene());
+    }
+    seq.clearScenes();
+  }
+}
+
+// channelCount ids one by one, as a range, inverted, cleared
+void EngineBench::channelSelection()
+{
+  QFETCH(int, channelCount);
+
+  auto channelEngine = MANAGER->getDmxEngine()->getChannelEngine();
+  QList<id> L_id;
+  L_id.reserve(channelCount);
+  for (int i = 0;
+       i < channelCount;
+       i++)
+  {
+    L_id.append(static_cast<id>(i));
+  }
+
+  QBENCHMARK
+  {
+    channelEngine->addL_idToL_select(L_id);
+    channelEngine->clearSelection();
+    channelEngine->addRangeToL_select(0,
+                                      static_cast<id>(channelCount - 1));
+    channelEngine->removeRangeFromL_select(0,
+                                           static_cast<id>(channelCount / 2));
+    channelEngine->invertSelection();
+    channelEngine->clearSelection();
+  }
+}
+
+// kernels alone on a channelCount column
+void EngineBench::levelKernels()
+{
+  QFETCH(int, channelCount);
+
+  QList<int> L_level(channelCount, MAX_DMX / 2);
+  QList<dmx> L_dmx(channelCount);
+  QList<overdmx> L_offset(channelCount);
+  QBENCHMARK
+  {
+    LevelKernel::add(L_level.data(),
+                     channelCount,
+                     DMX_INCREMENT_DEFAULT);
+    LevelKernel::add(L_level.data(),
+                     channelCount,
+                     -DMX_INCREMENT_DEFAULT);
+    LevelKernel::scale(L_level.data(),
+                       channelCount,
+                       80);
+    LevelKernel::fan(L_level.data(),
+                     channelCount,
+                     NULL_DMX,
+                     MAX_DMX,
+                     FanMode::SymmetricFan);
+    LevelKernel::split(L_level.constData(),
+                       channelCount,
+                       L_dmx.data(),
+                       L_offset.data());
+  }
+}
+
+// +dmx, scale and fan on channelCount selected channels, channels
+// updated once at end of batch
+void EngineBench::selectedChannelLevels()
+{
+  QFETCH(int, channelCount);
+
+  auto channelEngine = MANAGER->getDmxEngine()->getChannelEngine();
+  channelEngine->addRangeToL_select(0,
+                                    static_cast<id>(channelCount - 1));
+  QBENCHMARK
+  {
+    channelEngine->beginBatch();
+    channelEngine->onChannelLevelPlusFromDirectChannel(true,
+                                                       DMX_INCREMENT_DEFAULT);
+    channelEngine->onSelectedChannelListScale(80);
+    channelEngine->onSelectedChannelListFan(NULL_DMX,
+                                            MAX_DMX);
+    channelEngine->endBatch();
+  }
+  channelEngine->onSelectedChannelListAtLevel(NULL_DMX);
+  channelEngine->clearSelection();
+}
+
+// every waveform on a channelCount column, kernel only
+void EngineBench::effectWaveform()
+{
+  QFETCH(int, channelCount);
+
+  QList<float> L_phaseOffset(channelCount);
+  for (int i = 0;
+       i < channelCount;
+       i++)
+  {
+    L_phaseOffset[i] = static_cast<float>(i) / channelCount;
+  }
+  QList<int> L_level(channelCount);
+  float phase = 0.0f;
+  QBENCHMARK
+  {
+    for (int i = SineWave;
+         i < UnknownWaveform;
+         i++)
+    {
+      LevelKernel::waveform(L_level.data(),
+                            L_phaseOffset.constData(),
+                            channelCount,
+                            phase,
+                            0,
+                            static_cast<EffectWaveform>(i),
+                            MAX_DMX);
+    }
+    phase = phase < 0.9f ? phase + 0.1f : 0.0f;
+  }
+}
+
+// one frame : a sine and a relative random over channelCount channels,
+// merged and set on the channels
+void EngineBench::effectEngineUpdate()
+{
+  QFETCH(int, channelCount);
+
+  auto effectEngine = MANAGER->getDmxEngine()->getEffectEngine();
+  QList<id> L_id;
+  L_id.reserve(channelCount);
+  for (int i = 0;
+       i < channelCount;
+       i++)
+  {
+    L_id.append(static_cast<id>(i));
+  }
+  DmxEffect sine(0,
+                 SineWave);
+  sine.setL_channelId(L_id);
+  effectEngine->setEffect(sine);
+  DmxEffect random(1,
+                   RandomWave);
+  random.setSize(MAX_DMX / 4);
+  random.setMergeMode(RelativeEffect);
+  random.setL_channelId(L_id);
+  effectEngine->setEffect(random);
+
+  QBENCHMARK
+  {
+    effectEngine->update();
+  }
+  effectEngine->clear();
+  effectEngine->update(); // channels back to their levels
+}
+
+// "1 Channel <channelCount> Thru 128 @"
+void EngineBench::interpreterRecieveData()
+{
+  QFETCH(int, channelCount);
+
+  auto dmxEngine = MANAGER->getDmxEngine();
+  Interpreter interpreter;
+  connect(&interpreter, &Interpreter::addChannelSelection,
+          dmxEngine, &DmxEngine::onAddChannelSelection);
+  connect(&interpreter, &Interpreter::addChannelRangeSelection,
+          dmxEngine, &DmxEngine::onAddChannelRangeSelection);
+  connect(&interpreter, &Interpreter::setLevel,
+          dmxEngine, &DmxEngine::onSetLevel);
+
+  QList<KeypadButton> L_button;
+  L_button << KeypadButton::One
+           << KeypadButton::Channel;
+  const auto channelCountString = QString::number(channelCount);
+  for (const auto &item
+       : channelCountString)
+  {
+    L_button << static_cast<KeypadButton>(item.digitValue());
+  }
+  L_button << KeypadButton::Thru
+           << KeypadButton::One
+           << KeypadButton::Two
+           << KeypadButton::Eight
+           << KeypadButton::ArobaseDmx;
+
+  QBENCHMARK
+  {
+    for (const auto &item
+         : std::as_const(L_button))
+    {
+      interpreter.recieveData(item);
+    }
+    dmxEngine->getChannelEngine()->clearSelection();
+  }
+}
+
+// BENCH_SCRIPT_COMMAND_COUNT "<n> thru <n + 47> @ 75" over
+// channelCount channels, one batch
+void EngineBench::interpreterRunScript()
+{
+  QFETCH(int, channelCount);
+
+  auto dmxEngine = MANAGER->getDmxEngine();
+  Interpreter interpreter;
+  connect(&interpreter, &Interpreter::addChannelSelection,
+          dmxEngine, &DmxEngine::onAddChannelSelection);
+  connect(&interpreter, &Interpreter::addChannelRangeSelection,
+          dmxEngine, &DmxEngine::onAddChannelRangeSelection);
+  connect(&interpreter, &Interpreter::clearChannelSelection,
+          dmxEngine->getChannelEngine(), &ChannelEngine::clearSelection);
+  connect(&interpreter, &Interpreter::setLevel,
+          dmxEngine, &DmxEngine::onSetLevel);
+  connect(&interpreter, &Interpreter::batchStarted,
+          dmxEngine, &DmxEngine::onBatchStarted);
+  connect(&interpreter, &Interpreter::batchFinished,
+          dmxEngine, &DmxEngine::onBatchFinished);
+
+  QString script;
+  for (int i = 0;
+       i < BENCH_SCRIPT_COMMAND_COUNT;
+       i++)
+  {
+    int first = (i * BENCH_SCRIPT_RANGE_SIZE)
+                % (channelCount - BENCH_SCRIPT_RANGE_SIZE) + 1;
+    script += QString("%1 thru %2 @ 75\n")
+                  .arg(first)
+                  .arg(first + BENCH_SCRIPT_RANGE_SIZE - 1);
+  }
+
+  QBENCHMARK
+  {
+    QCOMPARE(interpreter.runScript(script), BENCH_SCRIPT_COMMAND_COUNT);
+  }
+  dmxEngine->getChannelEngine()->clearSelection();
+}
+
+QTEST_GUILESS_MAIN(EngineBench)
+
+#include "enginebench.moc"
@@ -19,6 +19,13 @@
 #include <QDebug>
 #include <QPropertyAnimation>
 #include "dmxmanager.h"
+#include "networkinput.h"
+#include "latencystats.h"
+#include "trace.h"
+#include "levelkernel.h"
+#include <cstring>
+#include <cmath>
+#include <utility>
 
 /****************************** ChannelGroupEngine ***********************/
 
@@ -88,7 +95,7 @@ bool ChannelGroupEngine::modifyGroup(const id t_groupID)
 
 DmxChannelGroup *ChannelGroupEngine::createChannelGroup(QList<DmxChannel *> t_L_channel)
 {
-  auto newGroup = new DmxChannelGroup(ValueType::ChannelGroup);
+  auto newGroup = ShowArena::instance()->createChannelGroup();
   newGroup->setid(m_rootChannelGroup->getL_childValueSize());
   auto H_controledChannel_storedLevel = QHash<DmxChannel *, dmx>();
   for (const auto item
@@ -105,6 +112,19 @@ DmxChannelGroup *ChannelGroupEngine::createChannelGroup(QList<DmxChannel *> t_L_
   return newGroup;
 }
 
+bool ChannelGroupEngine::setGroupLevel(const id t_groupId,
+                                       const dmx t_level)
+{
+  if (t_groupId < 0
+      || t_groupId >= m_rootChannelGroup->getL_childValueSize())
+  {
+    qWarning() << "can't ChannelGroupEngine::setGroupLevel";
+    return false;
+  }
+  GET_CHANNEL_GROUP(t_groupId)->setLevel(t_level);
+  return true;
+}
+
 void ChannelGroupEngine::addChannelGroup(id t_groupID,
                                          QList<Ch_Id_Dmx> t_L_id_dmx)
 {
@@ -159,6 +179,7 @@ bool ChannelGroupEngine::addChannel(const id t_groupID,
 void ChannelGroupEngine::groupLevelChanged(const id t_groupID,
                                            const dmx t_level)
 {
+  TRACE_SCOPE("ChannelGroupEngine::groupLevelChanged");
   // on chope les values de la key t_groupID
   auto L_Ch_Id_Dmx = m_MM_totalGroup.values(t_groupID);
   for (const auto &item
@@ -450,7 +471,7 @@ void CueEngine::deleteCue(id t_seqId,
 DmxScene *CueEngine::createScene(QList<DmxChannel *> t_L_channel,
                                  sceneID_f t_id)
 {
-  auto newScene = new DmxScene(ValueType::MainScene);
+  auto newScene = ShowArena::instance()->createScene();
   auto H_controledChannel_storedLevel = QHash<DmxChannel *, dmx>();
   for (const auto item
        : std::as_const(t_L_channel))
@@ -471,10 +492,24 @@ void CueEngine::updateScene(QList<DmxChannel *> t_L_channel,
 
 void CueEngine::goGo()
 {
+  TRACE_SCOPE("CueEngine::goGo");
+  // go during a fade : the running one jumps to its end and
+  // selects its cue, then its animations are dropped
+  if (state() == QAbstractAnimation::Running)
+    setCurrentTime(duration());
+  stop();
+  clear();
+
   id fromSceneStep = getSelectedCueStep();
   id toSceneStep = fromSceneStep + 1;
   DmxScene *fromScene = m_L_seq.at(m_mainSeqId)->getScene(fromSceneStep);
   DmxScene *toScene = m_L_seq.at(m_mainSeqId)->getScene(toSceneStep);
+  if (!fromScene
+      || !toScene)
+  {
+    qWarning() << "can't CueEngine::goGo, no next cue";
+    return;
+  }
   QList<id> L_fromChannelId = fromScene->getL_channelId();
   QList<id> L_toChannelId = toScene->getL_channelId();
 
@@ -533,15 +568,28 @@ void CueEngine::goGo()
     anim->setDuration(toScene->getTimeIn() * MS_TO_S);
     addAnimation(anim);
   }
+  // by id : toScene may be replaced and destroyed during the fade
+  auto toSceneId = toScene->getSceneID();
   connect(this,
           &QParallelAnimationGroup::finished,
           this,
-          [=](){m_L_seq.at(m_mainSeqId)->setSelectedStepId(toSceneStep); },
+          [=](){ TRACE_ASYNC_END("crossfade", toSceneStep);
+                 m_selectedCueId = toSceneId;
+                 m_L_seq.at(m_mainSeqId)->setSelectedStepId(toSceneStep); },
           Qt::SingleShotConnection);
+  TRACE_ASYNC_BEGIN("crossfade", toSceneStep);
   start();
 
 }
 
+// every fade step of the running go
+void CueEngine::updateCurrentTime(int t_currentTime)
+{
+  TRACE_SCOPE("CueEngine::updateCurrentTime");
+  TRACE_COUNTER("crossfade time", t_currentTime);
+  QParallelAnimationGroup::updateCurrentTime(t_currentTime);
+}
+
 void CueEngine::goBack()
 {
 
@@ -587,6 +635,7 @@ void CueEngine::addSceneToL_activeCues(DmxScene *t_scene)
 void CueEngine::cueLevelChanged(sceneID_f t_sceneid,
                                 dmx t_level)
 {
+  TRACE_SCOPE("CueEngine::cueLevelChanged");
   // URGENT : vérifier si elle est ds la L
   auto scene = getMainSeq()->getScene(t_sceneid);
   if (scene)
@@ -697,66 +746,147 @@ DmxChannel *ChannelEngine::getChannel(const id &t_id) const
 //   }
 // }
 
+QList<id> ChannelEngine::getL_selectedChannelId() const
+{
+  QList<id> L_id;
+  L_id.reserve(m_selection.getCount());
+  m_selection.forEach([&L_id](int t_id)
+                      { L_id.append(static_cast<id>(t_id)); });
+  return L_id;
+}
+
 QList<DmxChannel *> ChannelEngine::getL_selectedChannel()
 {
   QList<DmxChannel *> L_selectedChannel;
-  for (qsizetype i = 0;
-       i < m_L_selectedChannelId.size();
-       i++)
-  {
-    auto channel = getChannel(m_L_selectedChannelId.at(i));
-    L_selectedChannel.append(channel);
-  }
+  L_selectedChannel.reserve(m_selection.getCount());
+  m_selection.forEach([this, &L_selectedChannel](int t_id)
+                      { L_selectedChannel.append(GET_CHANNEL(t_id)); });
   return L_selectedChannel;
 }
 
 void ChannelEngine::addL_idToL_select(const QList<id> &t_L_id)
 {
-  for (qsizetype i = 0;
-       i < t_L_id.size();
-       i++)
+  bool isChanged = false;
+  for (const auto item
+       : t_L_id)
   {
-    auto selectId = t_L_id.at(i);
-    addIdToL_select(selectId);
+    isChanged |= selectId(item);
   }
+  if (isChanged)
+    emit selectionChanged();
 }
 
 void ChannelEngine::addIdToL_select(const id &t_id)
 {
-  auto index = m_L_selectedChannelId.indexOf(t_id);
-  if (index = -1)
+  if (selectId(t_id))
+    emit selectionChanged();
+}
+
+void ChannelEngine::addRangeToL_select(id t_first,
+                                       id t_last)
+{
+  if (t_first > t_last)
+    std::swap(t_first, t_last);
+  t_first = qMax<id>(t_first, 0);
+  t_last = qMin<int>(t_last, m_rootChannel->getL_childValueSize() - 1);
+  if (t_first > t_last)
+    return;
+  if (m_selection.addRange(t_first,
+                           t_last) == 0)
+    return;
+  for (int i = t_first;
+       i <= t_last;
+       i++)
   {
-    GET_CHANNEL(t_id)->setIsSelected(true);
-    m_L_selectedChannelId.append(t_id);
+    GET_CHANNEL(i)->setIsSelected(true);
   }
-  emit sigToUpdateChannelView();
+  emit selectionChanged();
 }
 
 void ChannelEngine::removeL_idFromL_select(const QList<id> &t_L_id)
 {
-  for (qsizetype i = 0;
-       i < t_L_id.size();
-       i++)
+  bool isChanged = false;
+  for (const auto item
+       : t_L_id)
   {
-    auto selectId = t_L_id.at(i);
-    removeIdFromL_select(selectId);
+    isChanged |= deselectId(item);
   }
+  if (isChanged)
+    emit selectionChanged();
 }
 
 void ChannelEngine::removeIdFromL_select(const id &t_id)
 {
-  auto index = m_L_selectedChannelId.indexOf(t_id);
-  if (index != -1)
+  if (deselectId(t_id))
+    emit selectionChanged();
+}
+
+void ChannelEngine::removeRangeFromL_select(id t_first,
+                                            id t_last)
+{
+  if (t_first > t_last)
+    std::swap(t_first, t_last);
+  t_first = qMax<id>(t_first, 0);
+  t_last = qMin<int>(t_last, m_selection.getSize() - 1);
+  // setIsSelected(false) clears overdmx, only on the selected ones
+  for (int i = t_first;
+       i <= t_last;
+       i++)
   {
-    m_L_selectedChannelId.remove(index);
-    GET_CHANNEL(t_id)->setIsSelected(false);
+    if (m_selection.contains(i))
+      GET_CHANNEL(i)->setIsSelected(false);
   }
-  emit sigToUpdateChannelView();
+  if (m_selection.removeRange(t_first,
+                              t_last) > 0)
+    emit selectionChanged();
+}
+
+void ChannelEngine::invertSelection()
+{
+  int channelCount = m_rootChannel->getL_childValueSize();
+  if (channelCount == 0)
+    return;
+  m_selection.resize(channelCount);
+  m_selection.invert();
+  for (int i = 0;
+       i < channelCount;
+       i++)
+  {
+    GET_CHANNEL(i)->setIsSelected(m_selection.contains(i));
+  }
+  emit selectionChanged();
+}
+
+bool ChannelEngine::selectId(id t_id)
+{
+  auto channel = getChannel(t_id);
+  if (!channel
+      || !m_selection.add(t_id))
+    return false;
+  channel->setIsSelected(true);
+  return true;
+}
+
+bool ChannelEngine::deselectId(id t_id)
+{
+  if (!m_selection.remove(t_id))
+    return false;
+  GET_CHANNEL(t_id)->setIsSelected(false);
+  return true;
+}
+
+bool ChannelEngine::clearSelectionSet()
+{
+  m_selection.forEach([this](int t_id)
+                      { GET_CHANNEL(t_id)->setIsSelected(false); });
+  return m_selection.clear() > 0;
 }
 
 void ChannelEngine::selectNonNullChannels()
 {
-  clearSelection();
+  // levels set earlier in a batch count
+  flushBatch();
+  bool isChanged = clearSelectionSet();
   // for (const auto &item
   //      : std::as_const(m_rootChannel->getL_childValue()))
   for (qsizetype i = 0;
@@ -773,25 +903,53 @@ void ChannelEngine::selectNonNullChannels()
         //     || flag == ChannelDataFlag::DirectChannelFlag
         //     || flag == ChannelDataFlag::ChannelGroupFlag))
     {
-      id channelId = channel->getid();
-      addIdToL_select(channelId);
-      channel->setIsSelected(true);
+      isChanged |= selectId(channel->getid());
     }
   }
+  if (isChanged)
+    emit selectionChanged();
 }
 
-void ChannelEngine::clearSelection()
+void ChannelEngine::endBatch()
 {
-  for (qsizetype i = 0;
-       i < m_L_selectedChannelId.size();
-       i++)
+  if (m_batchDepth == 0)
+  {
+    qWarning() << "can't ChannelEngine::endBatch, no batch";
+    return;
+  }
+  m_batchDepth--;
+  if (m_batchDepth == 0)
+    flushBatch();
+}
+
+void ChannelEngine::flushBatch()
+{
+  TRACE_SCOPE("ChannelEngine::flushBatch");
+  if (m_batchChannel.isEmpty())
+    return;
+  m_batchChannel.forEach([this](int t_id)
+                         {
+                           auto channel = getChannel(t_id);
+                           if (channel)
+                             channel->update();
+                         });
+  m_batchChannel.clear();
+}
+
+void ChannelEngine::updateChannel(DmxChannel *t_channel)
+{
+  if (m_batchDepth == 0)
   {
-    auto channel = getChannel(m_L_selectedChannelId.at(i));
-    channel->setIsSelected(false);
+    t_channel->update();
+    return;
   }
-  m_L_selectedChannelId.clear();
-  m_L_selectedChannelId.squeeze();
-  emit sigToUpdateChannelView();
+  m_batchChannel.add(t_channel->getid());
+}
+
+void ChannelEngine::clearSelection()
+{
+  if (clearSelectionSet())
+    emit selectionChanged();
 }
 
 // void ChannelEngine::clearDirectChannel()
@@ -818,18 +976,19 @@ void ChannelEngine::clearSelection()
 void ChannelEngine::onChannelLevelChangedFromGroup(id t_id,
                                                    dmx t_level)
 {
+  TRACE_SCOPE("ChannelEngine::onChannelLevelChangedFromGroup");
   // auto channelData = m_channelDataEngine->getChannelData(t_id);
   auto channel = getChannel(t_id);
   channel->setChannelGroupLevel(t_level);
   // update(t_id);
-  channel->update();
-  emit sigToUpdateChannelView();
+  updateChannel(channel);
 
 }
 
 void ChannelEngine::onChannelLevelChangedFromSliderChannel(id t_id,
                                                            dmx t_level)
 {
+  TRACE_SCOPE("ChannelEngine::onChannelLevelChangedFromSliderChannel");
   // addIdToL_direct(t_id);
   auto channel = getChannel(t_id);
   // TODO : voir ça
@@ -838,130 +997,101 @@ void ChannelEngine::onChannelLevelChangedFromSliderChannel(id t_id,
   channel->setChannelDataFlag(DirectChannelFlag);
   channel->setIsDirectChannel(true);
   // update(t_id);
-  channel->update();
-  emit sigToUpdateChannelView();
+  updateChannel(channel);
 
 }
 
 void ChannelEngine::onChannelLevelPlusFromDirectChannel(const bool t_isPlus,
                                                         const int t_increment)
 {
-  auto L_selectId = getL_selectedChannelId();
-  for (qsizetype i = 0;
-       i < L_selectId.size();
-       i++)
-  {
-    id channelid = L_selectId.at(i);
-    auto channel = getChannel(channelid);
-    // addIdToL_direct(channelid);
-    auto level = channel->getDirectChannelLevel();
-    auto offset = channel->getDirectChannelOffset();
-
-    if (offset != 0) // il y a un offset
-    {
-      if (offset > 0) // offset positif
-      {
-        if (t_isPlus) // +dmx
-        {
-          offset += t_increment;
-          channel->setDirectChannelOffset(offset);
-        }
-        else // -dmx
-        {
-          int result = offset - t_increment;
-          if (result < 0)
-          {
-            channel->setDirectChannelOffset(NULL_DMX_OFFSET);
-            channel->setDirectChannelLevel(MAX_DMX - result);
-          }
-          else // y a encore de l'offset
-          {
-            offset -= t_increment;
-            channel->setDirectChannelOffset(offset);
-          }
-        }
-      }
-      else if (offset < 0) // offset négatif
-      {
-        if (!t_isPlus) // -dmx
-        {
-          offset -= t_increment;
-          channel->setDirectChannelOffset(offset);
-        }
-        else // +dmx
-        {
-          int result = offset + t_increment;
-          if (result > 0)
-          {
-            channel->setDirectChannelOffset(NULL_DMX_OFFSET);
-            channel->setDirectChannelLevel(NULL_DMX + result);
-          }
-          else // y a encore de l'offset
-          {
-            offset -= t_increment;
-            channel->setDirectChannelOffset(offset);
-          }
-        }
-      }
-    }
-    else // offset = 0;
-    {
-      if (t_isPlus) // +dmx
-      {
-        int result = level + t_increment;
-        offset = result - MAX_DMX;
-        if (offset > 0)
-        {
-          channel->setDirectChannelLevel(MAX_DMX);
-          channel->setDirectChannelOffset(offset);
-        }
-        else
-        {
-          channel->setDirectChannelLevel(result);
-        }
-        channel->update();
-      }
-      else // -dmx
-      {
-        int result = level - t_increment;
-        if (result < 0)
-        {
-          channel->setDirectChannelLevel(NULL_DMX);
-          channel->setDirectChannelOffset(result);
-        }
-        else
-        {
-          channel->setDirectChannelLevel(result);
-          channel->setChannelDataFlag(DirectChannelFlag);
-        }
-      }
-    }
-    channel->update();
-  }
-  emit sigToUpdateChannelView();
+  TRACE_SCOPE("ChannelEngine::onChannelLevelPlusFromDirectChannel");
+  // overdmx : past 0 or 255, the offset keeps what is left, so
+  // going back takes as long
+  gatherDirectColumn();
+  LevelKernel::add(m_L_directColumn.data(),
+                   m_L_directColumn.size(),
+                   t_isPlus ? t_increment : -t_increment);
+  scatterDirectColumn(false);
 }
 
 void ChannelEngine::onSelectedChannelListAtLevel(dmx t_level)
 {
-  auto L_selectChannel = getL_selectedChannel();
+  TRACE_SCOPE("ChannelEngine::onSelectedChannelListAtLevel");
+  gatherDirectColumn();
+  LevelKernel::fill(m_L_directColumn.data(),
+                    m_L_directColumn.size(),
+                    t_level);
+  scatterDirectColumn(true);
+}
+
+void ChannelEngine::onSelectedChannelListScale(int t_percent)
+{
+  TRACE_SCOPE("ChannelEngine::onSelectedChannelListScale");
+  gatherDirectColumn();
+  LevelKernel::scale(m_L_directColumn.data(),
+                     m_L_directColumn.size(),
+                     t_percent);
+  scatterDirectColumn(false);
+}
+
+void ChannelEngine::onSelectedChannelListFan(dmx t_first,
+                                             dmx t_last,
+                                             FanMode t_mode)
+{
+  TRACE_SCOPE("ChannelEngine::onSelectedChannelListFan");
+  gatherDirectColumn();
+  if (m_L_directColumn.isEmpty())
+    return;
+  LevelKernel::fan(m_L_directColumn.data(),
+                   m_L_directColumn.size(),
+                   t_first,
+                   t_last,
+                   t_mode);
+  scatterDirectColumn(true);
+}
+
+void ChannelEngine::gatherDirectColumn()
+{
+  m_L_columnChannel.clear();
+  m_L_directColumn.clear();
+  m_L_columnChannel.reserve(m_selection.getCount());
+  m_L_directColumn.reserve(m_selection.getCount());
+  m_selection.forEach([this](int t_id)
+                      {
+                        auto channel = GET_CHANNEL(t_id);
+                        m_L_columnChannel.append(channel);
+                        m_L_directColumn.append(channel->getDirectChannelLevel()
+                                                + channel->getDirectChannelOffset());
+                      });
+}
+
+void ChannelEngine::scatterDirectColumn(bool t_isDirectChannel)
+{
+  auto count = m_L_directColumn.size();
+  m_L_directLevel.resize(count);
+  m_L_directOffset.resize(count);
+  LevelKernel::split(m_L_directColumn.constData(),
+                     count,
+                     m_L_directLevel.data(),
+                     m_L_directOffset.data());
   for (qsizetype i = 0;
-       i < L_selectChannel.size();
+       i < count;
        i++)
   {
-    DmxChannel *channel = L_selectChannel.at(i);
-    channel->clearOverdmx();
-    channel->setIsDirectChannel(true);
-    channel->setDirectChannelLevel(t_level);
-    // update(channel->getid());
-    channel->update();
+    auto channel = m_L_columnChannel.at(i);
+    channel->setDirectChannelLevel(m_L_directLevel.at(i));
+    channel->setDirectChannelOffset(m_L_directOffset.at(i));
+    if (t_isDirectChannel)
+      channel->setIsDirectChannel(true);
+    updateChannel(channel);
   }
-  emit sigToUpdateChannelView();
 }
 
 void ChannelEngine::onChannelLevelChangedFromScene(id t_channelid,
                                                    dmx t_level,
                                                    CueRole t_role /*= CueRole::NewSelectRole*/)
 {
+  TRACE_SCOPE("ChannelEngine::onChannelLevelChangedFromScene");
   Q_UNUSED(t_role) // NOTE : pour plus tard
   auto channel = getChannel(t_channelid);
   channel->clearDirectChannel();
@@ -969,7 +1099,6 @@ void ChannelEngine::onChannelLevelChangedFromScene(id t_channelid,
   channel->setSceneLevel(t_level);
   // update(t_channelid);
   channel->update();
-  emit sigToUpdateChannelView();
 }
 
 /******************************** OutputEngine *************************/
@@ -988,6 +1117,7 @@ OutputEngine::~OutputEngine()
 void OutputEngine::onChannelLevelChanged(id t_channelId,
                                          dmx t_level)
 {
+  TRACE_SCOPE("OutputEngine::onChannelLevelChanged");
   auto L_Uid_Id = m_patch->getL_Uid_Id(t_channelId);
   for (const auto &i
        : std::as_const(L_Uid_Id))
@@ -1025,6 +1155,309 @@ void OutputEngine::onDirectOutputLevelMoins(Uid_Id t_uid_id)
     output->setLevel(level);
 }
 
+/****************************** InputEngine ******************************/
+
+InputEngine::InputEngine(QList<RootValue *> t_L_rootOutput,
+                         QObject *parent)
+  : QObject(parent),
+    m_L_rootOutput(t_L_rootOutput)
+{}
+
+InputEngine::~InputEngine()
+{}
+
+void InputEngine::setInputThread(NetworkInputThread *t_inputThread)
+{
+  // release everything the previous thread was holding
+  for (qsizetype i = 0;
+       i < m_L_isActive.size();
+       i++)
+  {
+    if (m_L_isActive.at(i))
+      applyUniverse(static_cast<uid>(i),
+                    false);
+  }
+
+  m_inputThread = t_inputThread;
+  auto universeCount = t_inputThread ? t_inputThread->getUniverseCount() : 0;
+  m_L_frame.fill(QByteArray(UNIVERSE_OUTPUT_COUNT_DEFAULT, NULL_DMX),
+                 universeCount);
+  m_L_lastFrame.fill(QByteArray(UNIVERSE_OUTPUT_COUNT_DEFAULT, NULL_DMX),
+                     universeCount);
+  m_L_sequence.fill(0,
+                    universeCount);
+  m_L_isActive.fill(false,
+                    universeCount);
+}
+
+void InputEngine::update()
+{
+  if (!m_inputThread)
+    return;
+
+  for (qsizetype i = 0;
+       i < m_L_frame.size();
+       i++)
+  {
+    bool isActive = false;
+    auto data = reinterpret_cast<dmx *>(m_L_frame[i].data());
+    if (!m_inputThread->getUniverse(static_cast<uid>(i))
+             ->read(data,
+                    isActive,
+                    m_L_sequence[i]))
+    {
+      continue; // nothing new
+    }
+    applyUniverse(static_cast<uid>(i),
+                  isActive);
+  }
+}
+
+void InputEngine::applyUniverse(uid t_uid,
+                                bool t_isActive)
+{
+  if (t_uid >= m_L_rootOutput.size())
+    return;
+
+  bool wasActive = m_L_isActive.at(t_uid);
+  m_L_isActive[t_uid] = t_isActive;
+  if (!wasActive && !t_isActive)
+    return;
+
+  auto rootOutput = m_L_rootOutput.at(t_uid);
+  auto frame = reinterpret_cast<const dmx *>(m_L_frame.at(t_uid).constData());
+  auto lastFrame = reinterpret_cast<dmx *>(m_L_lastFrame[t_uid].data());
+  auto outputCount = qMin(rootOutput->getL_childValueSize(),
+                          UNIVERSE_OUTPUT_COUNT_DEFAULT);
+
+  for (int i = 0;
+       i < outputCount;
+       i++)
+  {
+    // activity change touches every channel, else only changed slots
+    if (wasActive == t_isActive
+        && frame[i] == lastFrame[i])
+    {
+      continue;
+    }
+    auto output = static_cast<DmxOutput *>(rootOutput->getChildValue(i));
+    auto channel = output->getChannelControler();
+    if (!channel)
+      continue;
+    if (t_isActive)
+      channel->setInputLevel(frame[i],
+                             m_mergeMode);
+    else
+      channel->clearInput();
+    channel->update();
+  }
+
+  std::memcpy(lastFrame,
+              frame,
+              UNIVERSE_OUTPUT_COUNT_DEFAULT);
+}
+
+/***************************** PendingLevelTable *************************/
+
+void PendingLevelTable::setLevel(id t_id,
+                                 dmx t_level,
+                                 qint64 t_requestTime)
+{
+  if (t_id < 0)
+    return;
+  if (t_id >= m_L_level.size())
+    m_L_level.resize(t_id + 1, -1);
+  if (m_L_dirtyId.isEmpty())
+    m_oldestRequestTime = t_requestTime;
+  if (m_L_level.at(t_id) < 0)
+    m_L_dirtyId.append(t_id);
+  m_L_level[t_id] = t_level;
+}
+
+void PendingLevelTable::take(QList<Ch_Id_Dmx> &t_L_id_dmx)
+{
+  for (const auto &item
+       : std::as_const(m_L_dirtyId))
+  {
+    t_L_id_dmx.append(Ch_Id_Dmx(item,
+                                static_cast<dmx>(m_L_level.at(item))));
+    m_L_level[item] = -1;
+  }
+  m_L_dirtyId.clear();
+}
+
+/****************************** EffectEngine *****************************/
+
+EffectEngine::EffectEngine(RootValue *t_rootChannel,
+                           QObject *parent)
+    : QObject(parent),
+      m_rootChannel(t_rootChannel),
+      m_clock(new EffectClock(this))
+{}
+
+EffectEngine::~EffectEngine()
+{}
+
+QList<DmxEffect> EffectEngine::getL_effect() const
+{
+  QList<DmxEffect> L_effect;
+  L_effect.reserve(m_L_runningEffect.size());
+  for (const auto &item
+       : m_L_runningEffect)
+  {
+    L_effect.append(item.m_effect);
+  }
+  return L_effect;
+}
+
+void EffectEngine::setEffect(const DmxEffect &t_effect)
+{
+  if (t_effect.getid() == NO_ID
+      || t_effect.getWaveform() == EffectWaveform::UnknownWaveform)
+  {
+    qWarning() << "can't EffectEngine::setEffect";
+    return;
+  }
+  if (m_clock->state() != QAbstractAnimation::Running)
+    m_clock->start();
+
+  RunningEffect runningEffect;
+  runningEffect.m_effect = t_effect;
+  runningEffect.m_startTime = getTime();
+  // channel i lags i * spread / count cycle, kept in [0, 1)
+  auto count = t_effect.getL_channelId().size();
+  runningEffect.m_L_phaseOffset.resize(count);
+  runningEffect.m_L_level.resize(count);
+  for (qsizetype i = 0;
+       i < count;
+       i++)
+  {
+    float offset = -static_cast<float>(i) * t_effect.getPhaseSpread() / count;
+    offset -= std::floor(offset);
+    runningEffect.m_L_phaseOffset[i] = offset < 1.0f ? offset : 0.0f;
+  }
+
+  auto index = indexOf(t_effect.getid());
+  if (index == -1)
+    m_L_runningEffect.append(runningEffect);
+  else
+    m_L_runningEffect[index] = runningEffect;
+}
+
+bool EffectEngine::removeEffect(id t_id)
+{
+  auto index = indexOf(t_id);
+  if (index == -1)
+    return false;
+  // channels are cleared at next update()
+  m_L_runningEffect.removeAt(index);
+  if (m_L_runningEffect.isEmpty())
+    m_clock->stop();
+  return true;
+}
+
+void EffectEngine::clear()
+{
+  m_L_runningEffect.clear();
+  m_clock->stop();
+}
+
+void EffectEngine::update()
+{
+  if (m_L_runningEffect.isEmpty()
+      && m_lastEffectChannel.isEmpty())
+    return;
+  TRACE_SCOPE("EffectEngine::update");
+
+  auto time = getTime();
+  auto channelCount = m_rootChannel->getL_childValueSize();
+  if (m_L_effectLevel.size() < channelCount)
+  {
+    m_L_effectLevel.resize(channelCount, NULL_DMX);
+    m_L_effectOffset.resize(channelCount, 0);
+  }
+
+  for (auto &item
+       : m_L_runningEffect)
+  {
+    evaluate(item,
+             time);
+    const auto &effect = item.m_effect;
+    const auto &L_channelId = effect.getL_channelId();
+    bool isRelative = effect.getMergeMode() == EffectMergeMode::RelativeEffect;
+    int center = effect.getSize() / 2;
+    for (qsizetype i = 0;
+         i < L_channelId.size();
+         i++)
+    {
+      auto channelId = L_channelId.at(i);
+      if (channelId < 0
+          || channelId >= channelCount)
+        continue;
+      auto level = item.m_L_level.at(i);
+      if (isRelative)
+        m_L_effectOffset[channelId] += level - center;
+      else
+        m_L_effectLevel[channelId] = qMax(m_L_effectLevel.at(channelId),
+                                          level);
+      m_effectChannel.add(channelId);
+    }
+  }
+
+  // merge stage : channels put their effect layer over the others
+  m_lastEffectChannel.forEach([this](int t_id)
+                              {
+                                if (m_effectChannel.contains(t_id))
+                                  return;
+                                auto channel = static_cast<DmxChannel *>(m_rootChannel->getChildValue(t_id));
+                                channel->clearEffect();
+                                channel->update();
+                              });
+  m_effectChannel.forEach([this](int t_id)
+                          {
+                            auto channel = static_cast<DmxChannel *>(m_rootChannel->getChildValue(t_id));
+                            channel->setEffect(static_cast<dmx>(qMin(m_L_effectLevel.at(t_id),
+                                                                     MAX_DMX)),
+                                               m_L_effectOffset.at(t_id));
+                            channel->update();
+                            m_L_effectLevel[t_id] = NULL_DMX;
+                            m_L_effectOffset[t_id] = 0;
+                          });
+  std::swap(m_effectChannel,
+            m_lastEffectChannel);
+  m_effectChannel.clear();
+}
+
+int EffectEngine::indexOf(id t_id) const
+{
+  for (qsizetype i = 0;
+       i < m_L_runningEffect.size();
+       i++)
+  {
+    if (m_L_runningEffect.at(i).m_effect.getid() == t_id)
+      return i;
+  }
+  return -1;
+}
+
+void EffectEngine::evaluate(RunningEffect &t_runningEffect,
+                            qint64 t_time)
+{
+  const auto &effect = t_runningEffect.m_effect;
+  // cycle count in double, hours long effects keep their precision
+  double cycle = (t_time - t_runningEffect.m_startTime)
+                 * effect.getRate() / MS_TO_S;
+  double wholeCycle = std::floor(cycle);
+  LevelKernel::waveform(t_runningEffect.m_L_level.data(),
+                        t_runningEffect.m_L_phaseOffset.constData(),
+                        t_runningEffect.m_L_level.size(),
+                        static_cast<float>(cycle - wholeCycle),
+                        static_cast<quint32>(static_cast<qint64>(wholeCycle)),
+                        effect.getWaveform(),
+                        effect.getSize(),
+                        effect.getSeed());
+}
+
 /******************************* DmxEngine ***************************/
 
 DmxEngine::DmxEngine(RootValue *t_rootGroup,
@@ -1038,15 +1471,31 @@ DmxEngine::DmxEngine(RootValue *t_rootGroup,
     // m_channelDataEngine = new ChannelDataEngine(this);
     m_groupEngine = new ChannelGroupEngine(t_rootGroup,
                                            this);
+    // before cue engine, which keeps it
+    m_channelEngine = new ChannelEngine(t_rootChannel,
+                                        this);
     m_cueEngine = new CueEngine(t_rootChannel,
                                 m_channelEngine,
                                 t_L_seq,
                                 this);
-    m_channelEngine = new ChannelEngine(t_rootChannel,
-                                        this);
     m_outputEngine = new OutputEngine(t_L_rootOutput,
                                     t_patch,
                                     this);
+    m_inputEngine = new InputEngine(t_L_rootOutput,
+                                    this);
+    m_effectEngine = new EffectEngine(t_rootChannel,
+                                      this);
+    m_snapshotPublisher = new SnapshotPublisher(t_rootChannel,
+                                                t_rootGroup,
+                                                this);
+
+  m_tickTimer = new QTimer(this);
+  m_tickTimer->setTimerType(Qt::PreciseTimer);
+  connect(m_tickTimer,
+          SIGNAL(timeout()),
+          this,
+          SLOT(onTick()));
+  m_tickTimer->start(ENGINE_TICK_INTERVAL);
 
   connect(m_groupEngine,
           SIGNAL(channelLevelChangedFromGroup(id,dmx)),
@@ -1076,6 +1525,9 @@ DmxEngine::~DmxEngine()
   m_cueEngine->deleteLater();
   m_channelEngine->deleteLater();
   m_outputEngine->deleteLater();
+  m_inputEngine->deleteLater();
+  m_effectEngine->deleteLater();
+  m_snapshotPublisher->deleteLater();
   // m_channelDataEngine->deleteLater();
 }
 
@@ -1084,19 +1536,295 @@ void DmxEngine::setMainSeq(id t_id)
   m_cueEngine->setMainSeqId(t_id);
 }
 
-QList<DmxChannel *> DmxEngine::getSelectedChannels() const
+void DmxEngine::requestChannelLevel(id t_id,
+                                    dmx t_level)
 {
-  QList<DmxChannel *> L_channel;
-  auto L_id =  m_channelEngine->getL_selectedChannelId();
-  for (qsizetype i = 0;
-       i < L_id.size();
+  EngineCommand command;
+  command.m_type = ChannelLevelCommand;
+  command.m_id = t_id;
+  command.m_value = t_level;
+  pushCommand(command);
+}
+
+void DmxEngine::requestGroupLevel(id t_id,
+                                  dmx t_level)
+{
+  EngineCommand command;
+  command.m_type = GroupLevelCommand;
+  command.m_id = t_id;
+  command.m_value = t_level;
+  pushCommand(command);
+}
+
+void DmxEngine::requestKeypadButton(KeypadButton t_button)
+{
+  EngineCommand command;
+  command.m_type = KeypadCommand;
+  command.m_value = t_button;
+  pushCommand(command);
+}
+
+void DmxEngine::requestPlayBackButton(PlayBackButton t_button)
+{
+  EngineCommand command;
+  command.m_type = PlayBackCommand;
+  command.m_value = t_button;
+  pushCommand(command);
+}
+
+void DmxEngine::requestDirectChannelDelta(int t_delta)
+{
+  EngineCommand command;
+  command.m_type = DirectChannelDeltaCommand;
+  command.m_value = t_delta;
+  pushCommand(command);
+}
+
+bool DmxEngine::pushCommand(EngineCommand t_command)
+{
+  t_command.m_requestTime = LatencyStats::instance()->now();
+  if (m_commandQueue.push(t_command))
+    return true;
+  // engine is stalled or flooded, warn once per burst
+  if (!m_droppedCommandCount.fetch_add(1,
+                                       std::memory_order_relaxed))
+  {
+    qWarning() << "can't DmxEngine::pushCommand, queue is full";
+  }
+  return false;
+}
+
+void DmxEngine::drainCommands()
+{
+  // bounded : commands pushed meanwhile wait for next tick
+  EngineCommand command;
+  for (int i = 0;
+       i < ENGINE_COMMAND_QUEUE_SIZE
+       && m_commandQueue.pop(command);
        i++)
   {
-    L_channel.append(static_cast<DmxChannel *>(m_channelEngine
-                                                   ->getRootChannel()
-                                                   ->getChildValue(L_id.at(i))));
+    switch (command.m_type)
+    {
+    case ChannelLevelCommand :
+      m_pendingChannelLevel.setLevel(command.m_id,
+                                     static_cast<dmx>(command.m_value),
+                                     command.m_requestTime);
+      break;
+    case GroupLevelCommand :
+      m_pendingGroupLevel.setLevel(command.m_id,
+                                   static_cast<dmx>(command.m_value),
+                                   command.m_requestTime);
+      break;
+    case DirectChannelDeltaCommand :
+      if (!m_pendingDirectChannelDelta)
+        m_deltaRequestTime = command.m_requestTime;
+      m_pendingDirectChannelDelta += command.m_value;
+      break;
+    case KeypadCommand :
+    case PlayBackCommand :
+      m_L_pendingButton.append(command);
+      break;
+    default :
+      break;
+    }
   }
-  return L_channel;
+}
+
+void DmxEngine::flushPendingInput()
+{
+  TRACE_SCOPE("DmxEngine::flushPendingInput");
+  auto latencyStats = LatencyStats::instance();
+  qint64 oldestRequestTime = 0;
+
+  drainCommands();
+
+  // buttons first and in order, keypad may select channels
+  // that levels of the same tick apply to
+  if (!m_L_pendingButton.isEmpty())
+  {
+    auto requestTime = m_L_pendingButton.first().m_requestTime;
+    latencyStats->addSample(EngineLatencyStage,
+                            requestTime);
+    oldestRequestTime = requestTime;
+    bool isKeypad = false;
+    for (const auto &item
+         : std::as_const(m_L_pendingButton))
+    {
+      if (item.m_type == KeypadCommand)
+      {
+        HeartbeatActivity activity(&m_heartbeat,
+                                   "interpreter");
+        emit keypadButtonReady(static_cast<KeypadButton>(item.m_value));
+        isKeypad = true;
+      }
+      else
+      {
+        applyPlayBackButton(static_cast<PlayBackButton>(item.m_value));
+      }
+    }
+    m_L_pendingButton.clear();
+    if (isKeypad)
+      latencyStats->addSample(InterpreterLatencyStage,
+                              requestTime);
+    m_inputLatency.addSample(latencyStats->now() - requestTime);
+  }
+
+  if (!m_pendingGroupLevel.isEmpty())
+  {
+    auto requestTime = m_pendingGroupLevel.getOldestRequestTime();
+    latencyStats->addSample(EngineLatencyStage,
+                            requestTime);
+    if (!oldestRequestTime
+        || requestTime < oldestRequestTime)
+    {
+      oldestRequestTime = requestTime;
+    }
+    m_L_pendingLevel.clear();
+    m_pendingGroupLevel.take(m_L_pendingLevel);
+    for (const auto &item
+         : std::as_const(m_L_pendingLevel))
+    {
+      m_groupEngine->setGroupLevel(item.getid(),
+                                   item.getLevel());
+    }
+    m_inputLatency.addSample(latencyStats->now() - requestTime);
+  }
+
+  if (!m_pendingChannelLevel.isEmpty())
+  {
+    auto requestTime = m_pendingChannelLevel.getOldestRequestTime();
+    latencyStats->addSample(EngineLatencyStage,
+                            requestTime);
+    if (!oldestRequestTime
+        || requestTime < oldestRequestTime)
+    {
+      oldestRequestTime = requestTime;
+    }
+    m_L_pendingLevel.clear();
+    m_pendingChannelLevel.take(m_L_pendingLevel);
+    auto channelCount = m_channelEngine->getRootChannel()->getL_childValueSize();
+    for (const auto &item
+         : std::as_const(m_L_pendingLevel))
+    {
+      if (item.getid() < channelCount)
+        m_channelEngine->onChannelLevelChangedFromSliderChannel(item.getid(),
+                                                                item.getLevel());
+    }
+    m_inputLatency.addSample(latencyStats->now() - requestTime);
+  }
+
+  if (m_pendingDirectChannelDelta)
+  {
+    latencyStats->addSample(EngineLatencyStage,
+                            m_deltaRequestTime);
+    if (!oldestRequestTime
+        || m_deltaRequestTime < oldestRequestTime)
+    {
+      oldestRequestTime = m_deltaRequestTime;
+    }
+    auto delta = m_pendingDirectChannelDelta;
+    m_pendingDirectChannelDelta = 0;
+    m_channelEngine->onChannelLevelPlusFromDirectChannel(delta > 0,
+                                                         qAbs(delta));
+    m_inputLatency.addSample(latencyStats->now() - m_deltaRequestTime);
+  }
+
+  // outputs were written synchronously, hardware is flushed from the gui.
+  // Next frame carries the oldest input
+  if (oldestRequestTime)
+  {
+    latencyStats->addSample(MergeLatencyStage,
+                            oldestRequestTime);
+    latencyStats->armInput(oldestRequestTime);
+  }
+}
+
+void DmxEngine::applyPlayBackButton(PlayBackButton t_button)
+{
+  switch(t_button)
+  {
+  case GoButton :
+  {
+    HeartbeatActivity activity(&m_heartbeat,
+                               "go");
+    m_cueEngine->goGo();
+    break;
+  }
+  case GoBackButton :
+    m_cueEngine->goBack();
+    break;
+  case PauseButton :
+    m_cueEngine->goPause();
+    break;
+  case SeqPlusButton :
+    m_cueEngine->setSelectedPlus();
+    break;
+  case SeqMoinsButton :
+    m_cueEngine->setSelectedMoins();
+    break;
+  default :
+    break;
+  }
+}
+
+void DmxEngine::onTick()
+{
+  TRACE_SCOPE("DmxEngine::onTick");
+  {
+    HeartbeatActivity activity(&m_heartbeat,
+                               "tick started");
+    emit tickStarted();
+  }
+  {
+    HeartbeatActivity activity(&m_heartbeat,
+                               "pending input");
+    flushPendingInput();
+  }
+  {
+    HeartbeatActivity activity(&m_heartbeat,
+                               "network input");
+    m_inputEngine->update();
+  }
+  {
+    HeartbeatActivity activity(&m_heartbeat,
+                               "effects");
+    m_effectEngine->update();
+  }
+  {
+    HeartbeatActivity activity(&m_heartbeat,
+                               "tick ended");
+    emit ticked();
+  }
+  m_heartbeat.beat();
+}
+
+QList<DmxChannel *> DmxEngine::getSelectedChannels() const
+{
+  // recorded levels include the ones set earlier in a batch
+  m_channelEngine->flushBatch();
+  return m_channelEngine->getL_selectedChannel();
+}
+
+QList<Uid_Id> DmxEngine::getL_selectedOutput() const
+{
+  QList<Uid_Id> L_Uid_Id;
+  L_Uid_Id.reserve(m_outputSelection.getCount());
+  m_outputSelection.forEach([&L_Uid_Id](int t_index)
+                            {
+                              L_Uid_Id.append(Uid_Id(t_index / UNIVERSE_OUTPUT_COUNT_DEFAULT,
+                                                     t_index % UNIVERSE_OUTPUT_COUNT_DEFAULT));
+                            });
+  return L_Uid_Id;
+}
+
+static int outputIndex(const Uid_Id &t_Uid_Id)
+{
+  if (t_Uid_Id.getUniverseID() < 0
+      || t_Uid_Id.getOutputID() < 0
+      || t_Uid_Id.getOutputID() >= UNIVERSE_OUTPUT_COUNT_DEFAULT)
+    return -1;
+  return t_Uid_Id.getUniverseID() * UNIVERSE_OUTPUT_COUNT_DEFAULT
+         + t_Uid_Id.getOutputID();
 }
 
 void DmxEngine::onAddChannelSelection(QList<id> t_L_id)
@@ -1105,6 +1833,14 @@ void DmxEngine::onAddChannelSelection(QList<id> t_L_id)
   m_channelEngine->addL_idToL_select(t_L_id);
 }
 
+void DmxEngine::onAddChannelRangeSelection(id t_first,
+                                           id t_last)
+{
+  m_selType = SelectionType::ChannelSelectionType;
+  m_channelEngine->addRangeToL_select(t_first,
+                                      t_last);
+}
+
 void DmxEngine::onRemoveChannelSelection(QList<id> t_L_id)
 {
   m_channelEngine->removeL_idFromL_select(t_L_id);
@@ -1112,32 +1848,46 @@ void DmxEngine::onRemoveChannelSelection(QList<id> t_L_id)
 
 void DmxEngine::onAddOutputSelection(QList<Uid_Id> t_L_Uid_Id)
 {
-  for (qsizetype i = 0;
-       i < t_L_Uid_Id.size();
-       i++)
+  int changedCount = 0;
+  for (const auto &item
+       : std::as_const(t_L_Uid_Id))
   {
-    Uid_Id outputUid_Id = t_L_Uid_Id.at(i);
-    if (m_L_outputUid_IdSelection.indexOf(outputUid_Id) == -1)
-    {
-      m_L_outputUid_IdSelection.append(outputUid_Id);
-    }
+    changedCount += m_outputSelection.add(outputIndex(item));
+  }
+  m_selType = SelectionType::OutputSelectionType;
+  if (changedCount > 0)
+    emit outputSelectionChanged();
+}
+
+void DmxEngine::onAddOutputRangeSelection(Uid_Id t_first,
+                                          Uid_Id t_last)
+{
+  int first = outputIndex(t_first);
+  int last = outputIndex(t_last);
+  if (first == -1
+      || last == -1
+      || t_first.getUniverseID() != t_last.getUniverseID())
+  {
+    qWarning() << "can't DmxEngine::onAddOutputRangeSelection"
+               << t_first.toString() << t_last.toString();
+    return;
   }
   m_selType = SelectionType::OutputSelectionType;
+  if (m_outputSelection.addRange(first,
+                                 last) > 0)
+    emit outputSelectionChanged();
 }
 
 void DmxEngine::onRemoveOutputSelection(QList<Uid_Id> t_L_Uid_Id)
 {
-  for (qsizetype i = 0;
-       i < t_L_Uid_Id.size();
-       i++)
+  int changedCount = 0;
+  for (const auto &item
+       : std::as_const(t_L_Uid_Id))
   {
-    Uid_Id outputUid_Id = t_L_Uid_Id.at(i);
-    int index = m_L_outputUid_IdSelection.indexOf(outputUid_Id);
-    if (index != -1)
-    {
-      m_L_outputUid_IdSelection.remove(index);
-    }
+    changedCount += m_outputSelection.remove(outputIndex(item));
   }
+  if (changedCount > 0)
+    emit outputSelectionChanged();
 }
 
 void DmxEngine::onSelectAll()
@@ -1148,9 +1898,8 @@ void DmxEngine::onSelectAll()
 
 void DmxEngine::onClearOutputSelection()
 {
-
-  m_L_outputUid_IdSelection.clear();
-  m_L_outputUid_IdSelection.squeeze();
+  if (m_outputSelection.clear() > 0)
+    emit outputSelectionChanged();
 }
 
 void DmxEngine::onSetLevel(dmx t_level)
@@ -1170,19 +1919,74 @@ void DmxEngine::onSetLevel(dmx t_level)
   // that's output
   if (m_selType == SelectionType::OutputSelectionType)
   {
-    for (qsizetype i = 0;
-         i < m_L_outputUid_IdSelection.size();
-         i++)
+    const auto L_Uid_Id = getL_selectedOutput();
+    for (const auto &item
+         : L_Uid_Id)
     {
-      m_outputEngine
-          ->onDirectOutputLevelChanged(m_L_outputUid_IdSelection.at(i),
-                                       t_level);
+      m_outputEngine->onDirectOutputLevelChanged(item,
+                                                 t_level);
     }
     return;
   }
   return;
 }
 
+void DmxEngine::onScaleLevel(int t_percent)
+{
+  if (m_selType != SelectionType::ChannelSelectionType)
+  {
+    qDebug() << "scale works on channels only";
+    return;
+  }
+  m_channelEngine->onSelectedChannelListScale(t_percent);
+}
+
+void DmxEngine::onFanLevel(dmx t_first,
+                           dmx t_last,
+                           FanMode t_mode)
+{
+  if (m_selType != SelectionType::ChannelSelectionType)
+  {
+    qDebug() << "fan works on channels only";
+    return;
+  }
+  m_channelEngine->onSelectedChannelListFan(t_first,
+                                            t_last,
+                                            t_mode);
+}
+
+void DmxEngine::onSetEffect(id t_id,
+                            EffectWaveform t_waveform,
+                            float t_rate,
+                            float t_phaseSpread,
+                            dmx t_size,
+                            EffectMergeMode t_mergeMode)
+{
+  if (m_selType != SelectionType::ChannelSelectionType)
+  {
+    qDebug() << "effects work on channels only";
+    return;
+  }
+  DmxEffect effect(t_id,
+                   t_waveform);
+  effect.setRate(t_rate);
+  effect.setPhaseSpread(t_phaseSpread);
+  effect.setSize(t_size);
+  effect.setMergeMode(t_mergeMode);
+  effect.setL_channelId(m_channelEngine->getL_selectedChannelId());
+  m_effectEngine->setEffect(effect);
+}
+
+void DmxEngine::onRemoveEffect(id t_id)
+{
+  m_effectEngine->removeEffect(t_id);
+}
+
+void DmxEngine::onClearEffects()
+{
+  m_effectEngine->clear();
+}
+
 void DmxEngine::onSendError()
 {
   qDebug() << "error from interpreter";
@@ -1204,6 +2008,7 @@ void DmxEngine::onPlusPercent()
   // that's channel
   if (m_selType == SelectionType::ChannelSelectionType)
   {
+    // in line with the interpreter, the next command sees it
     m_channelEngine->onChannelLevelPlusFromDirectChannel(true,
                                                          DMX_INCREMENT_DEFAULT);
     return;
@@ -1211,12 +2016,11 @@ void DmxEngine::onPlusPercent()
   // that's output
   if (m_selType == SelectionType::ChannelSelectionType)
   {
-    for (qsizetype i = 0;
-         i < m_L_outputUid_IdSelection.size();
-         i++)
+    const auto L_Uid_Id = getL_selectedOutput();
+    for (const auto &item
+         : L_Uid_Id)
     {
-      m_outputEngine
-          ->onDirectOutputLevelPlus(m_L_outputUid_IdSelection.at(i));
+      m_outputEngine->onDirectOutputLevelPlus(item);
     }
     return;
   }
@@ -1234,6 +2038,7 @@ void DmxEngine::onMoinsPercent()
   // that's channel
   if (m_selType == SelectionType::ChannelSelectionType)
   {
+    // in line with the interpreter, the next command sees it
     m_channelEngine->onChannelLevelPlusFromDirectChannel(false,
                                                          DMX_INCREMENT_DEFAULT);
     return;
@@ -1241,12 +2046,11 @@ void DmxEngine::onMoinsPercent()
   // that's output
   if (m_selType == SelectionType::ChannelSelectionType)
   {
-    for (qsizetype i = 0;
-         i < m_L_outputUid_IdSelection.size();
-         i++)
+    const auto L_Uid_Id = getL_selectedOutput();
+    for (const auto &item
+         : L_Uid_Id)
     {
-      m_outputEngine
-          ->onDirectOutputLevelMoins(m_L_outputUid_IdSelection.at(i));
+      m_outputEngine->onDirectOutputLevelMoins(item);
     }
     return;
   }
@@ -1346,6 +2150,16 @@ void DmxEngine::onDeleteGroup(id t_id)
   
 }
 
+void DmxEngine::onBatchStarted()
+{
+  m_channelEngine->beginBatch();
+}
+
+void DmxEngine::onBatchFinished()
+{
+  m_channelEngine->endBatch();
+}
+
 /******************************** DmxPatch *******************************/
 
 void DmxPatch::clearPatch()
@@ -21,8 +21,15 @@
 #include <QObject>
 #include <QParallelAnimationGroup>
 #include <QEasingCurve>
+#include <QTimer>
+#include <QAbstractAnimation>
 #include "../qontrejour.h"
 #include "dmxvalue.h"
+#include "enginesnapshot.h"
+#include "watchdog.h"
+#include "mpscqueue.h"
+#include "selectionset.h"
+#include <type_traits>
 
 /****************************** ChannelGroupEngine ***********************/
 
@@ -49,6 +56,10 @@ public :
   DmxChannelGroup *createChannelGroup(QList<DmxChannel *> t_L_channel);
 //  DmxChannelGroup *createChannelGroup(QList<id> t_L_channelId);
 
+  // set group value level, group sliders follow
+  bool setGroupLevel(const id t_groupId,
+                     const dmx t_level);
+
 private :
 
   void addChannelGroup(id t_groupID,
@@ -134,6 +145,10 @@ public :
   void goBack();
   void goPause();
 
+protected :
+
+  void updateCurrentTime(int t_currentTime) override;
+
 private :
 
   void setSelectedSceneLevel(dmx t_level);
@@ -196,22 +211,31 @@ public :
   void setRootChannel(RootValue *t_rootChannel)
   { m_rootChannel = t_rootChannel; }
 
-  QList<id> getL_selectedChannelId() const
-  { return m_L_selectedChannelId; }
+  // going up by id
+  QList<id> getL_selectedChannelId() const;
+  const SelectionSet &getSelection() const{ return m_selection; }
   DmxChannel *getChannel(const id &t_id) const;
 
   QList<DmxChannel *> getL_selectedChannel();
+  // each one emits selectionChanged() once, if something changed
   void addL_idToL_select(const QList<id> &t_L_id);
   void addIdToL_select(const id &t_id);
+  void addRangeToL_select(id t_first,
+                          id t_last);
   void removeL_idFromL_select(const QList<id> &t_L_id);
   void removeIdFromL_select(const id &t_id);
+  void removeRangeFromL_select(id t_first,
+                               id t_last);
+  void invertSelection();
 
   void selectNonNullChannels();
 
-signals :
-
-  void sigToUpdateChannelView();
-
+  // interpreter scripts : channels touched by commands are updated
+  // once, at endBatch(). flushBatch() updates them now, for commands
+  // reading channel levels
+  void beginBatch(){ m_batchDepth++; }
+  void endBatch();
+  void flushBatch();
 
 public slots :
 
@@ -219,21 +243,53 @@ public slots :
                                       dmx t_level);
   void onChannelLevelChangedFromSliderChannel(id t_id,
                                               dmx t_level);
+  // selection level column, through LevelKernel
   void onChannelLevelPlusFromDirectChannel(const bool t_isPlus,
                                            const int t_increment = DMX_INCREMENT_MIN);
   void onSelectedChannelListAtLevel(dmx t_level);
+  void onSelectedChannelListScale(int t_percent);
+  void onSelectedChannelListFan(dmx t_first,
+                                dmx t_last,
+                                FanMode t_mode = FanMode::LinearFan);
   void onChannelLevelChangedFromScene(id t_channelid,
                                       dmx t_level,
                                       CueRole t_role = CueRole::NewSelectRole);
 
   void clearSelection();
 
+signals :
+
+  // once per command, views read getSelection()
+  void selectionChanged();
+
+private :
+
+  // now, or at end of batch
+  void updateChannel(DmxChannel *t_channel);
+  // set and channel flag, no signal. Return true if changed
+  bool selectId(id t_id);
+  bool deselectId(id t_id);
+  bool clearSelectionSet();
+  // selected channels and their direct level + offset, going up by id
+  void gatherDirectColumn();
+  // back to the channels, then updated
+  void scatterDirectColumn(bool t_isDirectChannel);
+
 private :
 
   RootValue *m_rootChannel;
 
   // QList<id> m_L_directChannelId;
-  QList<id> m_L_selectedChannelId;
+  SelectionSet m_selection; // by channel id
+
+  int m_batchDepth = 0;
+  SelectionSet m_batchChannel; // to update at end of batch
+
+  // reused by level kernels
+  QList<DmxChannel *> m_L_columnChannel;
+  QList<int> m_L_directColumn;
+  QList<dmx> m_L_directLevel;
+  QList<overdmx> m_L_directOffset;
 
 };
 
@@ -271,6 +327,274 @@ private :
 
 };
 
+/****************************** InputEngine ******************************/
+
+class NetworkInputThread;
+
+// network input layer : received universes go to the channels
+// patched on the same outputs, merged in DmxChannel::update()
+class InputEngine
+    : public QObject
+{
+
+  Q_OBJECT
+
+public :
+
+  explicit InputEngine(QList<RootValue *> t_L_rootOutput,
+                       QObject *parent = nullptr);
+
+  ~InputEngine();
+
+  NetworkInputThread *getInputThread() const{ return m_inputThread; }
+  InputMergeMode getMergeMode() const{ return m_mergeMode; }
+
+  void setInputThread(NetworkInputThread *t_inputThread);
+  void setMergeMode(InputMergeMode t_mergeMode)
+  { m_mergeMode = t_mergeMode; }
+
+public slots :
+
+  // called once per engine tick
+  void update();
+
+private :
+
+  void applyUniverse(uid t_uid,
+                     bool t_isActive);
+
+private :
+
+  QList<RootValue *> m_L_rootOutput;
+  NetworkInputThread *m_inputThread = nullptr;
+  InputMergeMode m_mergeMode = InputMergeMode::HtpMerge;
+
+  // last frame read per universe, to only touch changed slots
+  QList<QByteArray> m_L_frame;
+  QList<QByteArray> m_L_lastFrame;
+  QList<quint32> m_L_sequence;
+  QList<bool> m_L_isActive;
+
+};
+
+/******************************* EffectClock *****************************/
+
+// effect time, driven like cue fades by the animation driver of the
+// thread : wall clock, or VirtualAnimationDriver in qontrejour-render
+class EffectClock
+    : public QAbstractAnimation
+{
+
+public :
+
+  explicit EffectClock(QObject *parent = nullptr)
+      : QAbstractAnimation(parent)
+  {}
+
+  ~EffectClock(){}
+
+  int duration() const override{ return -1; } // runs till stopped
+
+protected :
+
+  void updateCurrentTime(int t_currentTime) override
+  { Q_UNUSED(t_currentTime) } // read at engine tick
+
+};
+
+/******************************** DmxEffect ******************************/
+
+// waveform over a list of channels. Channel i starts
+// i * phaseSpread / channelCount cycle after the first one
+class DmxEffect
+{
+
+public :
+
+  explicit DmxEffect(id t_id = NO_ID,
+                     EffectWaveform t_waveform = EffectWaveform::SineWave)
+      : m_id(t_id),
+        m_waveform(t_waveform)
+  {}
+
+  ~DmxEffect(){}
+
+  id getid() const{ return m_id; }
+  EffectWaveform getWaveform() const{ return m_waveform; }
+  float getRate() const{ return m_rate; }
+  float getPhaseSpread() const{ return m_phaseSpread; }
+  dmx getSize() const{ return m_size; }
+  EffectMergeMode getMergeMode() const{ return m_mergeMode; }
+  quint32 getSeed() const{ return m_seed; }
+  QList<id> getL_channelId() const{ return m_L_channelId; }
+
+  void setid(id t_id){ m_id = t_id; }
+  void setWaveform(EffectWaveform t_waveform){ m_waveform = t_waveform; }
+  void setRate(float t_rate){ m_rate = t_rate; }
+  void setPhaseSpread(float t_phaseSpread){ m_phaseSpread = t_phaseSpread; }
+  void setSize(dmx t_size){ m_size = t_size; }
+  void setMergeMode(EffectMergeMode t_mergeMode){ m_mergeMode = t_mergeMode; }
+  void setSeed(quint32 t_seed){ m_seed = t_seed; }
+  void setL_channelId(const QList<id> &t_L_channelId)
+  { m_L_channelId = t_L_channelId; }
+
+private :
+
+  id m_id = NO_ID;
+  EffectWaveform m_waveform = EffectWaveform::SineWave;
+  float m_rate = EFFECT_RATE_DEFAULT;
+  float m_phaseSpread = EFFECT_PHASE_SPREAD_DEFAULT;
+  dmx m_size = MAX_DMX;
+  EffectMergeMode m_mergeMode = EffectMergeMode::HtpEffect;
+  quint32 m_seed = EFFECT_SEED_DEFAULT;
+  QList<id> m_L_channelId;
+
+};
+
+/****************************** EffectEngine *****************************/
+
+// every effect is computed once per engine tick, as a column, by
+// LevelKernel::waveform(). Columns are merged by channel, htp or
+// added, then set on the channels effect layer.
+// Engine thread only.
+class EffectEngine
+    : public QObject
+{
+
+  Q_OBJECT
+
+public :
+
+  explicit EffectEngine(RootValue *t_rootChannel,
+                        QObject *parent = nullptr);
+
+  ~EffectEngine();
+
+  int getEffectCount() const{ return m_L_runningEffect.size(); }
+  QList<DmxEffect> getL_effect() const;
+  // ms, effects clock
+  qint64 getTime() const{ return m_clock->currentTime(); }
+
+  // replaces the one with same id, which starts again at phase 0
+  void setEffect(const DmxEffect &t_effect);
+  bool removeEffect(id t_id);
+  void clear();
+
+public slots :
+
+  // once per engine tick
+  void update();
+
+private :
+
+  struct RunningEffect
+  {
+    DmxEffect m_effect;
+    qint64 m_startTime = 0;
+    QList<float> m_L_phaseOffset; // by channel index, in [0, 1)
+    QList<int> m_L_level; // this tick
+  };
+
+  int indexOf(id t_id) const;
+  void evaluate(RunningEffect &t_runningEffect,
+                qint64 t_time);
+
+private :
+
+  RootValue *m_rootChannel;
+  EffectClock *m_clock;
+  QList<RunningEffect> m_L_runningEffect;
+
+  // by channel id, every effect of this tick merged
+  QList<int> m_L_effectLevel;
+  QList<int> m_L_effectOffset;
+  SelectionSet m_effectChannel;
+  SelectionSet m_lastEffectChannel; // to clear when their effect ends
+
+};
+
+/***************************** PendingLevelTable *************************/
+
+// latest requested level per id, taken once per engine tick.
+// A burst of requests on the same id costs one update.
+class PendingLevelTable
+{
+
+public :
+
+  PendingLevelTable(){}
+
+  ~PendingLevelTable(){}
+
+  bool isEmpty() const{ return m_L_dirtyId.isEmpty(); }
+  // ns, LatencyStats clock, of the first request since last take()
+  qint64 getOldestRequestTime() const{ return m_oldestRequestTime; }
+
+  void setLevel(id t_id,
+                dmx t_level,
+                qint64 t_requestTime = 0);
+  // append pending levels in request order, then clear.
+  // storage keeps its capacity, no allocation once warm
+  void take(QList<Ch_Id_Dmx> &t_L_id_dmx);
+
+private :
+
+  QList<int> m_L_level; // -1 : nothing pending
+  QList<id> m_L_dirtyId;
+  qint64 m_oldestRequestTime = 0;
+
+};
+
+/****************************** EngineCommand ****************************/
+
+// input for the engine, from any thread. Drained at tick start.
+struct EngineCommand
+{
+  EngineCommandType m_type = UnknownEngineCommand;
+  id m_id = NO_ID; // channel or group
+  int m_value = 0; // see EngineCommandType
+  qint64 m_requestTime = 0; // ns, LatencyStats clock
+};
+static_assert(std::is_trivially_copyable<EngineCommand>::value,
+              "EngineCommand is copied through MpscQueue");
+
+typedef MpscQueue<EngineCommand, ENGINE_COMMAND_QUEUE_SIZE> EngineCommandQueue;
+
+/******************************* InputLatency ****************************/
+
+// time between an input request and the tick which applied it,
+// ns. Output thread adds at most one frame on top.
+class InputLatency
+{
+
+public :
+
+  InputLatency(){}
+
+  ~InputLatency(){}
+
+  qint64 getLast() const{ return m_last; }
+  qint64 getMax() const{ return m_max; }
+  qint64 getAverage() const{ return m_count ? m_total / m_count : 0; }
+  qint64 getCount() const{ return m_count; }
+
+  void addSample(qint64 t_latency)
+  { m_last = t_latency;
+    if (t_latency > m_max) m_max = t_latency;
+    m_total += t_latency;
+    m_count++; }
+  void reset()
+  { m_last = 0; m_max = 0; m_total = 0; m_count = 0; }
+
+private :
+
+  qint64 m_last = 0;
+  qint64 m_max = 0;
+  qint64 m_total = 0;
+  qint64 m_count = 0;
+
+};
+
 /******************************* DmxEngine ***************************/
 
 class DmxEngine
@@ -294,24 +618,80 @@ public :
   CueEngine *getCueEngine() const{ return m_cueEngine; }
   ChannelEngine *getChannelEngine() const{ return m_channelEngine; }
   OutputEngine *getOutputEngine() const{ return m_outputEngine; }
+  InputEngine *getInputEngine() const{ return m_inputEngine; }
+  EffectEngine *getEffectEngine() const{ return m_effectEngine; }
+  SnapshotPublisher *getSnapshotPublisher() const{ return m_snapshotPublisher; }
+  const InputLatency &getInputLatency() const{ return m_inputLatency; }
+  // beaten every tick, for the stall watchdog
+  Heartbeat *getHeartbeat(){ return &m_heartbeat; }
+  // commands lost because the queue was full
+  quint64 getDroppedCommandCount() const
+  { return m_droppedCommandCount.load(std::memory_order_relaxed); }
 
   void setMainSeq(id t_id);
+  void resetInputLatency(){ m_inputLatency.reset(); }
 
 private :
 
   QList<DmxChannel *> getSelectedChannels()const;
+  QList<Uid_Id> getL_selectedOutput() const;
+  // stamps the request time, false if queue is full
+  bool pushCommand(EngineCommand t_command);
+  // commands into pending tables and button list
+  void drainCommands();
+  void flushPendingInput();
+  void applyPlayBackButton(PlayBackButton t_button);
+
+signals :
+
+  // keypad fifo, drained at tick
+  void keypadButtonReady(KeypadButton t_button);
+
+  // start of tick, direct connections feed pending tables
+  void tickStarted();
+  // end of tick, every layer is up to date
+  void ticked();
+  // once per command
+  void outputSelectionChanged();
 
 public slots :
 
+  // polled layers, ENGINE_TICK_INTERVAL
+  void onTick();
+
+  // pending input, any thread : pushed in the command queue and
+  // consumed once per tick. Connect with Qt::DirectConnection, a
+  // queued call would only add an event before the push.
+  // Only the latest level per channel and group is kept
+  void requestChannelLevel(id t_id,
+                           dmx t_level);
+  void requestGroupLevel(id t_id,
+                         dmx t_level);
+  // keypad and playback are applied in order
+  void requestKeypadButton(KeypadButton t_button);
+  void requestPlayBackButton(PlayBackButton t_button);
+  // wheel and drag increments on selected channels, summed.
+  // keypad +% and -% apply at once, see onPlusPercent
+  void requestDirectChannelDelta(int t_delta);
+
   // connected to interpreter
   void onAddChannelSelection(QList<id> t_L_id);
+  void onAddChannelRangeSelection(id t_first,
+                                  id t_last);
   void onRemoveChannelSelection(QList<id> t_L_id);
   void onAddOutputSelection(QList<Uid_Id> t_L_Uid_Id);
+  // same universe
+  void onAddOutputRangeSelection(Uid_Id t_first,
+                                 Uid_Id t_last);
   void onRemoveOutputSelection(QList<Uid_Id> t_L_Uid_Id);
   void onSelectAll();
 //  void onClearChannelSelection();
   void onClearOutputSelection();
   void onSetLevel(dmx t_level);
+  void onScaleLevel(int t_percent);
+  void onFanLevel(dmx t_first,
+                  dmx t_last,
+                  FanMode t_mode);
   void onSendError();
   void onSendError_NoValueSpecified();
   void onPlusPercent();
@@ -330,6 +710,17 @@ public slots :
   void onDeleteCue(sceneID_f t_id);
   void onDeleteStep(id t_id);
   void onDeleteGroup(id t_id);
+  void onBatchStarted();
+  void onBatchFinished();
+  // effect on the selected channels, replaces effect t_id
+  void onSetEffect(id t_id,
+                   EffectWaveform t_waveform,
+                   float t_rate,
+                   float t_phaseSpread,
+                   dmx t_size,
+                   EffectMergeMode t_mergeMode = EffectMergeMode::HtpEffect);
+  void onRemoveEffect(id t_id);
+  void onClearEffects();
 
   // TODO : renvoyer le dernier id selectionné à l'interpreter
 private :
@@ -338,9 +729,27 @@ private :
   CueEngine *m_cueEngine;
   ChannelEngine *m_channelEngine;
   OutputEngine *m_outputEngine;
+  InputEngine *m_inputEngine;
+  EffectEngine *m_effectEngine;
+  SnapshotPublisher *m_snapshotPublisher;
+  QTimer *m_tickTimer;
+
+  EngineCommandQueue m_commandQueue;
+  std::atomic<quint64> m_droppedCommandCount{0};
+
+  // engine thread only
+  PendingLevelTable m_pendingChannelLevel;
+  PendingLevelTable m_pendingGroupLevel;
+  QList<Ch_Id_Dmx> m_L_pendingLevel; // reused each tick
+  QList<EngineCommand> m_L_pendingButton; // keypad and playback
+  int m_pendingDirectChannelDelta = 0;
+  qint64 m_deltaRequestTime = 0;
+  InputLatency m_inputLatency;
+  Heartbeat m_heartbeat{"engine"};
 
   // members for interpreter
-  QList<Uid_Id> m_L_outputUid_IdSelection;
+  // by universe * UNIVERSE_OUTPUT_COUNT_DEFAULT + output
+  SelectionSet m_outputSelection;
   SelectionType m_selType = SelectionType::ChannelSelectionType;
 
 };
@@ -16,21 +16,34 @@
  */
 
 #include "dmxmanager.h"
+#include "networkoutput.h"
+#include "oscserver.h"
+#include "midiinput.h"
+#include <QCoreApplication>
 #include <QDebug>
 
 DmxManager::DmxManager(QObject *parent)
   : QObject(parent),
     m_hwManager(QDmxManager::instance()),
+    m_outputThread(new OutputThread(this)),
+    m_hwFrameBuffer(1,
+                    false),
+    m_stallWatchdog(new StallWatchdog(this)),
+    m_engineThread(new QThread(this)),
     m_dmxPatch(new DmxPatch()),
     m_rootChannel(new RootValue(ValueType::RootChannel)),
     m_rootChannelGroup(new RootValue(ValueType::RootChannelGroup))
 {
+  m_engineThread->setObjectName("engine");
+
   // init hardware manager
   m_hwManager->init();
 
   // we create first universe
   auto universe = new DmxUniverse(0);
   m_L_universe.append(universe);
+  m_outputThread->getFrameBuffer()->setUniverseCount(getUniverseCount());
+  m_hwFrameBuffer.setUniverseCount(getUniverseCount());
 
   // connection to hardware output
   connectOutputs();
@@ -40,7 +53,7 @@ DmxManager::DmxManager(QObject *parent)
        i < DEFAULT_CHANNEL_COUNT;
        i++)
   {
-    auto channel = new DmxChannel();
+    auto channel = ShowArena::instance()->createChannel();
     channel->setid(i);
     m_rootChannel->addChildValue(channel);
   }
@@ -99,9 +112,20 @@ DmxManager *DmxManager::instance()
 
 DmxManager::~DmxManager()
 {
+  stopEngineThread();
+  stopNetworkInput();
+  if (m_midiInput)
+    m_midiInput->stop();
+  m_stallWatchdog->stop();
+  m_outputThread->stop();
   m_hwManager->teardown();
-  m_rootChannel->deleteLater();
-  m_rootChannelGroup->deleteLater();
+  // values first, in one pass per arena. Roots only keep
+  // pointers, sequences keep handles and find them stale
+  ShowArena::instance()->clear();
+  qDeleteAll(m_L_sequence);
+  m_L_sequence.clear();
+  delete m_rootChannel;
+  delete m_rootChannelGroup;
   for (const auto &item
        : std::as_const(m_L_universe))
   {
@@ -215,6 +239,8 @@ bool DmxManager::createUniverse(uid t_universeID)
   {
     auto universe = new DmxUniverse(t_universeID);
     m_L_universe.append(universe);
+    m_outputThread->getFrameBuffer()->setUniverseCount(getUniverseCount());
+    m_hwFrameBuffer.setUniverseCount(getUniverseCount());
 
     return true;
   }
@@ -227,6 +253,8 @@ bool DmxManager::createUniverse(uid t_universeID)
     auto universe = new DmxUniverse(getUniverseCount());
     qDebug() << "universe id asked is too much high";
     m_L_universe.append(universe);
+    m_outputThread->getFrameBuffer()->setUniverseCount(getUniverseCount());
+    m_hwFrameBuffer.setUniverseCount(getUniverseCount());
 
     return true;
   }
@@ -266,10 +294,12 @@ void DmxManager::connectOutputs()
          : std::as_const(L_output))
     {
       auto output = static_cast<DmxOutput *>(j);
+      // from the engine thread, frame buffer is locked
       connect(output,
               SIGNAL(outputRequestUpdate(uid,id,dmx)),
               this,
-              SLOT(onOutputRequest(uid,id,dmx)));
+              SLOT(onOutputRequest(uid,id,dmx)),
+              Qt::DirectConnection);
     }
   }
 }
@@ -278,15 +308,25 @@ void DmxManager::connectInterpreterToEngine()
 {
   auto channelEngine = m_dmxEngine->getChannelEngine();
   auto cueEngine  = m_dmxEngine->getCueEngine();
+  // keypad goes through the engine fifo
+  connect(m_dmxEngine, &DmxEngine::keypadButtonReady,
+          m_interpreter, &Interpreter::recieveData);
+
   connect(m_interpreter, &Interpreter::addChannelSelection,
           m_dmxEngine, &DmxEngine::onAddChannelSelection);
 
+  connect(m_interpreter, &Interpreter::addChannelRangeSelection,
+          m_dmxEngine, &DmxEngine::onAddChannelRangeSelection);
+
   connect(m_interpreter, &Interpreter::removeChannelSelection,
           m_dmxEngine, &DmxEngine::onRemoveChannelSelection);
 
   connect(m_interpreter, &Interpreter::addOutputSelection,
           m_dmxEngine, &DmxEngine::onAddOutputSelection);
 
+  connect(m_interpreter, &Interpreter::addOutputRangeSelection,
+          m_dmxEngine, &DmxEngine::onAddOutputRangeSelection);
+
   connect(m_interpreter, &Interpreter::removeOutputSelection,
           m_dmxEngine, &DmxEngine::onRemoveOutputSelection);
 
@@ -302,6 +342,12 @@ void DmxManager::connectInterpreterToEngine()
   connect(m_interpreter, &Interpreter::setLevel,
           m_dmxEngine, &DmxEngine::onSetLevel);
 
+  connect(m_interpreter, &Interpreter::scaleLevel,
+          m_dmxEngine, &DmxEngine::onScaleLevel);
+
+  connect(m_interpreter, &Interpreter::fanLevel,
+          m_dmxEngine, &DmxEngine::onFanLevel);
+
   connect(m_interpreter, &Interpreter::sendError,
           m_dmxEngine, &DmxEngine::onSendError);
 
@@ -355,6 +401,12 @@ void DmxManager::connectInterpreterToEngine()
 
   connect(m_interpreter, &Interpreter::deleteGroup,
           m_dmxEngine, &DmxEngine::onDeleteGroup);
+
+  connect(m_interpreter, &Interpreter::batchStarted,
+          m_dmxEngine, &DmxEngine::onBatchStarted);
+
+  connect(m_interpreter, &Interpreter::batchFinished,
+          m_dmxEngine, &DmxEngine::onBatchFinished);
 }
 
 void DmxManager::setStraightPatch(const uid t_uid)
@@ -592,6 +644,196 @@ bool DmxManager::hwDisconnect(uid t_ID)
     return false;
 }
 
+void DmxManager::addOutputSink(DmxOutputSink *t_sink)
+{
+  m_outputThread->addSink(t_sink);
+  startOutputThread();
+}
+
+void DmxManager::startOutputThread()
+{
+  if (!m_outputThread->isRunning())
+    m_outputThread->start(QThread::TimeCriticalPriority);
+}
+
+bool DmxManager::startNetworkInput(int t_universeCount,
+                                   bool t_isArtNet,
+                                   bool t_isSacn)
+{
+  if (t_universeCount < 1
+      || (!t_isArtNet && !t_isSacn))
+  {
+    qWarning() << "can't DmxManager::startNetworkInput";
+    return false;
+  }
+  stopNetworkInput();
+  m_inputThread = new NetworkInputThread(t_universeCount,
+                                         t_isArtNet,
+                                         t_isSacn,
+                                         this);
+  // input engine lists are walked at every tick
+  runInEngineThread([this]()
+  {
+    m_dmxEngine->getInputEngine()->setInputThread(m_inputThread);
+  });
+  m_inputThread->start(QThread::HighPriority);
+  return true;
+}
+
+void DmxManager::stopNetworkInput()
+{
+  if (!m_inputThread)
+    return;
+  m_inputThread->stop();
+  // last frames written by the receiver release every channel
+  runInEngineThread([this]()
+  {
+    m_dmxEngine->getInputEngine()->update();
+    m_dmxEngine->getInputEngine()->setInputThread(nullptr);
+  });
+  delete m_inputThread;
+  m_inputThread = nullptr;
+}
+
+void DmxManager::setInputMergeMode(InputMergeMode t_mergeMode)
+{
+  runInEngineThread([this, t_mergeMode]()
+  {
+    m_dmxEngine->getInputEngine()->setMergeMode(t_mergeMode);
+  });
+}
+
+bool DmxManager::startOscServer(quint16 t_port)
+{
+  // feedback reads levels at tick : lives with the engine
+  bool isOpen = false;
+  runInEngineThread([&]()
+  {
+    if (!m_oscServer)
+      m_oscServer = new OscServer(m_dmxEngine,
+                                  m_dmxEngine);
+    isOpen = m_oscServer->open(t_port);
+  });
+  return isOpen;
+}
+
+bool DmxManager::startMidiInput()
+{
+  // drained at tick start, lives with the engine
+  bool isStarted = false;
+  runInEngineThread([&]()
+  {
+    if (!m_midiInput)
+      m_midiInput = new MidiInput(m_dmxEngine,
+                                  m_dmxEngine);
+    isStarted = m_midiInput->start();
+  });
+  return isStarted;
+}
+
+void DmxManager::startEngineThread()
+{
+  if (m_engineThread->isRunning())
+    return;
+  // objects with a parent can't change thread alone
+  m_dmxEngine->setParent(nullptr);
+  m_interpreter->setParent(nullptr);
+  const auto L_object = getL_engineObject();
+  for (const auto &item
+       : L_object)
+  {
+    item->moveToThread(m_engineThread);
+  }
+  m_engineThread->start(QThread::HighPriority);
+
+  // before the application is gone
+  connect(QCoreApplication::instance(),
+          SIGNAL(aboutToQuit()),
+          this,
+          SLOT(stopEngineThread()),
+          Qt::UniqueConnection);
+}
+
+void DmxManager::stopEngineThread()
+{
+  if (!m_engineThread->isRunning())
+    return;
+  // only the engine thread can hand its objects over
+  auto mainThread = thread();
+  runInEngineThread([this, mainThread]()
+  {
+    const auto L_object = getL_engineObject();
+    for (const auto &item
+         : L_object)
+    {
+      item->moveToThread(mainThread);
+    }
+  });
+  m_engineThread->quit();
+  m_engineThread->wait();
+  m_dmxEngine->setParent(this);
+  m_interpreter->setParent(this);
+}
+
+void DmxManager::runInEngineThread(const std::function<void()> &t_function)
+{
+  if (!m_engineThread->isRunning()
+      || QThread::currentThread() == m_engineThread)
+  {
+    t_function();
+    return;
+  }
+  QMetaObject::invokeMethod(m_dmxEngine,
+                            t_function,
+                            Qt::BlockingQueuedConnection);
+}
+
+QList<QObject *> DmxManager::getL_engineObject() const
+{
+  // values aren't QObject children of their root, each one moves.
+  // Engine children (engines, osc, midi, timers) move with it
+  QList<QObject *> L_object;
+  L_object << m_dmxEngine
+           << m_interpreter;
+  auto appendRoot = [&L_object](RootValue *t_rootValue)
+  {
+    L_object.append(t_rootValue);
+    const auto L_value = t_rootValue->getL_childValue();
+    for (const auto &item
+         : L_value)
+    {
+      L_object.append(item);
+    }
+  };
+  appendRoot(m_rootChannel);
+  appendRoot(m_rootChannelGroup);
+  for (const auto &item
+       : std::as_const(m_L_universe))
+  {
+    L_object.append(item);
+    appendRoot(item->getRootOutput());
+  }
+  for (const auto &item
+       : std::as_const(m_L_sequence))
+  {
+    appendRoot(item);
+    const auto L_scene = item->getL_childScene();
+    for (const auto &scene
+         : L_scene)
+    {
+      L_object.append(scene);
+    }
+  }
+  return L_object;
+}
+
+void DmxManager::startStallWatchdog()
+{
+  m_stallWatchdog->addHeartbeat(m_dmxEngine->getHeartbeat());
+  if (!m_stallWatchdog->isRunning())
+    m_stallWatchdog->start();
+}
+
 void DmxManager::connectValueToWidget(WidgetType t_widgetType,
                                       int t_widgetID,
                                       ValueType t_valueType,
@@ -626,45 +868,75 @@ QList<QDmxDevice *> DmxManager::getAvailableDevices(const QString &t_driverStrin
 
 void DmxManager::keypadToInterpreter(KeypadButton t_buttonType)
 {
-  m_interpreter->recieveData(t_buttonType);
+  m_dmxEngine->requestKeypadButton(t_buttonType);
 }
 
 void DmxManager::playBackToEngine(PlayBackButton t_buttonType)
 {
-  switch(t_buttonType)
+  m_dmxEngine->requestPlayBackButton(t_buttonType);
+}
+
+int DmxManager::commandToInterpreter(const QString &t_script)
+{
+  int commandCount = -1;
+  runInEngineThread([&]()
   {
-  case GoButton :
-    m_dmxEngine->getCueEngine()->goGo();
-    break;
-  case GoBackButton :
-    m_dmxEngine->getCueEngine()->goBack();
-    break;
-  case PauseButton :
-    m_dmxEngine->getCueEngine()->goPause();
-    break;
-  case SeqPlusButton :
-    m_dmxEngine->getCueEngine()->setSelectedPlus();
-    break;
-  case SeqMoinsButton :
-    m_dmxEngine->getCueEngine()->setSelectedMoins();
-    break;
-  default :
-    break;
-  }
+    commandCount = m_interpreter->runScript(t_script);
+  });
+  return commandCount;
 }
 
 void DmxManager::onOutputRequest(uid t_uid,
                                  id t_id,
                                  dmx t_level)
 {
-  m_hwManager->writeData(t_uid,
-                         t_id,
-                         t_level);
-
-  qDebug() << "uid :"  << t_uid
-           << "id :" << t_id
-           << "level :" << t_level;
+  m_outputThread->getFrameBuffer()->setLevel(t_uid,
+                                             t_id,
+                                             t_level);
+  m_hwFrameBuffer.setLevel(t_uid,
+                           t_id,
+                           t_level);
+  // one flush for every write of the tick
+  if (!m_isHwFlushPending.exchange(true))
+    QMetaObject::invokeMethod(this,
+                              &DmxManager::flushHwOutput,
+                              Qt::QueuedConnection);
+}
 
+void DmxManager::flushHwOutput()
+{
+  m_isHwFlushPending.store(false);
+  if (!m_hwFrameBuffer.copyFrames(m_L_hwFrame,
+                                  m_L_hwIsChanged))
+  {
+    return;
+  }
+  while (m_L_hwLastFrame.size() < m_L_hwFrame.size())
+  {
+    m_L_hwLastFrame.append(QByteArray(UNIVERSE_OUTPUT_COUNT_DEFAULT,
+                                      NULL_DMX));
+  }
+  // only outputs that moved, as before
+  for (qsizetype i = 0;
+       i < m_L_hwFrame.size();
+       i++)
+  {
+    if (!m_L_hwIsChanged.at(i))
+      continue;
+    const auto &frame = m_L_hwFrame.at(i);
+    auto &lastFrame = m_L_hwLastFrame[i];
+    for (qsizetype j = 0;
+         j < frame.size();
+         j++)
+    {
+      if (frame.at(j) == lastFrame.at(j))
+        continue;
+      m_hwManager->writeData(static_cast<uid>(i),
+                             static_cast<id>(j),
+                             static_cast<dmx>(frame.at(j)));
+    }
+    lastFrame = frame;
+  }
 }
 
 /***********************************DmxUniverse********************************/
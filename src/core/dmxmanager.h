@@ -20,13 +20,22 @@
 
 #include <QObject>
 #include <QString>
+#include <QThread>
+#include <functional>
+#include <atomic>
 #include "../../libs/QDmxLib/include/qdmxlib/QDmxManager"
 #include "../qontrejour.h"
 #include "dmxvalue.h"
+#include "valuearena.h"
 #include "dmxengine.h"
 #include "interpreter.h"
+#include "outputthread.h"
+#include "networkinput.h"
 
 class DmxPatch;
+class DmxOutputSink;
+class OscServer;
+class MidiInput;
 class DmxUniverse;
 
 class DmxManager
@@ -90,6 +99,41 @@ public :
                  uid t_ID);
   bool hwDisconnect(uid t_ID);
 
+  // in-tree network outputs (Art-Net...), sent from the output thread
+  OutputThread *getOutputThread() const{ return m_outputThread; }
+  void addOutputSink(DmxOutputSink *t_sink);
+  // also without sink : monitors and frame stats read from it
+  void startOutputThread();
+
+  // Art-Net / sACN input, merged as a channel layer
+  NetworkInputThread *getInputThread() const{ return m_inputThread; }
+  bool startNetworkInput(int t_universeCount,
+                         bool t_isArtNet = true,
+                         bool t_isSacn = true);
+  void stopNetworkInput();
+  void setInputMergeMode(InputMergeMode t_mergeMode);
+
+  // osc control and feedback
+  OscServer *getOscServer() const{ return m_oscServer; }
+  bool startOscServer(quint16 t_port = OSC_PORT_DEFAULT);
+
+  // alsa sequencer midi input
+  MidiInput *getMidiInput() const{ return m_midiInput; }
+  bool startMidiInput();
+
+  // engine, values, interpreter, osc and midi in their own thread.
+  // Render and bench keep them in the calling thread
+  QThread *getEngineThread() const{ return m_engineThread; }
+  void startEngineThread();
+  // t_function runs in the engine thread, caller waits. Direct call
+  // without engine thread or from it. Only the gui waits for the
+  // engine : what the engine sends the gui is queued, never blocking
+  void runInEngineThread(const std::function<void()> &t_function);
+
+  // engine and gui stalls, engine heartbeat is watched once started
+  StallWatchdog *getStallWatchdog() const{ return m_stallWatchdog; }
+  void startStallWatchdog();
+
   // widget connections
   // connect values with widget
   void connectValueToWidget(WidgetType t_widgetType,
@@ -112,6 +156,8 @@ private :
   QList<RootValue *> getL_rootOutput() const;
   void connectOutputs();
   void connectInterpreterToEngine();
+  // what lives in the engine thread
+  QList<QObject *> getL_engineObject() const;
 
   void testingMethod();
 
@@ -129,19 +175,39 @@ signals :
 
 public slots :
 
+  // any thread, through the engine command queue
   void keypadToInterpreter(KeypadButton t_buttonType);
   void playBackToEngine(PlayBackButton t_buttonType);
+  // text commands or script, in the engine thread, caller waits.
+  // Command count, -1 on syntax error
+  int commandToInterpreter(const QString &t_script);
+  // objects back to this thread, before the application is gone
+  void stopEngineThread();
 
 private slots :
 
-  // connected to ?
+  // from the engine thread
   void onOutputRequest(uid t_uid,
                        id t_id,
                        dmx t_level);
+  // queued to this thread, hardware plugins aren't thread safe
+  void flushHwOutput();
 
 private :
 
   QDmxManager *m_hwManager;
+  OutputThread *m_outputThread;
+  // engine writes, this thread sends to m_hwManager
+  DmxFrameBuffer m_hwFrameBuffer;
+  QList<QByteArray> m_L_hwFrame;
+  QList<bool> m_L_hwIsChanged;
+  QList<QByteArray> m_L_hwLastFrame;
+  std::atomic<bool> m_isHwFlushPending{false};
+  NetworkInputThread *m_inputThread = nullptr;
+  OscServer *m_oscServer = nullptr;
+  MidiInput *m_midiInput = nullptr;
+  StallWatchdog *m_stallWatchdog;
+  QThread *m_engineThread;
   DmxPatch *m_dmxPatch;
   DmxEngine *m_dmxEngine;
   Interpreter *m_interpreter;
@@ -19,6 +19,7 @@
 #include "dmxmanager.h"
 #include <QDebug>
 #include <QtMath>
+#include <algorithm>
 
 /********************************* ROOTVALUE *************************************/
 
@@ -46,13 +47,9 @@ RootValue::RootValue(ValueType t_type,
   }
 }
 
+// children aren't owned : channels and groups are in the show arena
 RootValue::~RootValue()
 {
-  for (const auto &item
-       : std::as_const(m_L_childValue))
-  {
-    item->deleteLater();
-  }
   m_L_childValue.clear();
   m_L_childValue.squeeze();
 }
@@ -221,6 +218,36 @@ void DmxChannel::clearControledOutput()
 }
 
 void DmxChannel::update()
+{
+  updateLocalLevel();
+  if (m_isInputActive
+      && ((m_inputMergeMode == InputMergeMode::HtpMerge
+           && m_inputLevel > m_level)
+          || (m_inputMergeMode == InputMergeMode::LtpMerge
+              && m_isInputLatest)))
+  {
+    setLevel(m_inputLevel);
+    setChannelDataFlag(ChannelDataFlag::NetworkInputFlag);
+  }
+  if (m_isEffectActive)
+    updateEffectLevel();
+}
+
+void DmxChannel::updateEffectLevel()
+{
+  // relative first, then htp
+  int level = qBound(NULL_DMX,
+                     m_level + m_effectOffset,
+                     MAX_DMX);
+  if (m_effectLevel > level)
+    level = m_effectLevel;
+  if (level == m_level)
+    return;
+  setLevel(static_cast<dmx>(level));
+  setChannelDataFlag(ChannelDataFlag::EffectFlag);
+}
+
+void DmxChannel::updateLocalLevel()
 {
   setChannelDataFlag(ChannelDataFlag::UnknownFlag);
   if (m_channelGroupLevel >= m_directChannelLevel)
@@ -263,9 +290,16 @@ DmxChannelGroup::DmxChannelGroup(ValueType t_type,
   setName(DEFAULT_GROUP_NAME);
 }
 
+// no member revision : arena clear() may run at exit
 DmxChannelGroup::~DmxChannelGroup()
 {
-  clearControledChannel();
+  m_H_controledChannel_storedLevel.clear();
+}
+
+void DmxChannelGroup::setH_controledChannel_storedLevel(const QHash<DmxChannel *, dmx> &t_H_controledChannel_storedLevel)
+{
+  m_H_controledChannel_storedLevel = t_H_controledChannel_storedLevel;
+  ShowArena::instance()->bumpMemberRevision();
 }
 
 dmx DmxChannelGroup::getControledChannelStoredLevel(const id t_id)
@@ -306,6 +340,7 @@ void DmxChannelGroup::addChannel(DmxChannel *t_dmxChannel,
   {
     m_H_controledChannel_storedLevel.insert(t_dmxChannel,
                                             t_storedLevel);
+    ShowArena::instance()->bumpMemberRevision();
   }
   else
     qWarning() << "cant DmxChannelGroup::addChannel";
@@ -341,6 +376,7 @@ void DmxChannelGroup::removeChannel(DmxChannel *t_channel)
     return;
   }
   m_H_controledChannel_storedLevel.remove(t_channel);
+  ShowArena::instance()->bumpMemberRevision();
 //  t_channel->removeChannelGroupControler(m_ID);
 }
 
@@ -370,6 +406,7 @@ void DmxChannelGroup::removeChannelList(const QList<id> t_L_id)
 void DmxChannelGroup::clearControledChannel()
 {
   m_H_controledChannel_storedLevel.clear();
+  ShowArena::instance()->bumpMemberRevision();
 }
 
 /****************************** RootScene ****************************/
@@ -380,59 +417,116 @@ Sequence::Sequence(ValueType t_type,
                 t_parent),
     IdedValue()
 {
-  auto scene0 = new DmxScene(ValueType::Scene0,
-                             this);
+  auto scene0 = ShowArena::instance()->createScene(ValueType::Scene0);
+  scene0->setSequence(this);
   scene0->setNotes("Blank");
   scene0->setName("0");
   scene0->setSceneID(0.0f);
   scene0->setStepNumber(0);
-  m_L_childScene.append(scene0);
+  m_L_sceneHandle.append(scene0->getHandle());
+
+  // steps and selection moved : next cue may be another one
+  connect(this,
+          &Sequence::seqSignalChanged,
+          this,
+          [](){ ShowArena::instance()->bumpMemberRevision(); });
 }
 
 Sequence::~Sequence()
 {
-  m_L_childScene.clear();
-  m_L_childScene.squeeze();
+  // stale handles if the show arena was cleared first,
+  // destroy() checks them without touching the scene
+  auto sceneArena = ShowArena::instance()->getSceneArena();
+  for (const auto item
+       : std::as_const(m_L_sceneHandle))
+  {
+    sceneArena->destroy(item);
+  }
+  m_L_sceneHandle.clear();
+  m_L_sceneHandle.squeeze();
+}
+
+QList<DmxScene *> Sequence::getL_childScene() const
+{
+  QList<DmxScene *> L_scene;
+  L_scene.reserve(m_L_sceneHandle.size());
+  for (qsizetype i = 0;
+       i < m_L_sceneHandle.size();
+       i++)
+  {
+    auto scene = getSceneAt(i);
+    if (scene)
+      L_scene.append(scene);
+  }
+  return L_scene;
+}
+
+void Sequence::setL_childScene(const QList<DmxScene *> &t_L_childScene)
+{
+  m_L_sceneHandle.clear();
+  for (const auto &item
+       : t_L_childScene)
+  {
+    m_L_sceneHandle.append(item->getHandle());
+  }
+}
+
+DmxScene *Sequence::getSceneAt(qsizetype t_step) const
+{
+  return ShowArena::instance()->getSceneArena()->get(m_L_sceneHandle.at(t_step));
 }
 
 DmxScene *Sequence::getScene(id t_step)
 {
-  if (t_step < m_L_childScene.size()
+  if (t_step < m_L_sceneHandle.size()
       && t_step > -1)
-    return m_L_childScene.at(t_step);
+    return getSceneAt(t_step);
 
   return nullptr;
 }
 
 DmxScene *Sequence::getScene(sceneID_f t_id)
 {
-  for (qsizetype i = 0;
-       i < m_L_childScene.size();
-       i++)
-  {
-    auto scene = m_L_childScene.at(i);
-    if (t_id == scene->getSceneID())
-      return scene;
-  }
-  return nullptr;
+  auto step = getStep(t_id);
+  if (step == NO_ID)
+    return nullptr;
+  return getSceneAt(step);
 }
 
 id Sequence::getSelectedStepId() const
 {
-  for (qsizetype i = 0;
-       i < m_L_childScene.size();
-       i++)
+  auto step = getStep(m_selectedSceneId);
+  return step == NO_ID ? 0 : step;
+}
+
+id Sequence::getStep(sceneID_f t_id) const
+{
+  auto sceneArena = ShowArena::instance()->getSceneArena();
+  auto it = std::lower_bound(m_L_sceneHandle.cbegin(),
+                             m_L_sceneHandle.cend(),
+                             t_id,
+                             [sceneArena](ValueHandle t_handle,
+                                          sceneID_f t_sceneId)
+                             {
+                               auto scene = sceneArena->get(t_handle);
+                               return scene
+                                      && scene->getSceneID() < t_sceneId;
+                             });
+  if (it == m_L_sceneHandle.cend())
+    return NO_ID;
+  auto scene = sceneArena->get(*it);
+  if (!scene
+      || scene->getSceneID() != t_id)
   {
-    auto scene = m_L_childScene.at(i);
-    if (scene->getSceneID() == m_selectedSceneId)
-      return i;
+    return NO_ID;
   }
-  return 0;
+  return static_cast<id>(it - m_L_sceneHandle.cbegin());
 }
 
 void Sequence::addScene(DmxScene *t_scene)
 {
-  sceneID_f lastID = m_L_childScene.last()->getSceneID();
+  auto lastScene = getSceneAt(m_L_sceneHandle.size() - 1);
+  sceneID_f lastID = lastScene ? lastScene->getSceneID() : 0.0f;
   auto intIndex = qCeil(lastID);
   if (intIndex <10)
     t_scene->setSceneID(10.0f);
@@ -445,8 +539,10 @@ void Sequence::addScene(DmxScene *t_scene)
   }
   id size = getSize();
   t_scene->setStepNumber(size);
-  m_L_childScene.append(t_scene);
+  emit sceneAboutToBeInserted(size);
+  m_L_sceneHandle.append(t_scene->getHandle());
   t_scene->setSequence(this);
+  emit sceneInserted(size);
   // we set to 0 selected scene
 //  auto scene = getScene(m_selectedSceneId);
 //  if (scene) scene->setLevel(NULL_DMX);
@@ -457,7 +553,7 @@ void Sequence::addScene(DmxScene *t_scene)
 //    newScene->setLevel(MAX_DMX);
     m_selectedSceneId = t_scene->getSceneID();
 //  }
-  emit seqSignalChanged(getSelectedStepId());
+  emit seqSignalChanged(size);
 }
 
 void Sequence::addScene(DmxScene *t_scene,
@@ -467,24 +563,29 @@ void Sequence::addScene(DmxScene *t_scene,
   t_scene->setSceneID(t_id);
 
   // BUG : ça va pas il faut vérifier l'id plutôt
-  auto index = m_L_childScene.indexOf(t_scene);
+  auto index = m_L_sceneHandle.indexOf(t_scene->getHandle());
   if (index == -1) // ID is not in seq
   {
     for (qsizetype i = 0;
-         i < m_L_childScene.size();
+         i < m_L_sceneHandle.size();
          i++)
     {
-      auto scene = m_L_childScene.at(i);
+      auto scene = getSceneAt(i);
+      if (!scene)
+        continue;
       if (scene->getSceneID() == t_id)
       {
         // TODO : ouvrir une fenetre pour confirmer
         // la scene d'avant est pas détruite
         qWarning() << "erase scene" << t_id;
         t_scene->setStepNumber(scene->getStepNumber());
-        m_L_childScene[i] = t_scene;
+        m_L_sceneHandle[i] = t_scene->getHandle();
 //        scene->setLevel(NULL_DMX);
 //        t_scene->setLevel(MAX_DMX);
         t_scene->setSequence(this);
+        emit sceneReplaced(i);
+        // cue engine finds its scenes by id, it gets t_scene now
+        ShowArena::instance()->destroyValue(scene);
         emit seqSignalChanged(getSelectedStepId());
         return;
       }
@@ -496,24 +597,30 @@ void Sequence::addScene(DmxScene *t_scene,
         // we set to 255 new scene
 //        t_scene->setLevel(MAX_DMX);
         m_selectedSceneId = t_scene->getSceneID();
-        m_L_childScene.insert(i, t_scene);
+        emit sceneAboutToBeInserted(i);
+        m_L_sceneHandle.insert(i, t_scene->getHandle());
         t_scene->setSequence(this);
         update(i);
-        emit seqSignalChanged(getSelectedStepId());
+        emit sceneInserted(i);
+        emit stepNumberChanged(i + 1);
+        emit seqSignalChanged(i);
         return;
       }
     }
     // we're at the end, scen id is the highest of the seq
-    t_scene->setStepNumber(m_L_childScene.size());
+    t_scene->setStepNumber(m_L_sceneHandle.size());
     // we set to 0 selected scene
 //    auto scene = getScene(m_selectedSceneId);
 //    if (scene) scene->setLevel(NULL_DMX);
     // we set to 255 new scene
 //    t_scene->setLevel(MAX_DMX);
     m_selectedSceneId = t_scene->getSceneID();
-    m_L_childScene.append(t_scene);
+    auto step = t_scene->getStepNumber();
+    emit sceneAboutToBeInserted(step);
+    m_L_sceneHandle.append(t_scene->getHandle());
     t_scene->setSequence(this);
-    emit seqSignalChanged(getSelectedStepId());
+    emit sceneInserted(step);
+    emit seqSignalChanged(step);
     return;
   }
   // TODO : ça va pas
@@ -522,21 +629,66 @@ void Sequence::addScene(DmxScene *t_scene,
 
 void Sequence::removeScene(id t_step)
 {
-  // TODO :
+  // scene 0 is the blank, always there
+  if (t_step < 1
+      || t_step >= m_L_sceneHandle.size())
+  {
+    qWarning() << "can't Sequence::removeScene";
+    return;
+  }
+  auto selectedStep = getSelectedStepId();
+  emit sceneAboutToBeRemoved(t_step);
+  auto sceneHandle = m_L_sceneHandle.takeAt(t_step);
+  if (t_step < m_L_sceneHandle.size())
+    update(t_step);
+  emit sceneRemoved(t_step);
+  if (t_step < m_L_sceneHandle.size())
+    emit stepNumberChanged(t_step);
+  if (selectedStep == t_step)
+  {
+    auto previousScene = getSceneAt(t_step - 1);
+    m_selectedSceneId = previousScene ? previousScene->getSceneID() : 0.0f;
+  }
+  ShowArena::instance()->getSceneArena()->destroy(sceneHandle);
   emit seqSignalChanged(getSelectedStepId());
 }
 
-void Sequence::removeScene(sceneID_f)
+void Sequence::removeScene(sceneID_f t_id)
 {
-  // TODO :
+  auto step = getStep(t_id);
+  if (step == NO_ID)
+  {
+    qWarning() << "can't Sequence::removeScene, no cue" << t_id;
+    return;
+  }
+  removeScene(step);
+}
 
-  emit seqSignalChanged(getSelectedStepId());
+void Sequence::clearScenes()
+{
+  emit scenesAboutToBeCleared();
+  auto sceneArena = ShowArena::instance()->getSceneArena();
+  for (qsizetype i = 1;
+       i < m_L_sceneHandle.size();
+       i++)
+  {
+    sceneArena->destroy(m_L_sceneHandle.at(i));
+  }
+  m_L_sceneHandle.resize(1);
+  m_selectedSceneId = 0.0f;
+  emit scenesCleared();
+  emit seqSignalChanged(0);
+}
 
+void Sequence::setSelectedSceneId(sceneID_f t_selectedSceneId)
+{
+  m_selectedSceneId = t_selectedSceneId;
+  ShowArena::instance()->bumpMemberRevision();
 }
 
 void Sequence::setSelectedStepId(id t_selectedStepId)
 {
-  if (t_selectedStepId < m_L_childScene.size()
+  if (t_selectedStepId < m_L_sceneHandle.size()
       && t_selectedStepId >= 0)
   {
     // we set to 0 selected scene
@@ -549,7 +701,7 @@ void Sequence::setSelectedStepId(id t_selectedStepId)
 //      newScene->setLevel(MAX_DMX);
       m_selectedSceneId = newScene->getSceneID();
     }
-    emit seqSignalChanged(getSelectedStepId());
+    emit seqSignalChanged(t_selectedStepId);
   }
   else
     qDebug() << "problem in cue selection";
@@ -557,17 +709,18 @@ void Sequence::setSelectedStepId(id t_selectedStepId)
 
 void Sequence::update(id t_step)
 {
-  if (t_step >= m_L_childScene.size())
+  if (t_step >= m_L_sceneHandle.size())
   {
     qDebug() << "problem in Sequence::update";
     return;
   }
   for (qsizetype i = t_step;
-       i < m_L_childScene.size();
+       i < m_L_sceneHandle.size();
        i++)
   {
-    auto scene = m_L_childScene.at(i);
-    scene->setStepNumber(i);
+    auto scene = getSceneAt(i);
+    if (scene)
+      scene->setStepNumber(i);
   }
 }
 
@@ -630,11 +783,12 @@ void DmxScene::setLevel(dmx t_level)
 
 /*************************** DmxSubScene *******************************/
 
+// no QObject parent, sub scenes are in the show arena
 SubScene::SubScene(ValueType t_type,
                    DmxScene *t_parent)
-    : DmxScene(t_type,
-               t_parent->getSequence())
+    : DmxScene(t_type)
 {
+  setSequence(t_parent->getSequence());
   setParentScene(t_parent);
 }
 
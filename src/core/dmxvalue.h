@@ -20,9 +20,15 @@
 
 #include <QObject>
 #include <QString>
-#include <QWidget>
+#include <QList>
+#include <QHash>
+#include <QMap>
+#include <QtAlgorithms>
 #include "../qontrejour.h"
 
+// only kept as a pointer, core builds without QtWidgets
+class QWidget;
+
 /******************************** DMXVALUE **************************************/
 
 class DmxValue
@@ -107,6 +113,9 @@ public :
                   t_parent),
       UniversedValue()
   {}
+
+  // outputs aren't in the show arena, the universe owns them
+  ~RootOutput(){ qDeleteAll(getL_childValue()); }
 };
 
 /******************************** LEVELEDVALUE **************************************/
@@ -129,6 +138,7 @@ public :
   virtual ~LeveledValue(){}
 
   dmx getLevel() const{ return m_level; }
+  ValueHandle getHandle() const{ return m_handle; }
   RootValue *getParentValue() const{ return m_parentValue; }
   QWidget *getAssignedWidget() const{ return m_assignedWidget; }
 
@@ -150,6 +160,7 @@ public slots :
                       m_level);
   }
 
+  void setHandle(ValueHandle t_handle){ m_handle = t_handle; }
   void setParentValue(RootValue *t_parentValue)
   { m_parentValue = t_parentValue; }
   void setAssignedWidget(QWidget *t_assignedWidget)
@@ -158,6 +169,7 @@ public slots :
 protected :
 
   dmx m_level = 0;
+  ValueHandle m_handle; // null if not from the show arena
   RootValue *m_parentValue = nullptr;
 
   // widget assigned to value, this may be a slider...
@@ -263,6 +275,12 @@ public :
   dmx getNextSceneLevel() const{ return m_nextSceneLevel; }
   bool getIsSelected() const{ return m_isSelected; }
   bool getIsDirectChannel() const{ return m_isDirectChannel; }
+  dmx getInputLevel() const{ return m_inputLevel; }
+  bool getIsInputActive() const{ return m_isInputActive; }
+  InputMergeMode getInputMergeMode() const{ return m_inputMergeMode; }
+  dmx getEffectLevel() const{ return m_effectLevel; }
+  int getEffectOffset() const{ return m_effectOffset; }
+  bool getIsEffectActive() const{ return m_isEffectActive; }
 
   // setters
   void setL_controledOutput(const QList<DmxOutput *> &t_L_controledOutput)
@@ -270,13 +288,16 @@ public :
   void setChannelDataFlag(ChannelDataFlag t_channelDataFlag)
   { m_channelDataFlag = t_channelDataFlag; }
   void setChannelGroupLevel(dmx t_channelGroupLevel)
-  { m_channelGroupLevel = t_channelGroupLevel; }
+  { if (t_channelGroupLevel != m_channelGroupLevel) m_isInputLatest = false;
+    m_channelGroupLevel = t_channelGroupLevel; }
   void setDirectChannelLevel(dmx t_directChannelLevel)
-  { m_directChannelLevel = t_directChannelLevel; }
+  { if (t_directChannelLevel != m_directChannelLevel) m_isInputLatest = false;
+    m_directChannelLevel = t_directChannelLevel; }
   void setDirectChannelOffset(overdmx t_directChannelOffset)
   { m_directChannelOffset = t_directChannelOffset; }
   void setSceneLevel(int t_sceneLevel)
-  { m_sceneLevel = t_sceneLevel;
+  { if (t_sceneLevel != m_sceneLevel) m_isInputLatest = false;
+    m_sceneLevel = t_sceneLevel;
     update();
   }
   void setNextSceneLevel(dmx t_nextSceneLevel)
@@ -286,6 +307,28 @@ public :
     if (!t_isSelected) clearOverdmx(); }
   void setIsDirectChannel(bool t_isDirectChannel)
   { m_isDirectChannel = t_isDirectChannel; }
+  // network input layer, call update() after
+  void setInputLevel(dmx t_inputLevel,
+                     InputMergeMode t_mergeMode)
+  { m_inputLevel = t_inputLevel;
+    m_inputMergeMode = t_mergeMode;
+    m_isInputActive = true;
+    m_isInputLatest = true; }
+  void clearInput()
+  { m_inputLevel = NULL_DMX;
+    m_isInputActive = false;
+    m_isInputLatest = false; }
+  // effect layer, once per engine tick, call update() after.
+  // t_level is htp, t_offset is added
+  void setEffect(dmx t_level,
+                 int t_offset)
+  { m_effectLevel = t_level;
+    m_effectOffset = t_offset;
+    m_isEffectActive = true; }
+  void clearEffect()
+  { m_effectLevel = NULL_DMX;
+    m_effectOffset = 0;
+    m_isEffectActive = false; }
 
   void clearChannel()
   {
@@ -316,6 +359,12 @@ public :
 
   void update();
 
+private :
+
+  // scene, group and direct levels, without network input
+  void updateLocalLevel();
+  void updateEffectLevel();
+
 private :
 
   QList<DmxOutput *>m_L_controledOutput;
@@ -330,6 +379,17 @@ private :
   bool m_isSelected = false;
   bool m_isDirectChannel = false;
 
+  // network input layer
+  dmx m_inputLevel = NULL_DMX;
+  InputMergeMode m_inputMergeMode = InputMergeMode::HtpMerge;
+  bool m_isInputActive = false;
+  bool m_isInputLatest = false; // input changed after local levels
+
+  // effect layer, over everything else
+  dmx m_effectLevel = NULL_DMX;
+  int m_effectOffset = 0;
+  bool m_isEffectActive = false;
+
 };
 Q_DECLARE_METATYPE(DmxChannel)
 
@@ -357,8 +417,7 @@ public :
   QList<id> getL_channelId();
 
   // setters
-  void setH_controledChannel_storedLevel(const QHash<DmxChannel *, dmx> &t_H_controledChannel_storedLevel)
-  { m_H_controledChannel_storedLevel = t_H_controledChannel_storedLevel; }
+  void setH_controledChannel_storedLevel(const QHash<DmxChannel *, dmx> &t_H_controledChannel_storedLevel);
 
   void addChannel(DmxChannel *t_dmxChannel,
                   const dmx t_storedLevel);
@@ -397,10 +456,11 @@ public :
 
   ~Sequence();
 
-  QList<DmxScene *> getL_childScene() const{ return m_L_childScene; }
+  // scenes still in the show arena, step order
+  QList<DmxScene *> getL_childScene() const;
   DmxScene *getScene(id t_step);
   DmxScene *getScene(sceneID_f t_id);
-  qsizetype getSize() const{ return m_L_childScene.size() ;}
+  qsizetype getSize() const{ return m_L_sceneHandle.size() ;}
   id getSelectedStepId() const;
   sceneID_f getSelectedSceneId() const{ return m_selectedSceneId; }
 
@@ -409,28 +469,44 @@ public :
                 sceneID_f t_id);
 
   void removeScene(id t_step);
-  void removeScene(sceneID_f);
+  void removeScene(sceneID_f t_id);
+  // every scene but scene 0, show closed or reloaded
+  void clearScenes();
 
-  void setL_childScene(const QList<DmxScene *> &t_L_childScene)
-  { m_L_childScene = t_L_childScene; }
+  void setL_childScene(const QList<DmxScene *> &t_L_childScene);
   void setSelectedStepId(id t_selectedStepId);
-  void setSelectedSceneId(sceneID_f t_selectedSceneId)
-  { m_selectedSceneId = t_selectedSceneId; }
+  void setSelectedSceneId(sceneID_f t_selectedSceneId);
 
 signals :
 
   void seqSignalChanged(id t_id);
 
+  // row level changes, for models
+  void sceneAboutToBeInserted(id t_step);
+  void sceneInserted(id t_step);
+  void sceneAboutToBeRemoved(id t_step);
+  void sceneRemoved(id t_step);
+  void sceneReplaced(id t_step);
+  // steps from t_step till end were renumbered
+  void stepNumberChanged(id t_step);
+  void scenesAboutToBeCleared();
+  void scenesCleared();
+
 public slots :
 
 private:
 
   // update from t_step till end
   void update(id t_step);
+  // scenes are sorted by id, binary search
+  id getStep(sceneID_f t_id) const;
+  // nullptr if destroyed, show arena cleared first
+  DmxScene *getSceneAt(qsizetype t_step) const;
 
 private :
 
-  QList<DmxScene *> m_L_childScene;
+  // scenes live in the show arena, never dereferenced stale
+  QList<ValueHandle> m_L_sceneHandle;
   sceneID_f m_selectedSceneId = 0.0f;
 };
 
@@ -0,0 +1,168 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "enginesnapshot.h"
+#include "valuearena.h"
+#include <QDebug>
+
+/****************************** ChannelSnapshot **************************/
+
+void ChannelSnapshot::resize(int t_channelCount)
+{
+  if (t_channelCount == m_L_level.size())
+    return;
+  m_L_level.resize(t_channelCount, NULL_DMX);
+  m_L_flag.resize(t_channelCount, ChannelDataFlag::UnknownFlag);
+  m_L_isSelected.resize(t_channelCount, false);
+  m_L_dirtyId.clear();
+  if (!t_channelCount)
+    return;
+  m_isRangeOnly = true;
+  m_dirtyFirst = 0;
+  m_dirtyLast = t_channelCount - 1;
+}
+
+bool ChannelSnapshot::update(id t_id,
+                             dmx t_level,
+                             ChannelDataFlag t_flag,
+                             bool t_isSelected)
+{
+  // compare on const access, write only what changed
+  if (m_L_level.at(t_id) == t_level
+      && m_L_flag.at(t_id) == t_flag
+      && m_L_isSelected.at(t_id) == t_isSelected)
+  {
+    return false;
+  }
+  m_L_level[t_id] = t_level;
+  m_L_flag[t_id] = static_cast<quint8>(t_flag);
+  m_L_isSelected[t_id] = t_isSelected;
+
+  if (m_dirtyFirst == NO_ID
+      || t_id < m_dirtyFirst)
+  {
+    m_dirtyFirst = t_id;
+  }
+  if (t_id > m_dirtyLast)
+    m_dirtyLast = t_id;
+  if (!m_isRangeOnly
+      && m_L_dirtyId.size() < SNAPSHOT_DIRTY_ID_MAX)
+  {
+    m_L_dirtyId.append(t_id);
+  }
+  else
+  {
+    m_isRangeOnly = true; // use range only
+  }
+  return true;
+}
+
+bool ChannelSnapshot::updateGroup(id t_id,
+                                  dmx t_level)
+{
+  if (m_L_groupLevel.at(t_id) == t_level)
+    return false;
+  m_L_groupLevel[t_id] = t_level;
+  m_isGroupDirty = true;
+  return true;
+}
+
+void ChannelSnapshot::resizeGroups(int t_groupCount)
+{
+  if (t_groupCount == m_L_groupLevel.size())
+    return;
+  m_L_groupLevel.resize(t_groupCount, NULL_DMX);
+  m_isGroupDirty = true;
+}
+
+bool ChannelSnapshot::updateMemberRevision(quint64 t_memberRevision)
+{
+  if (t_memberRevision == m_memberRevision)
+    return false;
+  m_memberRevision = t_memberRevision;
+  return true;
+}
+
+void ChannelSnapshot::clearDirty()
+{
+  m_isGroupDirty = false;
+  m_dirtyFirst = NO_ID;
+  m_dirtyLast = NO_ID;
+  m_L_dirtyId.clear();
+  m_isRangeOnly = false;
+}
+
+/***************************** SnapshotPublisher *************************/
+
+SnapshotPublisher::SnapshotPublisher(RootValue *t_rootChannel,
+                                     RootValue *t_rootGroup,
+                                     QObject *parent)
+  : QObject(parent),
+    m_rootChannel(t_rootChannel),
+    m_rootGroup(t_rootGroup),
+    m_timer(new QTimer(this))
+{
+  qRegisterMetaType<ChannelSnapshot>();
+  connect(m_timer,
+          SIGNAL(timeout()),
+          this,
+          SLOT(publish()));
+  m_timer->start(GUI_REFRESH_INTERVAL);
+}
+
+SnapshotPublisher::~SnapshotPublisher()
+{}
+
+void SnapshotPublisher::publish()
+{
+  m_snapshot.clearDirty();
+  auto channelCount = m_rootChannel->getL_childValueSize();
+  m_snapshot.resize(channelCount);
+
+  for (int i = 0;
+       i < channelCount;
+       i++)
+  {
+    auto channel = static_cast<DmxChannel *>(m_rootChannel->getChildValue(i));
+    m_snapshot.update(static_cast<id>(i),
+                      channel->getLevel(),
+                      channel->getChannelDataFlag(),
+                      channel->getIsSelected());
+  }
+
+  auto groupCount = m_rootGroup->getL_childValueSize();
+  m_snapshot.resizeGroups(groupCount);
+  for (int i = 0;
+       i < groupCount;
+       i++)
+  {
+    m_snapshot.updateGroup(static_cast<id>(i),
+                           m_rootGroup->getChildValue(i)->getLevel());
+  }
+
+  auto isMemberChanged
+      = m_snapshot.updateMemberRevision(ShowArena::instance()->getMemberRevision());
+
+  if (!m_snapshot.isDirty()
+      && !m_snapshot.isGroupDirty()
+      && !isMemberChanged)
+  {
+    return;
+  }
+  m_snapshot.setSerial(m_snapshot.getSerial() + 1);
+  emit snapshotPublished(m_snapshot);
+}
@@ -0,0 +1,146 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENGINESNAPSHOT_H
+#define ENGINESNAPSHOT_H
+
+#include <QObject>
+#include <QList>
+#include <QTimer>
+#include "../qontrejour.h"
+#include "dmxvalue.h"
+
+/****************************** ChannelSnapshot **************************/
+
+// what channel views show, copied from the engine at gui rate.
+// Lists are implicitly shared : a copy is cheap and never changes
+// afterwards, views may keep it as long as they want.
+class ChannelSnapshot
+{
+
+public :
+
+  ChannelSnapshot(){}
+
+  ~ChannelSnapshot(){}
+
+  quint64 getSerial() const{ return m_serial; }
+  int getChannelCount() const{ return m_L_level.size(); }
+  dmx getLevel(id t_id) const{ return m_L_level.at(t_id); }
+  ChannelDataFlag getFlag(id t_id) const
+  { return static_cast<ChannelDataFlag>(m_L_flag.at(t_id)); }
+  bool getIsSelected(id t_id) const{ return m_L_isSelected.at(t_id); }
+  bool isValidId(id t_id) const
+  { return t_id >= 0 && t_id < m_L_level.size(); }
+  // submasters, no dirty tracking : few of them
+  int getGroupCount() const{ return m_L_groupLevel.size(); }
+  dmx getGroupLevel(id t_id) const{ return m_L_groupLevel.value(t_id, NULL_DMX); }
+  bool isGroupDirty() const{ return m_isGroupDirty; }
+  // ShowArena member revision, group and cue members to read again
+  quint64 getMemberRevision() const{ return m_memberRevision; }
+
+  // what changed since previous snapshot.
+  // When isRangeOnly(), too many ids changed : getL_dirtyId() is
+  // incomplete, use the range
+  bool isDirty() const{ return m_dirtyFirst != NO_ID; }
+  id getDirtyFirst() const{ return m_dirtyFirst; }
+  id getDirtyLast() const{ return m_dirtyLast; }
+  QList<id> getL_dirtyId() const{ return m_L_dirtyId; }
+  bool isRangeOnly() const{ return m_isRangeOnly; }
+
+  // publisher side
+  void resize(int t_channelCount);
+  // return true if something changed
+  bool update(id t_id,
+              dmx t_level,
+              ChannelDataFlag t_flag,
+              bool t_isSelected);
+  // return true if something changed
+  bool updateGroup(id t_id,
+                   dmx t_level);
+  void resizeGroups(int t_groupCount);
+  // return true if it changed
+  bool updateMemberRevision(quint64 t_memberRevision);
+  void clearDirty();
+  void setSerial(quint64 t_serial){ m_serial = t_serial; }
+
+private :
+
+  quint64 m_serial = 0;
+  QList<dmx> m_L_level;
+  QList<quint8> m_L_flag;
+  QList<bool> m_L_isSelected;
+  QList<dmx> m_L_groupLevel;
+  bool m_isGroupDirty = false;
+  quint64 m_memberRevision = 0;
+
+  id m_dirtyFirst = NO_ID;
+  id m_dirtyLast = NO_ID;
+  QList<id> m_L_dirtyId;
+  bool m_isRangeOnly = false;
+
+};
+Q_DECLARE_METATYPE(ChannelSnapshot)
+
+/***************************** SnapshotPublisher *************************/
+
+// compares channels and groups with the last snapshot at gui rate
+// and publishes a new one when something changed. Views need no
+// per value connection.
+class SnapshotPublisher
+    : public QObject
+{
+
+  Q_OBJECT
+
+public :
+
+  explicit SnapshotPublisher(RootValue *t_rootChannel,
+                             RootValue *t_rootGroup,
+                             QObject *parent = nullptr);
+
+  ~SnapshotPublisher();
+
+  // engine thread only, views take what is published
+  ChannelSnapshot getSnapshot() const{ return m_snapshot; }
+  int getRefreshInterval() const{ return m_timer->interval(); }
+
+  void setRefreshInterval(int t_refreshInterval)
+  { m_timer->setInterval(t_refreshInterval); }
+
+signals :
+
+  void snapshotPublished(const ChannelSnapshot &t_snapshot);
+
+public slots :
+
+  void publish();
+  // headless engine has no view to feed
+  void start(){ m_timer->start(); }
+  void stop(){ m_timer->stop(); }
+
+private :
+
+  RootValue *m_rootChannel;
+  RootValue *m_rootGroup;
+  QTimer *m_timer;
+  // working copy, detaches from what was published when written
+  ChannelSnapshot m_snapshot;
+
+};
+
+#endif // ENGINESNAPSHOT_H
@@ -20,10 +20,307 @@
 #include <QDebug>
 #include <QtMath>
 
+// text command line, same words as osc /key where they exist
+struct CommandKeyword
+{
+  const char *m_name;
+  KeypadButton m_button;
+};
+
+static const CommandKeyword commandKeywords[] =
+{
+  {"ch", Channel}, {"chan", Channel}, {"channel", Channel},
+  {"out", Output}, {"output", Output},
+  {"cue", Cue}, {"grp", Group}, {"group", Group},
+  {"thru", Thru}, {"through", Thru},
+  {"+", Plus}, {"and", Plus}, {"-", Moins}, {"except", Moins},
+  {"@", ArobaseDmx}, {"at", ArobaseDmx},
+  {"time", Time}, {"timein", Timein}, {"timeout", Timeout},
+  {"delayin", Delayin}, {"delayout", Delayout},
+  {"rec", Record}, {"record", Record}, {"update", Update},
+  {"del", Delete}, {"delete", Delete},
+  {"patch", Patch}, {"unpatch", Unpatch},
+  {"clear", Clear}, {"all", All},
+  {"+%", Pluspc}, {"-%", Moinspc},
+  {"scale", Scale}, {"fan", Fan}, {"vfan", Vfan},
+  {"step", Step}, {"goto", Goto},
+  {"help", Help}
+};
+
+// keys working on the digits typed before them
+static bool isValuedButton(KeypadButton t_button)
+{
+  switch (t_button)
+  {
+  case Time : case Timein : case Timeout : case Delayin : case Delayout :
+  case Channel : case Output : case Cue : case Group :
+  case Plus : case Moins : case Thru :
+  case ArobaseDmx : case ArobasePercent :
+  case Scale : case Fan : case Vfan :
+  case Step :
+    return true;
+  default :
+    return false;
+  }
+}
+
+// numbers, words, @, +, -, +%, -%, %
+static bool tokenizeCommand(const QString &t_command,
+                            QStringList &t_L_token)
+{
+  for (qsizetype i = 0;
+       i < t_command.size();)
+  {
+    auto c = t_command.at(i);
+    if (c.isSpace())
+    {
+      i++;
+      continue;
+    }
+    auto start = i;
+    if (c.isDigit()
+        || c == '.')
+    {
+      while (i < t_command.size()
+             && (t_command.at(i).isDigit()
+                 || t_command.at(i) == '.'))
+      {
+        i++;
+      }
+    }
+    else if (c.isLetter())
+    {
+      while (i < t_command.size()
+             && t_command.at(i).isLetter())
+      {
+        i++;
+      }
+    }
+    else if (c == '+'
+             || c == '-')
+    {
+      i++;
+      if (i < t_command.size()
+          && t_command.at(i) == '%')
+      {
+        i++;
+      }
+    }
+    else if (c == '@'
+             || c == '%')
+    {
+      i++;
+    }
+    else
+    {
+      return false;
+    }
+    t_L_token.append(t_command.mid(start,
+                                   i - start).toLower());
+  }
+  return true;
+}
+
 Interpreter::Interpreter(QObject *parent)
     : QObject{parent}
 {}
 
+bool Interpreter::parseCommand(const QString &t_command,
+                               QList<KeypadButton> &t_L_button)
+{
+  QStringList L_token;
+  if (!tokenizeCommand(t_command,
+                       L_token))
+  {
+    qWarning() << "can't Interpreter::parseCommand" << t_command;
+    return false;
+  }
+
+  // infix text, postfix keypad : "1 thru 48" is 1 Channel 4 8 Thru
+  auto pendingButton = KeypadButton::UnknownButton;
+  // "fan 0 255" is 0 Fan 2 5 5 Fan
+  auto openFanButton = KeypadButton::UnknownButton;
+  for (qsizetype i = 0;
+       i < L_token.size();
+       i++)
+  {
+    const auto &token = L_token.at(i);
+    if (token.at(0).isDigit()
+        || token.at(0) == '.')
+    {
+      auto button = pendingButton;
+      if (button == KeypadButton::UnknownButton
+          && openFanButton != KeypadButton::UnknownButton)
+      {
+        button = openFanButton;
+      }
+      if (button == KeypadButton::UnknownButton)
+      {
+        if (i > 0)
+        {
+          qWarning() << "can't Interpreter::parseCommand, no key for"
+                     << token;
+          return false;
+        }
+        button = KeypadButton::Channel;
+      }
+      for (const auto &item
+           : token)
+      {
+        t_L_button.append(item == '.' ?
+                              KeypadButton::Dot
+                            : static_cast<KeypadButton>(item.digitValue()));
+      }
+      if (i + 1 < L_token.size()
+          && L_token.at(i + 1) == "%")
+      {
+        if (button != KeypadButton::ArobaseDmx)
+        {
+          qWarning() << "can't Interpreter::parseCommand, % without @";
+          return false;
+        }
+        button = KeypadButton::ArobasePercent;
+        i++;
+      }
+      t_L_button.append(button);
+      pendingButton = KeypadButton::UnknownButton;
+      if (button == KeypadButton::Fan
+          || button == KeypadButton::Vfan)
+      {
+        openFanButton = openFanButton == KeypadButton::UnknownButton ?
+                            button
+                          : KeypadButton::UnknownButton;
+      }
+      continue;
+    }
+
+    if (openFanButton != KeypadButton::UnknownButton)
+    {
+      qWarning() << "can't Interpreter::parseCommand, fan needs two levels";
+      return false;
+    }
+
+    auto button = KeypadButton::UnknownButton;
+    for (const auto &item
+         : commandKeywords)
+    {
+      if (token == QLatin1String(item.m_name))
+      {
+        button = item.m_button;
+        break;
+      }
+    }
+    if (button == KeypadButton::UnknownButton)
+    {
+      qWarning() << "can't Interpreter::parseCommand, unknown" << token;
+      return false;
+    }
+    // goto alone is the selected cue or step
+    if (pendingButton == KeypadButton::Goto)
+    {
+      t_L_button.append(pendingButton);
+    }
+    else if (pendingButton != KeypadButton::UnknownButton)
+    {
+      qWarning() << "can't Interpreter::parseCommand, no value for"
+                 << L_token.at(i - 1);
+      return false;
+    }
+    pendingButton = KeypadButton::UnknownButton;
+    if (isValuedButton(button)
+        || button == KeypadButton::Goto)
+    {
+      pendingButton = button;
+    }
+    else
+    {
+      t_L_button.append(button);
+    }
+  }
+  if (pendingButton == KeypadButton::Goto)
+  {
+    t_L_button.append(pendingButton);
+  }
+  else if (pendingButton != KeypadButton::UnknownButton
+           || openFanButton != KeypadButton::UnknownButton)
+  {
+    qWarning() << "can't Interpreter::parseCommand, no value at end of"
+               << t_command;
+    return false;
+  }
+  return true;
+}
+
+bool Interpreter::recieveCommand(const QString &t_command)
+{
+  QList<KeypadButton> L_button;
+  if (!parseCommand(t_command,
+                    L_button))
+  {
+    emit sendError();
+    return false;
+  }
+  // digits typed on the keypad before don't belong to it
+  clearValue();
+  clearFan();
+  for (const auto &item
+       : std::as_const(L_button))
+  {
+    recieveData(item);
+  }
+  return true;
+}
+
+int Interpreter::runScript(const QString &t_script)
+{
+  // every command one after the other, UnknownButton between them
+  QList<KeypadButton> L_button;
+  int commandCount = 0;
+  const auto L_line = t_script.split('\n');
+  for (qsizetype i = 0;
+       i < L_line.size();
+       i++)
+  {
+    auto line = L_line.at(i);
+    auto commentIndex = line.indexOf('#');
+    if (commentIndex > -1)
+      line.truncate(commentIndex);
+    const auto L_command = line.split(';');
+    for (const auto &item
+         : L_command)
+    {
+      if (item.trimmed().isEmpty())
+        continue;
+      if (!parseCommand(item,
+                        L_button))
+      {
+        qWarning() << "can't Interpreter::runScript, line" << i + 1;
+        emit sendError();
+        return -1;
+      }
+      L_button.append(KeypadButton::UnknownButton);
+      commandCount++;
+    }
+  }
+
+  emit batchStarted();
+  clearValue();
+  clearFan();
+  for (const auto &item
+       : std::as_const(L_button))
+  {
+    if (item == KeypadButton::UnknownButton)
+    {
+      clearValue();
+      clearFan();
+    }
+    else
+      recieveData(item);
+  }
+  emit batchFinished();
+  return commandCount;
+}
+
 void Interpreter::recieveData(KeypadButton t_button)
 {
   if (t_button == KeypadButton::All)
@@ -40,6 +337,7 @@ void Interpreter::recieveData(KeypadButton t_button)
     clearValue();
     m_lastSelectedChannelId = NO_ID;
     m_lastSelectedOutputUidId = NULL_UID_ID;
+    clearFan();
     emit clearChannelSelection();
     emit clearOutputSelection();
     return;
@@ -128,19 +426,10 @@ void Interpreter::recieveData(KeypadButton t_button)
       id lastSelectedChannelId = m_lastSelectedChannelId;
       if (calculateChannelId())
       {
-        int decay = m_lastSelectedChannelId - lastSelectedChannelId;
-        if (decay > 0)
-          for (id i = lastSelectedChannelId;
-               i <= m_lastSelectedChannelId;
-               i++)
-            L_channelsToSelect.append(i);
-        else if (decay < 0 )
-          for (id i = lastSelectedChannelId;
-               i <= m_lastSelectedChannelId;
-               i--)
-            L_channelsToSelect.append(i);
         resetInterpreter();
-        emit addChannelSelection(L_channelsToSelect);
+        // up or down, one range
+        emit addChannelRangeSelection(lastSelectedChannelId,
+                                      m_lastSelectedChannelId);
       }
     }
     else if (!(m_lastSelectedOutputUidId == NULL_UID_ID))
@@ -151,22 +440,9 @@ void Interpreter::recieveData(KeypadButton t_button)
         if (lastSelectedOutputUidId.getUniverseID()
             == m_lastSelectedOutputUidId.getUniverseID())
         {
-          int decay = lastSelectedOutputUidId.getOutputID()
-                      - m_lastSelectedOutputUidId.getOutputID();
-          if (decay > 0)
-            for (id i = lastSelectedOutputUidId.getOutputID();
-                 i <= m_lastSelectedOutputUidId.getOutputID();
-                 i++)
-              L_outputsToSelect.append(Uid_Id(lastSelectedOutputUidId.getUniverseID()
-                                              , i));
-          else if (decay < 0 )
-            for (id i = lastSelectedOutputUidId.getOutputID();
-                 i <= m_lastSelectedOutputUidId.getOutputID();
-                 i--)
-              L_outputsToSelect.append(Uid_Id(lastSelectedOutputUidId.getUniverseID()
-                                              , i));
           resetInterpreter();
-          emit addOutputSelection(L_outputsToSelect);
+          emit addOutputRangeSelection(lastSelectedOutputUidId,
+                                       m_lastSelectedOutputUidId);
         }
     }
     break;
@@ -218,6 +494,26 @@ void Interpreter::recieveData(KeypadButton t_button)
     emit setLevel(percentToDmx(calculatePercent()));
     resetInterpreter();
     break;
+  case KeypadButton::Scale :
+    // percent of actual levels, over 100 brightens
+    emit scaleLevel(calculateScalePercent());
+    resetInterpreter();
+    break;
+  case KeypadButton::Fan :
+  case KeypadButton::Vfan :
+    if (m_fanFirstLevel == NO_FAN_LEVEL)
+    {
+      m_fanFirstLevel = calculateDmx();
+      return;
+    }
+    emit fanLevel(m_fanFirstLevel,
+                  calculateDmx(),
+                  t_button == KeypadButton::Vfan ?
+                      FanMode::SymmetricFan
+                    : FanMode::LinearFan);
+    clearFan();
+    resetInterpreter();
+    break;
   case KeypadButton::Time :
     if (calculateFloatTime())
     {
@@ -312,7 +608,6 @@ bool Interpreter::calculateChannelId()
     m_lastSelectedChannelId += digit * qPow(10, i);
   }
   m_lastSelectedChannelId--; // human - machine translation
-  qDebug() << m_lastSelectedChannelId;
   clearValue();
   return true;
 }
@@ -506,6 +801,32 @@ percent Interpreter::calculatePercent()
              100 :  level;
 }
 
+int Interpreter::calculateScalePercent()
+{
+  if (!m_isValued)
+  {
+    emit sendError_NoValueSpecified();
+    return 100;
+  }
+
+  int level = 0;
+
+  // find first dot
+  auto i = m_L_digits.indexOf(KeypadButton::Dot);
+  if (i > -1)
+    m_L_digits.remove(i, m_L_digits.size() - i);
+
+  // clamped on the way, a long number can't overflow
+  for (const auto &item
+       : std::as_const(m_L_digits))
+  {
+    level = qMin(level * 10 + item,
+                 SCALE_PERCENT_MAX);
+  }
+  clearValue();
+  return level;
+}
+
 bool Interpreter::calculateFloatTime()
 {
   if (!m_isValued)
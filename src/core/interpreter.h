@@ -35,6 +35,14 @@ public :
 
   void recieveData(KeypadButton t_button);
 
+  // text command line, one command to keypad buttons :
+  // "1 thru 48 @ 75", "2 + 5 @ 50%", "group 3 record",
+  // "cue 12.5 time 3", "goto 20", "scale 80", "fan 0 255".
+  // A leading number is a channel, every keyword takes the number
+  // after it, fan and vfan take two. False on syntax error
+  static bool parseCommand(const QString &t_command,
+                           QList<KeypadButton> &t_L_button);
+
 private :
 
   void clearValue();
@@ -44,10 +52,13 @@ private :
   bool calculateCueId();
   dmx calculateDmx();
   percent calculatePercent();
+  // scale, 0 to SCALE_PERCENT_MAX
+  int calculateScalePercent();
   bool calculateFloatTime();
   bool calculateStepId();
   void clearCue() { m_selectedCueId = 0.0f; }
   void clearGroup() { m_selectedGroupId = NO_ID; }
+  void clearFan(){ m_fanFirstLevel = NO_FAN_LEVEL; }
   void resetInterpreter()
   { clearValue(); clearGroup(); clearCue(); }
 
@@ -57,8 +68,13 @@ private :
 signals :
 
   void addChannelSelection(QList<id> t_L_id);
+  // thru, t_first and t_last included, in any order
+  void addChannelRangeSelection(id t_first,
+                                id t_last);
   void removeChannelSelection(QList<id> t_L_id);
   void addOutputSelection(QList<Uid_Id> t_L_Uid_Id);
+  void addOutputRangeSelection(Uid_Id t_first,
+                               Uid_Id t_last);
   void removeOutputSelection(QList<Uid_Id> t_L_Uid_Id);
   void selectAll();
   void clearChannelSelection();
@@ -70,6 +86,10 @@ signals :
   void setDelayIn(time_f t_time);
   void setDelayOut(time_f t_time);
   void setLevel(dmx t_level);
+  void scaleLevel(int t_percent);
+  void fanLevel(dmx t_first,
+                dmx t_last,
+                FanMode t_mode);
   void recordNextCue();
   void recordNewCue(sceneID_f t_id);
   void updateCurrentCue();
@@ -82,9 +102,20 @@ signals :
   void deleteGroup(id t_id);
   void sendError();
   void sendError_NoValueSpecified();
+  // around a script, the engine coalesces channel updates
+  void batchStarted();
+  void batchFinished();
 
 public slots :
 
+  // one command, false on syntax error
+  bool recieveCommand(const QString &t_command);
+  // commands separated by new lines or ';', '#' to end of line is a
+  // comment. Every line is parsed before anything runs, then they run
+  // as one batch : channels are updated once at the end.
+  // Command count, -1 on syntax error
+  int runScript(const QString &t_script);
+
   void setLastSelectedChannelId(id t_lastSelectedChannelId)
   { m_lastSelectedChannelId = t_lastSelectedChannelId; }
 
@@ -101,5 +132,6 @@ private :
   sceneID_f m_selectedCueId = 0.0f;
   id m_stepId = NO_ID;
   time_f m_time = 0.0f;
+  int m_fanFirstLevel = NO_FAN_LEVEL; // first of the two fan levels
 };
 #endif // INTERPRETER_H
@@ -0,0 +1,176 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "latencystats.h"
+#include <QtAlgorithms>
+#include <QTextStream>
+
+/***************************** LatencyHistogram **************************/
+
+qint64 LatencyHistogram::getAverage() const
+{
+  auto count = getCount();
+  return count ? m_total.load(std::memory_order_relaxed) / static_cast<qint64>(count)
+               : 0;
+}
+
+qint64 LatencyHistogram::getPercentile(qreal t_percent) const
+{
+  auto count = getCount();
+  if (!count)
+    return 0;
+  auto rank = static_cast<quint64>(count * t_percent / 100.0);
+  quint64 total = 0;
+  for (int i = 0;
+       i < LATENCY_BUCKET_COUNT;
+       i++)
+  {
+    total += m_L_bucket[i].load(std::memory_order_relaxed);
+    if (total > rank)
+      return getBucketLowerBound(i);
+  }
+  return getMax();
+}
+
+void LatencyHistogram::addSample(qint64 t_latency)
+{
+  if (t_latency < 0)
+    t_latency = 0;
+  m_L_bucket[getBucket(t_latency)].fetch_add(1,
+                                             std::memory_order_relaxed);
+  m_count.fetch_add(1,
+                    std::memory_order_relaxed);
+  m_total.fetch_add(t_latency,
+                    std::memory_order_relaxed);
+  auto max = m_max.load(std::memory_order_relaxed);
+  while (t_latency > max
+         && !m_max.compare_exchange_weak(max,
+                                         t_latency,
+                                         std::memory_order_relaxed))
+  {}
+}
+
+void LatencyHistogram::reset()
+{
+  for (auto &item
+       : m_L_bucket)
+  {
+    item.store(0,
+               std::memory_order_relaxed);
+  }
+  m_count.store(0,
+                std::memory_order_relaxed);
+  m_total.store(0,
+                std::memory_order_relaxed);
+  m_max.store(0,
+              std::memory_order_relaxed);
+}
+
+int LatencyHistogram::getBucket(qint64 t_latency)
+{
+  if (t_latency < LATENCY_SUB_BUCKET_COUNT)
+    return static_cast<int>(t_latency);
+  // power of 2, then the 2 bits under it
+  int power = 63 - qCountLeadingZeroBits(static_cast<quint64>(t_latency));
+  int sub = static_cast<int>(t_latency >> (power - 2)) & (LATENCY_SUB_BUCKET_COUNT - 1);
+  int bucket = (power - 1) * LATENCY_SUB_BUCKET_COUNT + sub;
+  return qMin(bucket,
+              LATENCY_BUCKET_COUNT - 1);
+}
+
+qint64 LatencyHistogram::getBucketLowerBound(int t_bucket)
+{
+  if (t_bucket < LATENCY_SUB_BUCKET_COUNT)
+    return t_bucket;
+  int power = t_bucket / LATENCY_SUB_BUCKET_COUNT + 1;
+  int sub = t_bucket % LATENCY_SUB_BUCKET_COUNT;
+  return static_cast<qint64>(LATENCY_SUB_BUCKET_COUNT + sub) << (power - 2);
+}
+
+/******************************* LatencyStats ****************************/
+
+LatencyStats::LatencyStats()
+{
+  m_clock.start();
+}
+
+LatencyStats *LatencyStats::instance()
+{
+  static LatencyStats inst;
+  return &inst;
+}
+
+void LatencyStats::armInput(qint64 t_inputTime)
+{
+  qint64 none = 0;
+  m_armedInputTime.compare_exchange_strong(none,
+                                           t_inputTime,
+                                           std::memory_order_relaxed);
+}
+
+void LatencyStats::reset()
+{
+  for (auto &item
+       : m_histogram)
+  {
+    item.reset();
+  }
+}
+
+QString LatencyStats::dump() const
+{
+  QString text;
+  QTextStream stream(&text);
+  stream << "stage count p50 p90 p99 max average (µs)\n";
+  for (int i = 0;
+       i < UnknownLatencyStage;
+       i++)
+  {
+    stream << getHistogramLine(getStageName(static_cast<LatencyStage>(i)),
+                               m_histogram[i]);
+  }
+  return text;
+}
+
+QString LatencyStats::getHistogramLine(const QString &t_name,
+                                       const LatencyHistogram &t_histogram)
+{
+  QString text;
+  QTextStream stream(&text);
+  stream << t_name
+         << " " << t_histogram.getCount()
+         << " " << t_histogram.getPercentile(50) / 1000
+         << " " << t_histogram.getPercentile(90) / 1000
+         << " " << t_histogram.getPercentile(99) / 1000
+         << " " << t_histogram.getMax() / 1000
+         << " " << t_histogram.getAverage() / 1000
+         << "\n";
+  return text;
+}
+
+QString LatencyStats::getStageName(LatencyStage t_stage)
+{
+  switch (t_stage)
+  {
+  case EngineLatencyStage : return QString("engine");
+  case InterpreterLatencyStage : return QString("interpreter");
+  case MergeLatencyStage : return QString("merge");
+  case FrameLatencyStage : return QString("frame");
+  case SendLatencyStage : return QString("send");
+  default : return QString("unknown");
+  }
+}
@@ -0,0 +1,115 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <QString>
+#include <QElapsedTimer>
+#include <atomic>
+#include "../qontrejour.h"
+
+/***************************** LatencyHistogram **************************/
+
+// ns samples in LATENCY_SUB_BUCKET_COUNT buckets per power of 2,
+// ~20 % precision. Any thread adds samples, no lock, no allocation.
+// Readers see counts which may be a few samples apart.
+class LatencyHistogram
+{
+
+public :
+
+  LatencyHistogram(){}
+
+  ~LatencyHistogram(){}
+
+  quint64 getCount() const{ return m_count.load(std::memory_order_relaxed); }
+  qint64 getMax() const{ return m_max.load(std::memory_order_relaxed); }
+  qint64 getAverage() const;
+  // ns, lower bound of the bucket reaching t_percent of samples
+  qint64 getPercentile(qreal t_percent) const;
+
+  void addSample(qint64 t_latency);
+  void reset();
+
+  static int getBucket(qint64 t_latency);
+  static qint64 getBucketLowerBound(int t_bucket);
+
+private :
+
+  std::atomic<quint64> m_L_bucket[LATENCY_BUCKET_COUNT]{};
+  std::atomic<quint64> m_count{0};
+  std::atomic<qint64> m_total{0};
+  std::atomic<qint64> m_max{0};
+
+};
+
+/******************************* LatencyStats ****************************/
+
+// one histogram per LatencyStage, shared by every thread.
+// The input time of the last applied input is armed, the next
+// frame buffer write takes it, then the output thread, so a frame
+// knows which input it carries.
+class LatencyStats
+{
+
+public :
+
+  static LatencyStats *instance();
+
+  ~LatencyStats(){}
+
+  // ns, same clock for every thread
+  qint64 now() const{ return m_clock.nsecsElapsed(); }
+  const LatencyHistogram &getHistogram(LatencyStage t_stage) const
+  { return m_histogram[t_stage]; }
+
+  // sample is now() - t_inputTime
+  void addSample(LatencyStage t_stage,
+                 qint64 t_inputTime)
+  { m_histogram[t_stage].addSample(now() - t_inputTime); }
+
+  // keeps the oldest armed input until taken
+  void armInput(qint64 t_inputTime);
+  bool isInputArmed() const
+  { return m_armedInputTime.load(std::memory_order_relaxed) != 0; }
+  // 0 if nothing armed
+  qint64 takeArmedInput()
+  { return m_armedInputTime.exchange(0, std::memory_order_relaxed); }
+
+  void reset();
+  // one line per stage, µs
+  QString dump() const;
+
+  static QString getStageName(LatencyStage t_stage);
+  // name count p50 p90 p99 max average, µs
+  static QString getHistogramLine(const QString &t_name,
+                                  const LatencyHistogram &t_histogram);
+
+private :
+
+  LatencyStats();
+
+private :
+
+  QElapsedTimer m_clock;
+  LatencyHistogram m_histogram[UnknownLatencyStage];
+  std::atomic<qint64> m_armedInputTime{0};
+
+};
+
+#endif // LATENCYSTATS_H
@@ -0,0 +1,71 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LEVELKERNEL_H
+#define LEVELKERNEL_H
+
+#include "../qontrejour.h"
+
+/******************************* LevelKernel *****************************/
+
+// operations on a whole column of levels, one int per channel : the
+// level plus its overdmx offset. Loops have no branch, only min, max
+// and float math, so the compiler vectorizes them.
+// split() gives levels and offsets back. waveform() fills a column
+// for the effect engine.
+class LevelKernel
+{
+
+public :
+
+  // relative, keeps overdmx
+  static void add(int *t_level,
+                  qsizetype t_count,
+                  int t_delta);
+  static void fill(int *t_level,
+                   qsizetype t_count,
+                   int t_value);
+  // in percent of the level, overdmx dropped
+  static void scale(int *t_level,
+                    qsizetype t_count,
+                    int t_percent);
+  static void fan(int *t_level,
+                  qsizetype t_count,
+                  int t_first,
+                  int t_last,
+                  FanMode t_mode = FanMode::LinearFan);
+  // level between NULL_DMX and MAX_DMX, the rest in offset
+  static void split(const int *t_level,
+                    qsizetype t_count,
+                    dmx *t_dmx,
+                    overdmx *t_offset);
+
+  // effect waveform, 0 to t_size. Channel i is at phase
+  // t_phase + t_phaseOffset[i], both in [0, 1). Random levels come
+  // from t_seed, channel index and cycle : same inputs, same levels
+  static void waveform(int *t_level,
+                       const float *t_phaseOffset,
+                       qsizetype t_count,
+                       float t_phase,
+                       quint32 t_cycle,
+                       EffectWaveform t_waveform,
+                       int t_size,
+                       quint32 t_seed = EFFECT_SEED_DEFAULT);
+
+};
+
+#endif // LEVELKERNEL_H
@@ -0,0 +1,284 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "midiinput.h"
+#include "dmxmanager.h"
+#include <QDebug>
+
+#ifdef QONTREJOUR_HAS_ALSA
+#include <alsa/asoundlib.h>
+#include <poll.h>
+#endif
+
+/****************************** MidiInputThread **************************/
+
+MidiInputThread::MidiInputThread(MidiEventQueue *t_queue,
+                                 const QElapsedTimer *t_clock,
+                                 QObject *parent)
+  : QThread(parent),
+    m_queue(t_queue),
+    m_clock(t_clock)
+{}
+
+MidiInputThread::~MidiInputThread()
+{
+  stop();
+}
+
+void MidiInputThread::stop()
+{
+  requestInterruption();
+  if (isRunning())
+    wait();
+}
+
+void MidiInputThread::run()
+{
+#ifdef QONTREJOUR_HAS_ALSA
+  snd_seq_t *seq = nullptr;
+  if (snd_seq_open(&seq,
+                   "default",
+                   SND_SEQ_OPEN_INPUT,
+                   SND_SEQ_NONBLOCK) < 0)
+  {
+    qWarning() << "can't MidiInputThread::run, no alsa sequencer";
+    return;
+  }
+  snd_seq_set_client_name(seq,
+                          MIDI_CLIENT_NAME);
+  auto port = snd_seq_create_simple_port(seq,
+                                         MIDI_PORT_NAME,
+                                         SND_SEQ_PORT_CAP_WRITE
+                                             | SND_SEQ_PORT_CAP_SUBS_WRITE,
+                                         SND_SEQ_PORT_TYPE_MIDI_GENERIC
+                                             | SND_SEQ_PORT_TYPE_APPLICATION);
+  if (port < 0)
+  {
+    qWarning() << "can't MidiInputThread::run, no alsa port";
+    snd_seq_close(seq);
+    return;
+  }
+  m_clientId.storeRelaxed(snd_seq_client_id(seq));
+  m_portId.storeRelaxed(port);
+
+  int fdCount = snd_seq_poll_descriptors_count(seq,
+                                               POLLIN);
+  QList<pollfd> L_fd(fdCount);
+  snd_seq_poll_descriptors(seq,
+                           L_fd.data(),
+                           fdCount,
+                           POLLIN);
+
+  while (!isInterruptionRequested())
+  {
+    // timeout only to see stop()
+    if (poll(L_fd.data(),
+             fdCount,
+             MIDI_POLL_TIMEOUT) <= 0)
+    {
+      continue;
+    }
+
+    for (;;)
+    {
+      snd_seq_event_t *alsaEvent = nullptr;
+      auto result = snd_seq_event_input(seq,
+                                        &alsaEvent);
+      if (result == -ENOSPC)
+        continue; // overrun, some events are lost, keep reading
+      if (result < 0
+          || !alsaEvent)
+      {
+        break;
+      }
+      MidiEvent event;
+      event.m_timestamp = m_clock->nsecsElapsed();
+      switch (alsaEvent->type)
+      {
+      case SND_SEQ_EVENT_CONTROLLER :
+        event.m_type = MidiControlChange;
+        event.m_channel = alsaEvent->data.control.channel & 0x0f;
+        event.m_number = alsaEvent->data.control.param & 0x7f;
+        event.m_value = alsaEvent->data.control.value & 0x7f;
+        break;
+      case SND_SEQ_EVENT_NOTEON :
+      case SND_SEQ_EVENT_NOTEOFF :
+        event.m_type = MidiNote;
+        event.m_channel = alsaEvent->data.note.channel & 0x0f;
+        event.m_number = alsaEvent->data.note.note & 0x7f;
+        event.m_value = alsaEvent->type == SND_SEQ_EVENT_NOTEON
+            ? alsaEvent->data.note.velocity & 0x7f
+            : 0;
+        break;
+      default :
+        continue;
+      }
+      if (!m_queue->push(event))
+        m_droppedCount.fetchAndAddRelaxed(1);
+    }
+  }
+
+  snd_seq_delete_simple_port(seq,
+                             port);
+  snd_seq_close(seq);
+  m_clientId.storeRelaxed(-1);
+  m_portId.storeRelaxed(-1);
+#else
+  qWarning() << "can't MidiInputThread::run, built without alsa";
+#endif
+}
+
+/********************************* MidiInput *****************************/
+
+MidiInput::MidiInput(DmxEngine *t_engine,
+                     QObject *parent)
+  : QObject(parent),
+    m_engine(t_engine),
+    m_inputThread(new MidiInputThread(&m_queue,
+                                      &m_clock,
+                                      this)),
+    m_L_mapping(UnknownMidiEvent * MIDI_CHANNEL_COUNT * MIDI_NUMBER_COUNT)
+{
+  m_clock.start();
+  setDefaultMapping();
+
+  connect(m_engine,
+          SIGNAL(tickStarted()),
+          this,
+          SLOT(onEngineTickStarted()));
+}
+
+MidiInput::~MidiInput()
+{
+  stop();
+}
+
+MidiMapping MidiInput::getMapping(MidiEventType t_type,
+                                  quint8 t_channel,
+                                  quint8 t_number) const
+{
+  if (t_type == UnknownMidiEvent)
+    return MidiMapping();
+  return m_L_mapping.at(getMappingIndex(t_type,
+                                        t_channel,
+                                        t_number));
+}
+
+void MidiInput::setMapping(MidiEventType t_type,
+                          quint8 t_channel,
+                          quint8 t_number,
+                          const MidiMapping &t_mapping)
+{
+  if (t_type == UnknownMidiEvent)
+  {
+    qWarning() << "can't MidiInput::setMapping";
+    return;
+  }
+  m_L_mapping[getMappingIndex(t_type,
+                              t_channel,
+                              t_number)] = t_mapping;
+}
+
+void MidiInput::clearMapping()
+{
+  m_L_mapping.fill(MidiMapping());
+}
+
+void MidiInput::setDefaultMapping()
+{
+  clearMapping();
+  MidiMapping mapping;
+  for (int i = 0;
+       i < MIDI_NUMBER_COUNT;
+       i++)
+  {
+    mapping.m_targetId = static_cast<id>(i);
+    mapping.m_targetType = MidiGroupTarget;
+    setMapping(MidiControlChange, 0, i, mapping);
+    mapping.m_targetType = MidiChannelTarget;
+    setMapping(MidiControlChange, 1, i, mapping);
+  }
+
+  const PlayBackButton L_playBackButton[] =
+  { GoButton, GoBackButton, PauseButton, SeqPlusButton, SeqMoinsButton };
+  mapping.m_targetType = MidiPlayBackTarget;
+  mapping.m_targetId = NO_ID;
+  for (int i = 0;
+       i < 5;
+       i++)
+  {
+    mapping.m_playBackButton = L_playBackButton[i];
+    setMapping(MidiNote, 0, i, mapping);
+  }
+}
+
+bool MidiInput::start()
+{
+#ifdef QONTREJOUR_HAS_ALSA
+  if (!m_inputThread->isRunning())
+    m_inputThread->start(QThread::HighPriority);
+  return true;
+#else
+  qWarning() << "can't MidiInput::start, built without alsa";
+  return false;
+#endif
+}
+
+void MidiInput::stop()
+{
+  m_inputThread->stop();
+}
+
+void MidiInput::onEngineTickStarted()
+{
+  auto now = m_clock.nsecsElapsed();
+  MidiEvent event;
+  while (m_queue.pop(event))
+  {
+    m_lastLatency = now - event.m_timestamp;
+    if (m_lastLatency > m_maxLatency)
+      m_maxLatency = m_lastLatency;
+    apply(event);
+  }
+}
+
+void MidiInput::apply(const MidiEvent &t_event)
+{
+  const auto &mapping = m_L_mapping.at(getMappingIndex(t_event.m_type,
+                                                       t_event.m_channel,
+                                                       t_event.m_number));
+  // 0 - 127 to 0 - 255
+  auto level = static_cast<dmx>((t_event.m_value * MAX_DMX + 63) / 127);
+
+  switch (mapping.m_targetType)
+  {
+  case MidiGroupTarget :
+    m_engine->requestGroupLevel(mapping.m_targetId,
+                                level);
+    break;
+  case MidiChannelTarget :
+    m_engine->requestChannelLevel(mapping.m_targetId,
+                                  level);
+    break;
+  case MidiPlayBackTarget :
+    if (t_event.m_value) // press only
+      MANAGER->playBackToEngine(mapping.m_playBackButton);
+    break;
+  default :
+    break;
+  }
+}
@@ -0,0 +1,160 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIDIINPUT_H
+#define MIDIINPUT_H
+
+#include <QObject>
+#include <QThread>
+#include <QList>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include "../qontrejour.h"
+#include "spscqueue.h"
+
+class DmxEngine;
+
+/******************************** MidiEvent ******************************/
+
+struct MidiEvent
+{
+  qint64 m_timestamp = 0; // ns, MidiInput clock
+  MidiEventType m_type = UnknownMidiEvent;
+  quint8 m_channel = 0; // 0 - 15
+  quint8 m_number = 0; // controller or note
+  quint8 m_value = 0; // value or velocity, 0 for note off
+};
+
+typedef SpscQueue<MidiEvent, MIDI_QUEUE_SIZE> MidiEventQueue;
+
+/******************************** MidiMapping ****************************/
+
+struct MidiMapping
+{
+  MidiTargetType m_targetType = NoMidiTarget;
+  id m_targetId = NO_ID; // group or channel id
+  PlayBackButton m_playBackButton = GoButton;
+};
+
+/****************************** MidiInputThread **************************/
+
+// alsa sequencer client with one writable port, which other
+// clients (or aconnect, or a virtual keyboard) connect to.
+// Only pushes events into the queue.
+class MidiInputThread
+    : public QThread
+{
+
+  Q_OBJECT
+
+public :
+
+  explicit MidiInputThread(MidiEventQueue *t_queue,
+                           const QElapsedTimer *t_clock,
+                           QObject *parent = nullptr);
+
+  ~MidiInputThread();
+
+  int getClientId() const{ return m_clientId.loadRelaxed(); }
+  int getPortId() const{ return m_portId.loadRelaxed(); }
+  int getDroppedCount() const{ return m_droppedCount.loadRelaxed(); }
+
+  void stop();
+
+protected :
+
+  void run() override;
+
+private :
+
+  MidiEventQueue *m_queue;
+  const QElapsedTimer *m_clock;
+
+  QAtomicInt m_clientId{-1};
+  QAtomicInt m_portId{-1};
+  QAtomicInt m_droppedCount{0}; // queue was full
+
+};
+
+/********************************* MidiInput *****************************/
+
+// maps cc and notes onto submasters, direct channels and playback.
+// Drained once per engine tick : levels go through the engine pending
+// tables, so a fader burst costs one merge per frame.
+class MidiInput
+    : public QObject
+{
+
+  Q_OBJECT
+
+public :
+
+  explicit MidiInput(DmxEngine *t_engine,
+                     QObject *parent = nullptr);
+
+  ~MidiInput();
+
+  MidiMapping getMapping(MidiEventType t_type,
+                         quint8 t_channel,
+                         quint8 t_number) const;
+  // ns, between event arrival and engine tick
+  qint64 getMaxLatency() const{ return m_maxLatency; }
+  qint64 getLastLatency() const{ return m_lastLatency; }
+  MidiInputThread *getInputThread() const{ return m_inputThread; }
+
+  void setMapping(MidiEventType t_type,
+                  quint8 t_channel,
+                  quint8 t_number,
+                  const MidiMapping &t_mapping);
+  void clearMapping();
+  // cc on midi channel 1 : submasters, cc on midi channel 2 : channels,
+  // notes 0 - 4 on midi channel 1 : go, back, pause, plus, moins
+  void setDefaultMapping();
+  void resetLatency(){ m_maxLatency = 0; }
+
+  bool start();
+  void stop();
+
+private slots :
+
+  void onEngineTickStarted();
+
+private :
+
+  int getMappingIndex(MidiEventType t_type,
+                      quint8 t_channel,
+                      quint8 t_number) const
+  { return (t_type * MIDI_CHANNEL_COUNT + (t_channel & 0x0f))
+        * MIDI_NUMBER_COUNT + (t_number & 0x7f); }
+  void apply(const MidiEvent &t_event);
+
+private :
+
+  DmxEngine *m_engine;
+  MidiInputThread *m_inputThread;
+  MidiEventQueue m_queue;
+  QElapsedTimer m_clock;
+
+  // type * channel * number, direct lookup
+  QList<MidiMapping> m_L_mapping;
+
+  qint64 m_maxLatency = 0;
+  qint64 m_lastLatency = 0;
+
+};
+
+#endif // MIDIINPUT_H
@@ -0,0 +1,115 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <QtGlobal>
+#include <atomic>
+
+/******************************** MpscQueue ******************************/
+
+// lock free ring between any number of producer threads and one
+// consumer thread. Each cell has a sequence number telling whether
+// it's free for the producer at that position or ready for the
+// consumer, so producers only race on the head.
+// T is copied in and out, keep it small and trivially copyable.
+template<typename T, int Capacity>
+class MpscQueue
+{
+
+  static_assert((Capacity & (Capacity - 1)) == 0,
+                "MpscQueue capacity must be a power of 2");
+
+public :
+
+  MpscQueue()
+  {
+    for (int i = 0;
+         i < Capacity;
+         i++)
+    {
+      m_L_cell[i].m_sequence.store(static_cast<quint64>(i),
+                                   std::memory_order_relaxed);
+    }
+  }
+
+  ~MpscQueue(){}
+
+  // any thread, false if full
+  bool push(const T &t_item)
+  {
+    auto head = m_head.load(std::memory_order_relaxed);
+    Cell *cell;
+    for (;;)
+    {
+      cell = &m_L_cell[head & (Capacity - 1)];
+      auto sequence = cell->m_sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<qint64>(sequence - head);
+      if (diff == 0)
+      {
+        // cell is free, take the position
+        if (m_head.compare_exchange_weak(head,
+                                         head + 1,
+                                         std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+      {
+        return false; // consumer didn't free it yet
+      }
+      else
+      {
+        head = m_head.load(std::memory_order_relaxed);
+      }
+    }
+    cell->m_item = t_item;
+    cell->m_sequence.store(head + 1,
+                           std::memory_order_release);
+    return true;
+  }
+
+  // consumer side, false if empty or next item still being written
+  bool pop(T &t_item)
+  {
+    auto cell = &m_L_cell[m_tail & (Capacity - 1)];
+    auto sequence = cell->m_sequence.load(std::memory_order_acquire);
+    if (static_cast<qint64>(sequence - (m_tail + 1)) < 0)
+      return false;
+    t_item = cell->m_item;
+    cell->m_sequence.store(m_tail + Capacity,
+                           std::memory_order_release);
+    m_tail++;
+    return true;
+  }
+
+private :
+
+  struct Cell
+  {
+    std::atomic<quint64> m_sequence;
+    T m_item;
+  };
+
+  // producers and consumer don't invalidate each other
+  alignas(64) std::atomic<quint64> m_head{0};
+  alignas(64) quint64 m_tail = 0; // consumer only
+  Cell m_L_cell[Capacity];
+
+};
+
+#endif // MPSCQUEUE_H
@@ -0,0 +1,505 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "networkinput.h"
+#include "networkoutput.h"
+#include <QUdpSocket>
+#include <QNetworkInterface>
+#include <QTimer>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+#include <algorithm>
+
+/***************************** DmxInputUniverse **************************/
+
+void DmxInputUniverse::write(const dmx *t_data,
+                             bool t_isActive)
+{
+  auto sequence = m_sequence.load(std::memory_order_relaxed);
+  m_sequence.store(sequence + 1,
+                   std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(m_data,
+              t_data,
+              UNIVERSE_OUTPUT_COUNT_DEFAULT);
+  m_isActive = t_isActive;
+  m_sequence.store(sequence + 2,
+                   std::memory_order_release);
+}
+
+bool DmxInputUniverse::read(dmx *t_data,
+                            bool &t_isActive,
+                            quint32 &t_sequence) const
+{
+  for (;;)
+  {
+    auto before = m_sequence.load(std::memory_order_acquire);
+    if (before == t_sequence)
+      return false;
+    if (before & 1)
+      continue; // writer is copying 512 bytes, won't be long
+    std::memcpy(t_data,
+                m_data,
+                UNIVERSE_OUTPUT_COUNT_DEFAULT);
+    bool isActive = m_isActive;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (m_sequence.load(std::memory_order_relaxed) == before)
+    {
+      t_isActive = isActive;
+      t_sequence = before;
+      return true;
+    }
+  }
+}
+
+/**************************** NetworkInputReceiver ***********************/
+
+NetworkInputReceiver::NetworkInputReceiver(QList<DmxInputUniverse *> t_L_universe,
+                                           bool t_isArtNet,
+                                           bool t_isSacn,
+                                           QObject *parent)
+  : QObject(parent),
+    m_L_universe(t_L_universe),
+    m_isArtNet(t_isArtNet),
+    m_isSacn(t_isSacn),
+    m_L_source(t_L_universe.size() * NETWORK_INPUT_SOURCE_MAX),
+    m_datagram(NETWORK_INPUT_DATAGRAM_SIZE_MAX, 0)
+{}
+
+NetworkInputReceiver::~NetworkInputReceiver()
+{
+  close();
+}
+
+bool NetworkInputReceiver::open()
+{
+  m_clock.start();
+
+  // loopback included, that's where --artnet 127.0.0.1 comes from
+  m_L_localAddress.clear();
+  const auto L_address = QNetworkInterface::allAddresses();
+  for (const auto &item : L_address)
+  {
+    if (item.protocol() == QAbstractSocket::IPv4Protocol)
+      m_L_localAddress.append(item.toIPv4Address());
+  }
+  auto cid = SacnOutputSink::getLocalCid().toRfc4122();
+  m_localCidHigh = qFromBigEndian<quint64>(cid.constData());
+  m_localCidLow = qFromBigEndian<quint64>(cid.constData() + 8);
+
+  if (m_isArtNet)
+  {
+    m_artNetSocket = new QUdpSocket(this);
+    if (!m_artNetSocket->bind(QHostAddress::AnyIPv4,
+                              ARTNET_PORT,
+                              QUdpSocket::ShareAddress
+                                  | QUdpSocket::ReuseAddressHint))
+    {
+      qWarning() << "can't NetworkInputReceiver::open Art-Net"
+                 << m_artNetSocket->errorString();
+      return false;
+    }
+    m_artNetSocket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption,
+                                    NETWORK_RECEIVE_BUFFER_SIZE);
+    connect(m_artNetSocket,
+            SIGNAL(readyRead()),
+            this,
+            SLOT(onArtNetReadyRead()));
+  }
+
+  if (m_isSacn)
+  {
+    m_sacnSocket = new QUdpSocket(this);
+    if (!m_sacnSocket->bind(QHostAddress::AnyIPv4,
+                            SACN_PORT,
+                            QUdpSocket::ShareAddress
+                                | QUdpSocket::ReuseAddressHint))
+    {
+      qWarning() << "can't NetworkInputReceiver::open sACN"
+                 << m_sacnSocket->errorString();
+      return false;
+    }
+    m_sacnSocket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption,
+                                  NETWORK_RECEIVE_BUFFER_SIZE);
+    // NOTE : linux allows 20 memberships per socket by default
+    // (net.ipv4.igmp_max_memberships), unicast sACN always works
+    for (qsizetype i = 0;
+         i < m_L_universe.size();
+         i++)
+    {
+      auto group = QHostAddress(0xefff0000u | static_cast<quint32>(i + 1));
+      if (!m_sacnSocket->joinMulticastGroup(group))
+      {
+        qWarning() << "can't join sACN multicast group" << group.toString();
+        break;
+      }
+    }
+    connect(m_sacnSocket,
+            SIGNAL(readyRead()),
+            this,
+            SLOT(onSacnReadyRead()));
+  }
+
+  m_timeoutTimer = new QTimer(this);
+  connect(m_timeoutTimer,
+          SIGNAL(timeout()),
+          this,
+          SLOT(onTimeoutCheck()));
+  m_timeoutTimer->start(NETWORK_INPUT_TIMEOUT_CHECK_INTERVAL);
+
+  return true;
+}
+
+void NetworkInputReceiver::close()
+{
+  if (m_timeoutTimer)
+    m_timeoutTimer->stop();
+  delete m_artNetSocket;
+  m_artNetSocket = nullptr;
+  delete m_sacnSocket;
+  m_sacnSocket = nullptr;
+
+  // every source is gone
+  for (auto &item : m_L_source)
+    item.m_lastTime = -1;
+  for (qsizetype i = 0;
+       i < m_L_universe.size();
+       i++)
+  {
+    merge(static_cast<uid>(i));
+  }
+}
+
+void NetworkInputReceiver::onArtNetReadyRead()
+{
+  while (m_artNetSocket->hasPendingDatagrams())
+  {
+    auto size = m_artNetSocket->readDatagram(m_datagram.data(),
+                                             m_datagram.size(),
+                                             &m_sender);
+    if (size < 0)
+      break;
+    parseArtNet(m_datagram.constData(),
+                size,
+                m_sender.toIPv4Address());
+  }
+}
+
+void NetworkInputReceiver::onSacnReadyRead()
+{
+  while (m_sacnSocket->hasPendingDatagrams())
+  {
+    auto size = m_sacnSocket->readDatagram(m_datagram.data(),
+                                           m_datagram.size());
+    if (size < 0)
+      break;
+    parseSacn(m_datagram.constData(),
+              size);
+  }
+}
+
+void NetworkInputReceiver::onTimeoutCheck()
+{
+  auto now = m_clock.elapsed();
+  for (qsizetype i = 0;
+       i < m_L_universe.size();
+       i++)
+  {
+    bool isChanged = false;
+    for (int j = 0;
+         j < NETWORK_INPUT_SOURCE_MAX;
+         j++)
+    {
+      auto source = getSource(i, j);
+      if (source->m_lastTime >= 0
+          && now - source->m_lastTime > NETWORK_INPUT_SOURCE_TIMEOUT)
+      {
+        source->m_lastTime = -1;
+        isChanged = true;
+      }
+    }
+    if (isChanged)
+      merge(static_cast<uid>(i));
+  }
+}
+
+void NetworkInputReceiver::parseArtNet(const char *t_data,
+                                       qint64 t_size,
+                                       quint32 t_sender)
+{
+  if (t_size < ARTNET_HEADER_SIZE
+      || std::memcmp(t_data, "Art-Net", 8) != 0
+      || qFromLittleEndian<quint16>(t_data + 8) != ARTNET_OPCODE_DMX)
+  {
+    return;
+  }
+  if (m_L_localAddress.contains(t_sender))
+    return; // our own broadcast
+  auto universe = qFromLittleEndian<quint16>(t_data + 14) & 0x7fff;
+  int length = qFromBigEndian<quint16>(t_data + 16);
+  if (length > t_size - ARTNET_HEADER_SIZE)
+    length = static_cast<int>(t_size - ARTNET_HEADER_SIZE);
+  receive(static_cast<uid>(universe),
+          0,
+          t_sender,
+          SACN_PRIORITY_DEFAULT,
+          -1,
+          reinterpret_cast<const dmx *>(t_data + ARTNET_HEADER_SIZE),
+          length);
+}
+
+void NetworkInputReceiver::parseSacn(const char *t_data,
+                                     qint64 t_size)
+{
+  if (t_size <= SACN_DMX_OFFSET
+      || std::memcmp(t_data + 4, "ASC-E1.17", 9) != 0
+      || qFromBigEndian<quint32>(t_data + 18) != 0x00000004 // root : data
+      || qFromBigEndian<quint32>(t_data + 40) != 0x00000002 // framing : dmp
+      || t_data[117] != 0x02 // dmp : set property
+      || t_data[125] != 0x00) // start code
+  {
+    return;
+  }
+  auto keyHigh = qFromBigEndian<quint64>(t_data + 22); // cid
+  auto keyLow = qFromBigEndian<quint64>(t_data + 30);
+  if (keyHigh == m_localCidHigh
+      && keyLow == m_localCidLow)
+  {
+    return; // our own multicast, looped back
+  }
+  auto priority = static_cast<quint8>(t_data[108]);
+  auto sequence = static_cast<quint8>(t_data[111]);
+  auto options = static_cast<quint8>(t_data[112]);
+  auto universe = qFromBigEndian<quint16>(t_data + 113);
+
+  if (universe < 1)
+    return;
+  auto inputUid = static_cast<uid>(universe - 1);
+
+  if (options & 0x80) // preview data, not for us
+    return;
+  if (options & 0x40) // stream terminated
+  {
+    release(inputUid,
+            keyHigh,
+            keyLow);
+    return;
+  }
+
+  // property value count includes start code
+  int length = qFromBigEndian<quint16>(t_data + 123) - 1;
+  if (length > t_size - SACN_DMX_OFFSET)
+    length = static_cast<int>(t_size - SACN_DMX_OFFSET);
+  if (priority > SACN_PRIORITY_MAX)
+    priority = SACN_PRIORITY_MAX;
+  receive(inputUid,
+          keyHigh,
+          keyLow,
+          priority,
+          sequence,
+          reinterpret_cast<const dmx *>(t_data + SACN_DMX_OFFSET),
+          length);
+}
+
+void NetworkInputReceiver::receive(uid t_uid,
+                                   quint64 t_keyHigh,
+                                   quint64 t_keyLow,
+                                   quint8 t_priority,
+                                   int t_sequence,
+                                   const dmx *t_data,
+                                   int t_size)
+{
+  if (t_uid < 0
+      || t_uid >= m_L_universe.size()
+      || t_size < 0)
+  {
+    return;
+  }
+  if (t_size > UNIVERSE_OUTPUT_COUNT_DEFAULT)
+    t_size = UNIVERSE_OUTPUT_COUNT_DEFAULT;
+
+  DmxInputSource *source = nullptr;
+  DmxInputSource *freeSource = nullptr;
+  for (int i = 0;
+       i < NETWORK_INPUT_SOURCE_MAX;
+       i++)
+  {
+    auto item = getSource(t_uid, i);
+    if (item->m_lastTime < 0)
+    {
+      if (!freeSource)
+        freeSource = item;
+    }
+    else if (item->m_keyHigh == t_keyHigh
+             && item->m_keyLow == t_keyLow)
+    {
+      source = item;
+      break;
+    }
+  }
+
+  if (source)
+  {
+    // drop late and duplicated packets
+    if (t_sequence >= 0)
+    {
+      auto diff = static_cast<qint8>(static_cast<quint8>(t_sequence)
+                                     - source->m_sequence);
+      if (diff <= 0
+          && diff > -SACN_SEQUENCE_REJECT_RANGE)
+      {
+        return;
+      }
+    }
+  }
+  else
+  {
+    if (!freeSource)
+      return; // too many sources on this universe
+    source = freeSource;
+    source->m_keyHigh = t_keyHigh;
+    source->m_keyLow = t_keyLow;
+  }
+
+  source->m_lastTime = m_clock.elapsed();
+  source->m_priority = t_priority;
+  if (t_sequence >= 0)
+    source->m_sequence = static_cast<quint8>(t_sequence);
+  std::memcpy(source->m_data,
+              t_data,
+              t_size);
+  std::memset(source->m_data + t_size,
+              NULL_DMX,
+              UNIVERSE_OUTPUT_COUNT_DEFAULT - t_size);
+
+  merge(t_uid);
+}
+
+void NetworkInputReceiver::release(uid t_uid,
+                                   quint64 t_keyHigh,
+                                   quint64 t_keyLow)
+{
+  if (t_uid < 0
+      || t_uid >= m_L_universe.size())
+  {
+    return;
+  }
+  for (int i = 0;
+       i < NETWORK_INPUT_SOURCE_MAX;
+       i++)
+  {
+    auto source = getSource(t_uid, i);
+    if (source->m_lastTime >= 0
+        && source->m_keyHigh == t_keyHigh
+        && source->m_keyLow == t_keyLow)
+    {
+      source->m_lastTime = -1;
+      merge(t_uid);
+      return;
+    }
+  }
+}
+
+void NetworkInputReceiver::merge(uid t_uid)
+{
+  int topPriority = -1;
+  for (int i = 0;
+       i < NETWORK_INPUT_SOURCE_MAX;
+       i++)
+  {
+    auto source = getSource(t_uid, i);
+    if (source->m_lastTime >= 0
+        && source->m_priority > topPriority)
+    {
+      topPriority = source->m_priority;
+    }
+  }
+
+  std::memset(m_mergeBuffer,
+              NULL_DMX,
+              UNIVERSE_OUTPUT_COUNT_DEFAULT);
+  for (int i = 0;
+       i < NETWORK_INPUT_SOURCE_MAX;
+       i++)
+  {
+    auto source = getSource(t_uid, i);
+    if (source->m_lastTime < 0
+        || source->m_priority != topPriority)
+    {
+      continue;
+    }
+    for (int j = 0;
+         j < UNIVERSE_OUTPUT_COUNT_DEFAULT;
+         j++)
+    {
+      m_mergeBuffer[j] = std::max(m_mergeBuffer[j],
+                                  source->m_data[j]);
+    }
+  }
+
+  m_L_universe.at(t_uid)->write(m_mergeBuffer,
+                                topPriority >= 0);
+}
+
+/***************************** NetworkInputThread ************************/
+
+NetworkInputThread::NetworkInputThread(int t_universeCount,
+                                       bool t_isArtNet,
+                                       bool t_isSacn,
+                                       QObject *parent)
+  : QThread(parent),
+    m_isArtNet(t_isArtNet),
+    m_isSacn(t_isSacn)
+{
+  for (int i = 0;
+       i < t_universeCount;
+       i++)
+  {
+    m_L_universe.append(new DmxInputUniverse());
+  }
+}
+
+NetworkInputThread::~NetworkInputThread()
+{
+  stop();
+  qDeleteAll(m_L_universe);
+  m_L_universe.clear();
+}
+
+void NetworkInputThread::stop()
+{
+  if (isRunning())
+  {
+    quit();
+    wait();
+  }
+}
+
+void NetworkInputThread::run()
+{
+  NetworkInputReceiver receiver(m_L_universe,
+                                m_isArtNet,
+                                m_isSacn);
+  if (!receiver.open())
+  {
+    qWarning() << "can't NetworkInputThread::run";
+    return;
+  }
+  exec();
+  receiver.close();
+}
@@ -0,0 +1,196 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NETWORKINPUT_H
+#define NETWORKINPUT_H
+
+#include <QObject>
+#include <QThread>
+#include <QList>
+#include <QHostAddress>
+#include <QElapsedTimer>
+#include <atomic>
+#include "../qontrejour.h"
+
+class QUdpSocket;
+class QTimer;
+
+/***************************** DmxInputUniverse **************************/
+
+// one received universe, after source merge.
+// Seqlock : one writer (input thread), readers never block it.
+class DmxInputUniverse
+{
+
+public :
+
+  DmxInputUniverse(){}
+
+  ~DmxInputUniverse(){}
+
+  // input thread side
+  void write(const dmx *t_data,
+             bool t_isActive);
+
+  // engine side. Return false if nothing was written since t_sequence,
+  // else copy universe and update t_sequence.
+  // t_data must hold UNIVERSE_OUTPUT_COUNT_DEFAULT values
+  bool read(dmx *t_data,
+            bool &t_isActive,
+            quint32 &t_sequence) const;
+
+private :
+
+  std::atomic<quint32> m_sequence{0}; // odd while writing
+  dmx m_data[UNIVERSE_OUTPUT_COUNT_DEFAULT] = {};
+  bool m_isActive = false;
+
+};
+
+/***************************** DmxInputSource ****************************/
+
+// a desk sending us one universe : ip for Art-Net, cid for sACN
+struct DmxInputSource
+{
+  quint64 m_keyHigh = 0;
+  quint64 m_keyLow = 0;
+  qint64 m_lastTime = -1; // ms, -1 : free slot
+  quint8 m_priority = SACN_PRIORITY_DEFAULT;
+  quint8 m_sequence = 0;
+  dmx m_data[UNIVERSE_OUTPUT_COUNT_DEFAULT] = {};
+};
+
+/**************************** NetworkInputReceiver ***********************/
+
+// lives in the input thread. Parse datagrams in place,
+// merge sources per universe, publish to DmxInputUniverse.
+// Our own output must never come back as input, it would be merged
+// htp and hold every level up : sACN carrying our cid and Art-Net sent
+// from one of our interface addresses are dropped. Another Art-Net
+// sender on this machine is dropped too, Art-Net has no source id.
+class NetworkInputReceiver
+    : public QObject
+{
+
+  Q_OBJECT
+
+public :
+
+  explicit NetworkInputReceiver(QList<DmxInputUniverse *> t_L_universe,
+                                bool t_isArtNet,
+                                bool t_isSacn,
+                                QObject *parent = nullptr);
+
+  ~NetworkInputReceiver();
+
+  bool open();
+  void close();
+
+private slots :
+
+  void onArtNetReadyRead();
+  void onSacnReadyRead();
+  void onTimeoutCheck();
+
+private :
+
+  void parseArtNet(const char *t_data,
+                   qint64 t_size,
+                   quint32 t_sender);
+  void parseSacn(const char *t_data,
+                 qint64 t_size);
+
+  // store data for source, then merge universe.
+  // t_sequence -1 : source is not sequenced
+  void receive(uid t_uid,
+               quint64 t_keyHigh,
+               quint64 t_keyLow,
+               quint8 t_priority,
+               int t_sequence,
+               const dmx *t_data,
+               int t_size);
+  void release(uid t_uid,
+               quint64 t_keyHigh,
+               quint64 t_keyLow);
+  // highest priority wins, htp between sources of same priority
+  void merge(uid t_uid);
+
+  DmxInputSource *getSource(uid t_uid,
+                            int t_index)
+  { return &m_L_source[t_uid * NETWORK_INPUT_SOURCE_MAX + t_index]; }
+
+private :
+
+  QList<DmxInputUniverse *> m_L_universe;
+  bool m_isArtNet;
+  bool m_isSacn;
+
+  QUdpSocket *m_artNetSocket = nullptr;
+  QUdpSocket *m_sacnSocket = nullptr;
+  QTimer *m_timeoutTimer = nullptr;
+  QElapsedTimer m_clock;
+
+  // preallocated, NETWORK_INPUT_SOURCE_MAX per universe
+  QList<DmxInputSource> m_L_source;
+  // our own traffic, filled on open
+  QList<quint32> m_L_localAddress;
+  quint64 m_localCidHigh = 0;
+  quint64 m_localCidLow = 0;
+  // receive and merge buffers, never reallocated
+  QByteArray m_datagram;
+  QHostAddress m_sender;
+  dmx m_mergeBuffer[UNIVERSE_OUTPUT_COUNT_DEFAULT] = {};
+
+};
+
+/***************************** NetworkInputThread ************************/
+
+class NetworkInputThread
+    : public QThread
+{
+
+  Q_OBJECT
+
+public :
+
+  // universe 0 is Art-Net universe 0 and sACN universe 1
+  explicit NetworkInputThread(int t_universeCount,
+                              bool t_isArtNet = true,
+                              bool t_isSacn = true,
+                              QObject *parent = nullptr);
+
+  ~NetworkInputThread();
+
+  int getUniverseCount() const{ return m_L_universe.size(); }
+  const DmxInputUniverse *getUniverse(uid t_uid) const
+  { return m_L_universe.at(t_uid); }
+
+  void stop();
+
+protected :
+
+  void run() override;
+
+private :
+
+  QList<DmxInputUniverse *> m_L_universe;
+  bool m_isArtNet;
+  bool m_isSacn;
+
+};
+
+#endif // NETWORKINPUT_H
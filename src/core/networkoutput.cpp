@@ -0,0 +1,449 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "networkoutput.h"
+#include <QUdpSocket>
+#include <QMutexLocker>
+#include <QDebug>
+#include <QtEndian>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <arpa/inet.h>
+#include <cerrno>
+#endif
+
+/*************************** UdpDatagramBatch ****************************/
+
+void UdpDatagramBatch::append(const char *t_data,
+                              int t_size,
+                              const QHostAddress &t_address,
+                              quint16 t_port)
+{
+#ifdef Q_OS_LINUX
+  if (m_count == m_L_message.size())
+  {
+    auto newSize = m_L_message.size() ? m_L_message.size() * 2 : 64;
+    m_L_message.resize(newSize);
+    m_L_iovec.resize(newSize);
+    m_L_address.resize(newSize);
+  }
+  auto &iov = m_L_iovec[m_count];
+  iov.iov_base = const_cast<char *>(t_data);
+  iov.iov_len = static_cast<size_t>(t_size);
+
+  auto &address = m_L_address[m_count];
+  std::memset(&address, 0, sizeof(sockaddr_in));
+  address.sin_family = AF_INET;
+  address.sin_port = htons(t_port);
+  address.sin_addr.s_addr = htonl(t_address.toIPv4Address());
+#else
+  if (m_count == m_L_data.size())
+  {
+    m_L_data.append(t_data);
+    m_L_size.append(t_size);
+    m_L_address.append(t_address);
+    m_L_port.append(t_port);
+  }
+  else
+  {
+    m_L_data[m_count] = t_data;
+    m_L_size[m_count] = t_size;
+    m_L_address[m_count] = t_address;
+    m_L_port[m_count] = t_port;
+  }
+#endif
+  m_count++;
+}
+
+void UdpDatagramBatch::flush(QUdpSocket *t_socket)
+{
+  if (!m_count)
+    return;
+  if (!t_socket)
+  {
+    m_count = 0;
+    return;
+  }
+
+#ifdef Q_OS_LINUX
+  // pointers are set now, lists may have moved while growing
+  for (int i = 0;
+       i < m_count;
+       i++)
+  {
+    auto &message = m_L_message[i];
+    std::memset(&message, 0, sizeof(mmsghdr));
+    message.msg_hdr.msg_name = &m_L_address[i];
+    message.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+    message.msg_hdr.msg_iov = &m_L_iovec[i];
+    message.msg_hdr.msg_iovlen = 1;
+  }
+
+  auto fd = static_cast<int>(t_socket->socketDescriptor());
+  int sent = 0;
+  while (sent < m_count)
+  {
+    int result = ::sendmmsg(fd,
+                            m_L_message.data() + sent,
+                            static_cast<unsigned int>(m_count - sent),
+                            0);
+    if (result < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      // socket buffer is full or network is down,
+      // what's left will go with next frame or keep alive
+      break;
+    }
+    sent += result;
+  }
+#else
+  for (int i = 0;
+       i < m_count;
+       i++)
+  {
+    t_socket->writeDatagram(m_L_data.at(i),
+                            m_L_size.at(i),
+                            m_L_address.at(i),
+                            m_L_port.at(i));
+  }
+#endif
+  m_count = 0;
+}
+
+/*************************** NetworkOutputSink ***************************/
+
+NetworkOutputSink::NetworkOutputSink(quint16 t_port)
+  : DmxOutputSink(),
+    m_port(t_port)
+{}
+
+NetworkOutputSink::~NetworkOutputSink()
+{
+  NetworkOutputSink::close();
+}
+
+QList<QHostAddress> NetworkOutputSink::getL_node(uid t_uid) const
+{
+  QMutexLocker locker(&m_settingMutex);
+  return m_H_unicastNode.value(t_uid);
+}
+
+void NetworkOutputSink::addNode(uid t_uid,
+                                const QHostAddress &t_node)
+{
+  if (t_uid < 0
+      || t_node.protocol() != QAbstractSocket::IPv4Protocol)
+  {
+    qWarning() << "can't NetworkOutputSink::addNode";
+    return;
+  }
+  QMutexLocker locker(&m_settingMutex);
+  auto &L_node = m_H_unicastNode[t_uid];
+  if (!L_node.contains(t_node))
+    L_node.append(t_node);
+}
+
+void NetworkOutputSink::removeNode(uid t_uid,
+                                   const QHostAddress &t_node)
+{
+  QMutexLocker locker(&m_settingMutex);
+  auto i = m_H_unicastNode.find(t_uid);
+  if (i == m_H_unicastNode.end())
+  {
+    qWarning() << "can't NetworkOutputSink::removeNode";
+    return;
+  }
+  i->removeAll(t_node);
+  if (i->isEmpty())
+    m_H_unicastNode.erase(i);
+}
+
+void NetworkOutputSink::clearNodes(uid t_uid)
+{
+  QMutexLocker locker(&m_settingMutex);
+  m_H_unicastNode.remove(t_uid);
+}
+
+bool NetworkOutputSink::open()
+{
+  if (m_socket)
+    return true;
+
+  m_socket = new QUdpSocket();
+  if (!m_socket->bind(QHostAddress::AnyIPv4, 0))
+  {
+    qWarning() << "can't open" << getName()
+               << m_socket->errorString();
+    delete m_socket;
+    m_socket = nullptr;
+    return false;
+  }
+  // hundreds of universes go out in one burst
+  m_socket->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption,
+                            NETWORK_SEND_BUFFER_SIZE);
+  return true;
+}
+
+void NetworkOutputSink::close()
+{
+  if (!m_socket)
+    return;
+  delete m_socket;
+  m_socket = nullptr;
+}
+
+void NetworkOutputSink::sendFrames(const QList<QByteArray> &t_L_frame,
+                                   const QList<bool> &t_L_isToSend)
+{
+  if (!m_socket)
+    return;
+
+  // prepare packet templates for new universes
+  while (m_L_packet.size() < t_L_frame.size())
+  {
+    uid universe = m_L_packet.size();
+    m_L_packet.append(createPacketTemplate(universe));
+    m_L_defaultAddress.append(getDefaultAddress(universe));
+  }
+
+  QMutexLocker locker(&m_settingMutex);
+  for (qsizetype i = 0;
+       i < t_L_frame.size();
+       i++)
+  {
+    if (!t_L_isToSend.at(i))
+      continue;
+    encodePacket(i,
+                 t_L_frame.at(i),
+                 m_L_packet[i]);
+    sendPacket(i);
+  }
+  locker.unlock();
+
+  flush();
+}
+
+void NetworkOutputSink::sendPacket(uid t_uid)
+{
+  const auto &packet = m_L_packet.at(t_uid);
+  auto node = m_H_unicastNode.constFind(t_uid);
+  if (node == m_H_unicastNode.cend())
+  {
+    m_batch.append(packet.constData(),
+                   packet.size(),
+                   m_L_defaultAddress.at(t_uid),
+                   m_port);
+    return;
+  }
+  for (const auto &address
+       : std::as_const(*node))
+  {
+    m_batch.append(packet.constData(),
+                   packet.size(),
+                   address,
+                   m_port);
+  }
+}
+
+/****************************** ArtNetOutputSink *************************/
+
+ArtNetOutputSink::ArtNetOutputSink(const QHostAddress &t_broadcastAddress)
+  : NetworkOutputSink(ARTNET_PORT),
+    m_broadcastAddress(t_broadcastAddress)
+{}
+
+QByteArray ArtNetOutputSink::createPacketTemplate(uid t_uid)
+{
+  QByteArray packet(ARTNET_HEADER_SIZE + UNIVERSE_OUTPUT_COUNT_DEFAULT,
+                    0);
+  auto data = packet.data();
+  std::memcpy(data, "Art-Net", 8); // with \0
+  data[8] = ARTNET_OPCODE_DMX & 0xff; // little endian
+  data[9] = ARTNET_OPCODE_DMX >> 8;
+  data[10] = 0; // protocol version, big endian
+  data[11] = ARTNET_PROTOCOL_VERSION;
+  data[12] = 0; // sequence
+  data[13] = 0; // physical
+  data[14] = t_uid & 0xff; // subnet + universe
+  data[15] = (t_uid >> 8) & 0x7f; // net
+  data[16] = UNIVERSE_OUTPUT_COUNT_DEFAULT >> 8; // length, big endian
+  data[17] = UNIVERSE_OUTPUT_COUNT_DEFAULT & 0xff;
+  m_L_sequence.append(0);
+  return packet;
+}
+
+void ArtNetOutputSink::encodePacket(uid t_uid,
+                                    const QByteArray &t_frame,
+                                    QByteArray &t_packet)
+{
+  auto data = t_packet.data();
+
+  // sequence goes 1 to 255, 0 disables it
+  quint8 sequence = m_L_sequence.at(t_uid) + 1;
+  if (!sequence) sequence = 1;
+  m_L_sequence[t_uid] = sequence;
+  data[12] = static_cast<char>(sequence);
+
+  std::memcpy(data + ARTNET_HEADER_SIZE,
+              t_frame.constData(),
+              qMin<qsizetype>(t_frame.size(),
+                              UNIVERSE_OUTPUT_COUNT_DEFAULT));
+}
+
+/******************************* SacnOutputSink **************************/
+
+SacnOutputSink::SacnOutputSink(const QString &t_sourceName,
+                               const QUuid &t_cid)
+  : NetworkOutputSink(SACN_PORT),
+    m_sourceName(t_sourceName),
+    m_cid(t_cid)
+{}
+
+SacnOutputSink::~SacnOutputSink()
+{
+  close();
+}
+
+QUuid SacnOutputSink::getLocalCid()
+{
+  static const QUuid cid = QUuid::createUuid();
+  return cid;
+}
+
+quint8 SacnOutputSink::getPriority(uid t_uid) const
+{
+  QMutexLocker locker(&m_settingMutex);
+  return m_H_priority.value(t_uid,
+                            SACN_PRIORITY_DEFAULT);
+}
+
+void SacnOutputSink::setPriority(uid t_uid,
+                                 quint8 t_priority)
+{
+  if (t_priority > SACN_PRIORITY_MAX)
+    t_priority = SACN_PRIORITY_MAX;
+  QMutexLocker locker(&m_settingMutex);
+  m_H_priority.insert(t_uid,
+                      t_priority);
+}
+
+bool SacnOutputSink::open()
+{
+  if (!NetworkOutputSink::open())
+    return false;
+  m_socket->setSocketOption(QAbstractSocket::MulticastTtlOption,
+                            SACN_MULTICAST_TTL);
+  return true;
+}
+
+void SacnOutputSink::close()
+{
+  if (!m_socket)
+    return;
+
+  // receivers can drop us at once instead of waiting for timeout
+  QMutexLocker locker(&m_settingMutex);
+  for (int i = 0;
+       i < SACN_TERMINATED_PACKET_COUNT;
+       i++)
+  {
+    for (qsizetype j = 0;
+         j < m_L_packet.size();
+         j++)
+    {
+      if (!m_L_isStreaming.at(j))
+        continue;
+      auto data = m_L_packet[j].data();
+      data[111] = static_cast<char>(m_L_sequence.at(j));
+      m_L_sequence[j]++;
+      data[112] = 0x40; // stream terminated
+      sendPacket(j);
+    }
+    flush();
+  }
+  m_L_isStreaming.fill(false);
+  locker.unlock();
+
+  NetworkOutputSink::close();
+}
+
+QByteArray SacnOutputSink::createPacketTemplate(uid t_uid)
+{
+  QByteArray packet(SACN_PACKET_SIZE,
+                    0);
+  auto data = reinterpret_cast<uchar *>(packet.data());
+  quint16 universe = t_uid + 1;
+
+  // root layer
+  qToBigEndian<quint16>(0x0010, data); // preamble size
+  qToBigEndian<quint16>(0x0000, data + 2); // postamble size
+  std::memcpy(data + 4, "ASC-E1.17\0\0\0", 12);
+  qToBigEndian<quint16>(0x7000 | (SACN_PACKET_SIZE - 16), data + 16);
+  qToBigEndian<quint32>(0x00000004, data + 18); // VECTOR_ROOT_E131_DATA
+  auto cid = m_cid.toRfc4122();
+  std::memcpy(data + 22, cid.constData(), 16);
+
+  // framing layer
+  qToBigEndian<quint16>(0x7000 | (SACN_PACKET_SIZE - 38), data + 38);
+  qToBigEndian<quint32>(0x00000002, data + 40); // VECTOR_E131_DATA_PACKET
+  auto name = m_sourceName.toUtf8().left(SACN_SOURCE_NAME_SIZE - 1);
+  std::memcpy(data + 44, name.constData(), name.size());
+  data[108] = SACN_PRIORITY_DEFAULT;
+  qToBigEndian<quint16>(0, data + 109); // synchronization address
+  data[111] = 0; // sequence
+  data[112] = 0; // options
+  qToBigEndian<quint16>(universe, data + 113);
+
+  // dmp layer
+  qToBigEndian<quint16>(0x7000 | (SACN_PACKET_SIZE - 115), data + 115);
+  data[117] = 0x02; // VECTOR_DMP_SET_PROPERTY
+  data[118] = 0xa1; // address type & data type
+  qToBigEndian<quint16>(0x0000, data + 119); // first property address
+  qToBigEndian<quint16>(0x0001, data + 121); // address increment
+  qToBigEndian<quint16>(UNIVERSE_OUTPUT_COUNT_DEFAULT + 1, data + 123);
+  data[125] = 0; // start code
+
+  m_L_sequence.append(0);
+  m_L_isStreaming.append(false);
+  return packet;
+}
+
+QHostAddress SacnOutputSink::getDefaultAddress(uid t_uid) const
+{
+  // 239.255.universe high.universe low
+  quint16 universe = t_uid + 1;
+  return QHostAddress(0xefff0000u | universe);
+}
+
+void SacnOutputSink::encodePacket(uid t_uid,
+                                  const QByteArray &t_frame,
+                                  QByteArray &t_packet)
+{
+  auto data = t_packet.data();
+  data[108] = static_cast<char>(m_H_priority.value(t_uid,
+                                                   SACN_PRIORITY_DEFAULT));
+  data[111] = static_cast<char>(m_L_sequence.at(t_uid));
+  m_L_sequence[t_uid]++;
+  data[112] = 0; // options
+  std::memcpy(data + SACN_DMX_OFFSET,
+              t_frame.constData(),
+              qMin<qsizetype>(t_frame.size(),
+                              UNIVERSE_OUTPUT_COUNT_DEFAULT));
+  m_L_isStreaming[t_uid] = true;
+}
@@ -0,0 +1,238 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NETWORKOUTPUT_H
+#define NETWORKOUTPUT_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QByteArray>
+#include <QMutex>
+#include <QHostAddress>
+#include <QUuid>
+#include "../qontrejour.h"
+
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#endif
+
+class QUdpSocket;
+
+/****************************** DmxOutputSink ****************************/
+
+// something which takes whole universe frames from the output thread.
+// open(), close() and sendFrames() are called from the output thread only.
+class DmxOutputSink
+{
+
+public :
+
+  DmxOutputSink(){}
+
+  virtual ~DmxOutputSink(){}
+
+  virtual QString getName() const = 0;
+
+  virtual bool open() = 0;
+  virtual void close() = 0;
+
+  // t_L_isToSend : universe changed or its keep alive elapsed
+  virtual void sendFrames(const QList<QByteArray> &t_L_frame,
+                          const QList<bool> &t_L_isToSend) = 0;
+};
+
+/*************************** UdpDatagramBatch ****************************/
+
+// preallocated list of datagrams sent in one go,
+// with sendmmsg() on linux, one writeDatagram() per packet elsewhere.
+class UdpDatagramBatch
+{
+
+public :
+
+  UdpDatagramBatch(){}
+
+  ~UdpDatagramBatch(){}
+
+  int getCount() const{ return m_count; }
+
+  // t_data must stay valid till flush()
+  void append(const char *t_data,
+              int t_size,
+              const QHostAddress &t_address,
+              quint16 t_port);
+  void flush(QUdpSocket *t_socket);
+
+private :
+
+  int m_count = 0;
+
+  // storage only grows, nothing is allocated once the batch is warm
+#ifdef Q_OS_LINUX
+  QList<mmsghdr> m_L_message;
+  QList<iovec> m_L_iovec;
+  QList<sockaddr_in> m_L_address;
+#else
+  QList<const char *> m_L_data;
+  QList<int> m_L_size;
+  QList<QHostAddress> m_L_address;
+  QList<quint16> m_L_port;
+#endif
+
+};
+
+/*************************** NetworkOutputSink ***************************/
+
+// common part of udp sinks : unicast table, socket, packet templates,
+// batched sending. Subclasses only know their packet format.
+class NetworkOutputSink
+    : public DmxOutputSink
+{
+
+public :
+
+  explicit NetworkOutputSink(quint16 t_port);
+
+  virtual ~NetworkOutputSink();
+
+  // unicast table. A universe without node goes to default address.
+  QList<QHostAddress> getL_node(uid t_uid) const;
+  void addNode(uid t_uid,
+               const QHostAddress &t_node);
+  void removeNode(uid t_uid,
+                  const QHostAddress &t_node);
+  void clearNodes(uid t_uid);
+
+  bool open() override;
+  void close() override;
+  void sendFrames(const QList<QByteArray> &t_L_frame,
+                  const QList<bool> &t_L_isToSend) override;
+
+protected :
+
+  // called once per universe, the first time it is sent
+  virtual QByteArray createPacketTemplate(uid t_uid) = 0;
+  virtual QHostAddress getDefaultAddress(uid t_uid) const = 0;
+  // write frame into the preallocated packet, no allocation here.
+  // called with m_settingMutex locked
+  virtual void encodePacket(uid t_uid,
+                            const QByteArray &t_frame,
+                            QByteArray &t_packet) = 0;
+
+  // queue packet to unicast nodes or default address.
+  // called with m_settingMutex locked
+  void sendPacket(uid t_uid);
+  void flush(){ m_batch.flush(m_socket); }
+
+protected :
+
+  quint16 m_port;
+
+  // protect unicast table and every setting changed from outside
+  mutable QMutex m_settingMutex;
+  QHash<uid, QList<QHostAddress>> m_H_unicastNode;
+
+  QUdpSocket *m_socket = nullptr;
+  UdpDatagramBatch m_batch;
+
+  QList<QByteArray> m_L_packet;
+  QList<QHostAddress> m_L_defaultAddress;
+
+};
+
+/****************************** ArtNetOutputSink *************************/
+
+class ArtNetOutputSink
+    : public NetworkOutputSink
+{
+
+public :
+
+  explicit ArtNetOutputSink(const QHostAddress &t_broadcastAddress
+                            = QHostAddress(QHostAddress::Broadcast));
+
+  ~ArtNetOutputSink(){}
+
+  QString getName() const override{ return QString("Art-Net"); }
+
+protected :
+
+  QByteArray createPacketTemplate(uid t_uid) override;
+  QHostAddress getDefaultAddress(uid t_uid) const override
+  { Q_UNUSED(t_uid) return m_broadcastAddress; }
+  void encodePacket(uid t_uid,
+                    const QByteArray &t_frame,
+                    QByteArray &t_packet) override;
+
+private :
+
+  QHostAddress m_broadcastAddress;
+  QList<quint8> m_L_sequence;
+
+};
+
+/******************************* SacnOutputSink **************************/
+
+// E1.31 sender. Universe 0 of Qontrejour is sACN universe 1.
+class SacnOutputSink
+    : public NetworkOutputSink
+{
+
+public :
+
+  explicit SacnOutputSink(const QString &t_sourceName = QString("Qontrejour"),
+                          const QUuid &t_cid = SacnOutputSink::getLocalCid());
+
+  ~SacnOutputSink();
+
+  QString getName() const override{ return QString("sACN"); }
+  QString getSourceName() const{ return m_sourceName; }
+  QUuid getCid() const{ return m_cid; }
+  // created once per process, network input drops packets carrying it
+  static QUuid getLocalCid();
+  quint8 getPriority(uid t_uid) const;
+
+  // 0 to 200, default 100
+  void setPriority(uid t_uid,
+                   quint8 t_priority);
+
+  bool open() override;
+  // send stream terminated packets before closing socket
+  void close() override;
+
+protected :
+
+  QByteArray createPacketTemplate(uid t_uid) override;
+  QHostAddress getDefaultAddress(uid t_uid) const override;
+  void encodePacket(uid t_uid,
+                    const QByteArray &t_frame,
+                    QByteArray &t_packet) override;
+
+private :
+
+  QString m_sourceName;
+  QUuid m_cid;
+  QHash<uid, quint8> m_H_priority;
+  QList<quint8> m_L_sequence;
+  QList<bool> m_L_isStreaming;
+
+};
+
+#endif // NETWORKOUTPUT_H
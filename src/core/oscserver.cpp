@@ -0,0 +1,736 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "oscserver.h"
+#include "dmxmanager.h"
+#include "latencystats.h"
+#include "trace.h"
+#include <QUdpSocket>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+#include <cstdio>
+
+// osc strings and blobs are padded to 4 bytes
+static int oscPadded(qsizetype t_size)
+{
+  return static_cast<int>((t_size + 3) & ~3);
+}
+
+// match "/t_segment" at t_p and move t_p after it
+static bool takeSegment(const char *&t_p,
+                        const char *t_end,
+                        const char *t_segment)
+{
+  auto size = static_cast<qsizetype>(std::strlen(t_segment));
+  if (t_end - t_p < size + 1
+      || *t_p != '/'
+      || std::memcmp(t_p + 1, t_segment, size) != 0)
+  {
+    return false;
+  }
+  auto next = t_p + 1 + size;
+  if (next != t_end && *next != '/')
+    return false;
+  t_p = next;
+  return true;
+}
+
+// match "/<number>" at t_p and move t_p after it
+static bool takeNumber(const char *&t_p,
+                       const char *t_end,
+                       int &t_number)
+{
+  if (t_end - t_p < 2 || *t_p != '/')
+    return false;
+  auto p = t_p + 1;
+  int number = 0;
+  int digitCount = 0;
+  while (p < t_end
+         && *p >= '0'
+         && *p <= '9'
+         && digitCount < 5)
+  {
+    number = number * 10 + (*p - '0');
+    p++;
+    digitCount++;
+  }
+  if (!digitCount
+      || (p != t_end && *p != '/'))
+  {
+    return false;
+  }
+  t_number = number;
+  t_p = p;
+  return true;
+}
+
+struct OscKeypadName
+{
+  const char *m_name;
+  KeypadButton m_button;
+};
+
+static const OscKeypadName oscKeypadNames[] =
+{
+  {"0", Zero}, {"1", One}, {"2", Two}, {"3", Three}, {"4", Four},
+  {"5", Five}, {"6", Six}, {"7", Seven}, {"8", Eight}, {"9", Nine},
+  {"dot", Dot},
+  {"time", Time}, {"timein", Timein}, {"timeout", Timeout},
+  {"delayin", Delayin}, {"delayout", Delayout},
+  {"channel", Channel}, {"output", Output}, {"cue", Cue}, {"group", Group},
+  {"record", Record}, {"update", Update}, {"delete", Delete},
+  {"patch", Patch}, {"unpatch", Unpatch},
+  {"plus", Plus}, {"moins", Moins}, {"clear", Clear}, {"all", All},
+  {"thru", Thru},
+  {"pluspc", Pluspc}, {"moinspc", Moinspc},
+  {"arobasedmx", ArobaseDmx}, {"arobasepercent", ArobasePercent},
+  {"scale", Scale}, {"fan", Fan}, {"vfan", Vfan},
+  {"step", Step}, {"goto", Goto},
+  {"help", Help}
+};
+
+struct OscPlayBackName
+{
+  const char *m_name;
+  PlayBackButton m_button;
+};
+
+static const OscPlayBackName oscPlayBackNames[] =
+{
+  {"go", GoButton}, {"back", GoBackButton}, {"pause", PauseButton},
+  {"plus", SeqPlusButton}, {"moins", SeqMoinsButton}
+};
+
+struct OscWaveformName
+{
+  const char *m_name;
+  EffectWaveform m_waveform;
+};
+
+static const OscWaveformName oscWaveformNames[] =
+{
+  {"sine", SineWave}, {"ramp", RampWave}, {"square", SquareWave},
+  {"random", RandomWave}, {"step", StepWave}
+};
+
+/******************************** OscMessage *****************************/
+
+bool OscMessage::parse(const char *t_data,
+                       int t_size)
+{
+  if (t_size < 4
+      || t_size % 4
+      || t_data[0] != '/')
+  {
+    return false;
+  }
+  m_end = t_data + t_size;
+
+  auto addressEnd = static_cast<const char *>(std::memchr(t_data,
+                                                          '\0',
+                                                          t_size));
+  if (!addressEnd)
+    return false;
+  m_address = t_data;
+  m_addressSize = static_cast<int>(addressEnd - t_data);
+
+  auto p = t_data + oscPadded(m_addressSize + 1);
+  if (p >= m_end || *p != ',')
+  {
+    // no type tag, no argument
+    m_typeTag = nullptr;
+    m_typeTagCount = 0;
+    m_arg = m_end;
+    return true;
+  }
+  auto typeTagEnd = static_cast<const char *>(std::memchr(p,
+                                                          '\0',
+                                                          m_end - p));
+  if (!typeTagEnd)
+    return false;
+  m_typeTag = p + 1;
+  m_typeTagCount = static_cast<int>(typeTagEnd - m_typeTag);
+  m_arg = p + oscPadded(typeTagEnd - p + 1);
+  return m_arg <= m_end;
+}
+
+char OscMessage::getType(int t_index) const
+{
+  if (t_index < 0
+      || t_index >= m_typeTagCount)
+  {
+    return '\0';
+  }
+  return m_typeTag[t_index];
+}
+
+bool OscMessage::getFloat(int t_index,
+                          float &t_value) const
+{
+  auto p = getArg(t_index);
+  if (!p)
+    return false;
+  auto remaining = m_end - p;
+  switch (m_typeTag[t_index])
+  {
+  case 'i' :
+    if (remaining < 4) return false;
+    t_value = static_cast<float>(qFromBigEndian<qint32>(p));
+    return true;
+  case 'f' :
+  {
+    if (remaining < 4) return false;
+    auto bits = qFromBigEndian<quint32>(p);
+    std::memcpy(&t_value, &bits, 4);
+    return true;
+  }
+  case 'h' :
+    if (remaining < 8) return false;
+    t_value = static_cast<float>(qFromBigEndian<qint64>(p));
+    return true;
+  case 'd' :
+  {
+    if (remaining < 8) return false;
+    auto bits = qFromBigEndian<quint64>(p);
+    double value;
+    std::memcpy(&value, &bits, 8);
+    t_value = static_cast<float>(value);
+    return true;
+  }
+  case 'T' :
+    t_value = 1.0f;
+    return true;
+  case 'F' :
+    t_value = 0.0f;
+    return true;
+  default :
+    return false;
+  }
+}
+
+bool OscMessage::getString(int t_index,
+                           QString &t_value) const
+{
+  auto p = getArg(t_index);
+  if (!p
+      || (m_typeTag[t_index] != 's'
+          && m_typeTag[t_index] != 'S'))
+  {
+    return false;
+  }
+  auto stringEnd = static_cast<const char *>(std::memchr(p,
+                                                         '\0',
+                                                         m_end - p));
+  if (!stringEnd)
+    return false;
+  t_value = QString::fromUtf8(p,
+                              stringEnd - p);
+  return true;
+}
+
+const char *OscMessage::getArg(int t_index) const
+{
+  if (t_index < 0
+      || t_index >= m_typeTagCount)
+  {
+    return nullptr;
+  }
+  auto p = m_arg;
+  for (int i = 0;
+       i < t_index;
+       i++)
+  {
+    // sizes are checked before moving, p never leaves the datagram
+    auto remaining = m_end - p;
+    qsizetype size = 0;
+    switch (m_typeTag[i])
+    {
+    case 'i' : case 'f' : case 'c' : case 'r' : case 'm' :
+      size = 4;
+      break;
+    case 'h' : case 'd' : case 't' :
+      size = 8;
+      break;
+    case 's' : case 'S' :
+    {
+      auto stringEnd = static_cast<const char *>(std::memchr(p,
+                                                             '\0',
+                                                             remaining));
+      if (!stringEnd)
+        return nullptr;
+      size = oscPadded(stringEnd - p + 1);
+      break;
+    }
+    case 'b' :
+    {
+      if (remaining < 4)
+        return nullptr;
+      auto blobSize = qFromBigEndian<qint32>(p);
+      if (blobSize < 0
+          || blobSize > remaining - 4)
+      {
+        return nullptr;
+      }
+      size = 4 + oscPadded(blobSize);
+      break;
+    }
+    default : // T, F, N, I : no data
+      break;
+    }
+    if (size > remaining)
+      return nullptr;
+    p += size;
+  }
+  return p;
+}
+
+/******************************** OscServer ******************************/
+
+OscServer::OscServer(DmxEngine *t_engine,
+                     QObject *parent)
+  : QObject(parent),
+    m_engine(t_engine),
+    m_datagram(OSC_PACKET_SIZE_MAX, 0),
+    m_feedbackBuffer(OSC_FEEDBACK_MESSAGE_MAX * OSC_MESSAGE_SIZE_MAX, 0)
+{
+  connect(m_engine,
+          SIGNAL(ticked()),
+          this,
+          SLOT(onEngineTicked()));
+}
+
+OscServer::~OscServer()
+{
+  close();
+}
+
+bool OscServer::open(quint16 t_port)
+{
+  close();
+  m_port = t_port;
+  m_socket = new QUdpSocket(this);
+  if (!m_socket->bind(QHostAddress::AnyIPv4,
+                      m_port))
+  {
+    qWarning() << "can't OscServer::open" << m_socket->errorString();
+    delete m_socket;
+    m_socket = nullptr;
+    return false;
+  }
+  connect(m_socket,
+          SIGNAL(readyRead()),
+          this,
+          SLOT(onReadyRead()));
+  return true;
+}
+
+void OscServer::close()
+{
+  delete m_socket;
+  m_socket = nullptr;
+}
+
+void OscServer::addFeedbackTarget(const QHostAddress &t_address,
+                                  quint16 t_port)
+{
+  for (qsizetype i = 0;
+       i < m_L_feedbackAddress.size();
+       i++)
+  {
+    if (m_L_feedbackPort.at(i) == t_port
+        && m_L_feedbackAddress.at(i) == t_address)
+    {
+      return;
+    }
+  }
+  m_L_feedbackAddress.append(t_address);
+  m_L_feedbackPort.append(t_port);
+  // newcomer needs the whole state
+  m_L_sentChannelLevel.fill(-1);
+  m_L_sentGroupLevel.fill(-1);
+}
+
+void OscServer::clearFeedbackTargets()
+{
+  m_L_feedbackAddress.clear();
+  m_L_feedbackPort.clear();
+}
+
+void OscServer::onReadyRead()
+{
+  while (m_socket->hasPendingDatagrams())
+  {
+    auto size = m_socket->readDatagram(m_datagram.data(),
+                                       m_datagram.size(),
+                                       &m_sender);
+    if (size < 0)
+      break;
+    if (m_isReplyToSender)
+      addFeedbackTarget(m_sender,
+                        m_feedbackPort);
+    parsePacket(m_datagram.constData(),
+                static_cast<int>(size),
+                0);
+  }
+}
+
+void OscServer::parsePacket(const char *t_data,
+                            int t_size,
+                            int t_depth)
+{
+  if (t_size >= 16
+      && std::memcmp(t_data, "#bundle", 8) == 0)
+  {
+    // time tag is ignored, everything is immediate
+    if (t_depth >= OSC_BUNDLE_DEPTH_MAX)
+      return;
+    auto p = t_data + 16;
+    auto end = t_data + t_size;
+    while (end - p >= 4)
+    {
+      auto elementSize = qFromBigEndian<qint32>(p);
+      p += 4;
+      if (elementSize <= 0
+          || elementSize > end - p)
+      {
+        return;
+      }
+      parsePacket(p,
+                  elementSize,
+                  t_depth + 1);
+      p += elementSize;
+    }
+    return;
+  }
+
+  OscMessage message;
+  if (message.parse(t_data,
+                    t_size))
+  {
+    dispatch(message);
+  }
+}
+
+void OscServer::dispatch(const OscMessage &t_message)
+{
+  auto p = t_message.getAddress();
+  auto end = p + t_message.getAddressSize();
+  int number = 0;
+  dmx level = NULL_DMX;
+
+  if (takeSegment(p, end, "chan"))
+  {
+    if (takeNumber(p, end, number)
+        && takeSegment(p, end, "level")
+        && p == end
+        && number > 0
+        && getLevelArg(t_message, level))
+    {
+      m_engine->requestChannelLevel(static_cast<id>(number - 1), // human - machine translation
+                                    level);
+    }
+    return;
+  }
+
+  if (takeSegment(p, end, "group"))
+  {
+    if (takeNumber(p, end, number)
+        && takeSegment(p, end, "level")
+        && p == end
+        && number > 0
+        && getLevelArg(t_message, level))
+    {
+      m_engine->requestGroupLevel(static_cast<id>(number - 1),
+                                  level);
+    }
+    return;
+  }
+
+  // engine thread, like the engine
+  if (takeSegment(p, end, "fx"))
+  {
+    if (takeSegment(p, end, "clear")
+        && p == end)
+    {
+      m_engine->onClearEffects();
+      return;
+    }
+    if (!takeNumber(p, end, number)
+        || number <= 0)
+    {
+      return;
+    }
+    auto effectId = static_cast<id>(number - 1);
+    if (takeSegment(p, end, "stop")
+        && p == end)
+    {
+      m_engine->onRemoveEffect(effectId);
+      return;
+    }
+    QString waveformName;
+    float rate = EFFECT_RATE_DEFAULT;
+    float phaseSpread = EFFECT_PHASE_SPREAD_DEFAULT;
+    dmx size = MAX_DMX;
+    if (p != end
+        || !t_message.getString(0, waveformName)
+        || !t_message.getFloat(1, rate)
+        || !t_message.getFloat(2, phaseSpread)
+        || !getLevelArg(t_message, size, 3))
+    {
+      return;
+    }
+    QString mergeName;
+    auto mergeMode = EffectMergeMode::HtpEffect;
+    if (t_message.getString(4, mergeName)
+        && mergeName == QLatin1String("relative"))
+    {
+      mergeMode = EffectMergeMode::RelativeEffect;
+    }
+    for (const auto &item
+         : oscWaveformNames)
+    {
+      if (waveformName == QLatin1String(item.m_name))
+      {
+        m_engine->onSetEffect(effectId,
+                              item.m_waveform,
+                              rate,
+                              phaseSpread,
+                              size,
+                              mergeMode);
+        return;
+      }
+    }
+    return;
+  }
+
+  if (takeSegment(p, end, "cmd"))
+  {
+    QString command;
+    if (p == end
+        && t_message.getString(0, command))
+    {
+      MANAGER->commandToInterpreter(command);
+    }
+    return;
+  }
+
+  // headless engine has no stats dock
+  if (takeSegment(p, end, "stats"))
+  {
+    if (takeSegment(p, end, "latency"))
+    {
+      if (takeSegment(p, end, "dump")
+          && p == end)
+      {
+        qInfo().noquote() << LatencyStats::instance()->dump();
+      }
+      else if (takeSegment(p, end, "reset")
+               && p == end)
+      {
+        LatencyStats::instance()->reset();
+      }
+    }
+    else if (takeSegment(p, end, "frames"))
+    {
+      auto manager = MANAGER;
+      if (takeSegment(p, end, "dump")
+          && p == end)
+      {
+        qInfo().noquote() << manager->getOutputThread()->dumpFrameStats()
+                             + manager->getStallWatchdog()->dump();
+      }
+      else if (takeSegment(p, end, "reset")
+               && p == end)
+      {
+        manager->getOutputThread()->resetFrameStats();
+        manager->getStallWatchdog()->resetStats();
+      }
+    }
+    else if (takeSegment(p, end, "trace"))
+    {
+      auto tracer = Tracer::instance();
+      if (takeSegment(p, end, "start")
+          && p == end)
+      {
+        tracer->stop();
+        tracer->clear();
+        tracer->start();
+      }
+      else if (takeSegment(p, end, "stop")
+               && p == end)
+      {
+        tracer->stop();
+      }
+      else if (takeSegment(p, end, "dump")
+               && p == end)
+      {
+        if (tracer->exportChromeJson(TRACE_FILE_DEFAULT))
+          qInfo() << "trace written to" << TRACE_FILE_DEFAULT;
+      }
+    }
+    return;
+  }
+
+  // buttons : no argument or non zero argument is a press
+  float value = 1.0f;
+  if (t_message.getArgCount())
+    t_message.getFloat(0, value);
+  bool isPressed = value != 0.0f;
+
+  if (takeSegment(p, end, "seq"))
+  {
+    for (const auto &item
+         : oscPlayBackNames)
+    {
+      auto q = p;
+      if (takeSegment(q, end, item.m_name)
+          && q == end)
+      {
+        if (isPressed)
+          MANAGER->playBackToEngine(item.m_button);
+        return;
+      }
+    }
+    return;
+  }
+
+  if (takeSegment(p, end, "key"))
+  {
+    for (const auto &item
+         : oscKeypadNames)
+    {
+      auto q = p;
+      if (takeSegment(q, end, item.m_name)
+          && q == end)
+      {
+        if (isPressed)
+          MANAGER->keypadToInterpreter(item.m_button);
+        return;
+      }
+    }
+  }
+}
+
+bool OscServer::getLevelArg(const OscMessage &t_message,
+                            dmx &t_level,
+                            int t_index) const
+{
+  float value = 0.0f;
+  if (!t_message.getFloat(t_index, value))
+    return false;
+  // float faders are normalized, integers are dmx
+  if (t_message.getType(t_index) == 'f'
+      || t_message.getType(t_index) == 'd')
+  {
+    value *= MAX_DMX;
+  }
+  if (value < NULL_DMX) value = NULL_DMX;
+  if (value > MAX_DMX) value = MAX_DMX;
+  t_level = static_cast<dmx>(value + 0.5f);
+  return true;
+}
+
+void OscServer::onEngineTicked()
+{
+  if (!m_socket
+      || m_L_feedbackAddress.isEmpty())
+  {
+    return;
+  }
+
+  int messageCount = 0;
+  queueChangedLevels(m_engine->getChannelEngine()->getRootChannel(),
+                     m_L_sentChannelLevel,
+                     "/chan/%d/level",
+                     messageCount);
+  queueChangedLevels(MANAGER->getRootChannelGroup(),
+                     m_L_sentGroupLevel,
+                     "/group/%d/level",
+                     messageCount);
+  if (messageCount)
+    m_batch.flush(m_socket);
+}
+
+int OscServer::writeLevelMessage(char *t_buffer,
+                                 const char *t_format,
+                                 id t_id,
+                                 dmx t_level) const
+{
+  // address, padded type tag ",f", big endian float
+  auto addressSize = std::snprintf(t_buffer,
+                                   OSC_MESSAGE_SIZE_MAX - 8,
+                                   t_format,
+                                   t_id + 1);
+  if (addressSize <= 0
+      || addressSize >= OSC_MESSAGE_SIZE_MAX - 8)
+  {
+    return 0;
+  }
+  auto size = oscPadded(addressSize + 1);
+  std::memset(t_buffer + addressSize,
+              '\0',
+              size - addressSize);
+  std::memcpy(t_buffer + size, ",f\0\0", 4);
+  size += 4;
+  float value = static_cast<float>(t_level) / MAX_DMX;
+  quint32 bits;
+  std::memcpy(&bits, &value, 4);
+  qToBigEndian(bits,
+               t_buffer + size);
+  return size + 4;
+}
+
+void OscServer::queueChangedLevels(RootValue *t_rootValue,
+                                   QList<int> &t_L_sentLevel,
+                                   const char *t_format,
+                                   int &t_messageCount)
+{
+  auto count = t_rootValue->getL_childValueSize();
+  if (t_L_sentLevel.size() != count)
+    t_L_sentLevel.resize(count, -1);
+
+  // what doesn't fit this tick stays different, sent next tick
+  for (int i = 0;
+       i < count
+       && t_messageCount < OSC_FEEDBACK_MESSAGE_MAX;
+       i++)
+  {
+    dmx level = t_rootValue->getChildValue(i)->getLevel();
+    if (t_L_sentLevel.at(i) == level)
+      continue;
+    auto buffer = m_feedbackBuffer.data()
+        + t_messageCount * OSC_MESSAGE_SIZE_MAX;
+    auto size = writeLevelMessage(buffer,
+                                  t_format,
+                                  static_cast<id>(i),
+                                  level);
+    if (!size)
+      continue;
+    for (qsizetype j = 0;
+         j < m_L_feedbackAddress.size();
+         j++)
+    {
+      m_batch.append(buffer,
+                     size,
+                     m_L_feedbackAddress.at(j),
+                     m_L_feedbackPort.at(j));
+    }
+    t_L_sentLevel[i] = level;
+    t_messageCount++;
+  }
+}
@@ -0,0 +1,170 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OSCSERVER_H
+#define OSCSERVER_H
+
+#include <QObject>
+#include <QList>
+#include <QByteArray>
+#include <QHostAddress>
+#include "../qontrejour.h"
+#include "dmxvalue.h"
+#include "networkoutput.h"
+
+class QUdpSocket;
+class DmxEngine;
+
+/******************************** OscMessage *****************************/
+
+// view on one message inside the receive buffer, nothing is copied
+class OscMessage
+{
+
+public :
+
+  OscMessage(){}
+
+  ~OscMessage(){}
+
+  bool parse(const char *t_data,
+             int t_size);
+
+  const char *getAddress() const{ return m_address; }
+  int getAddressSize() const{ return m_addressSize; }
+  int getArgCount() const{ return m_typeTagCount; }
+
+  // numeric argument : i, f, h, d, T, F
+  bool getFloat(int t_index,
+                float &t_value) const;
+  char getType(int t_index) const;
+  // s or S argument
+  bool getString(int t_index,
+                 QString &t_value) const;
+
+private :
+
+  // pointer on argument t_index, nullptr if out of packet
+  const char *getArg(int t_index) const;
+
+private :
+
+  const char *m_address = nullptr;
+  int m_addressSize = 0;
+  const char *m_typeTag = nullptr; // after ','
+  int m_typeTagCount = 0;
+  const char *m_arg = nullptr;
+  const char *m_end = nullptr;
+
+};
+
+/******************************** OscServer ******************************/
+
+// udp osc control :
+// /chan/<n>/level, /group/<n>/level : i 0-255 or f 0.0-1.0
+// /seq/go, /seq/back, /seq/pause, /seq/plus, /seq/moins
+// /key/<button> : lower case KeypadButton name, 0, 1... dot, thru...
+// /cmd s : text commands or script, "1 thru 48 @ 75; record"
+// /fx/<n> s f f i|f [s] : effect n on the selected channels, waveform
+// (sine, ramp, square, random, step), rate Hz, phase spread in cycles
+// across the channels, size, "relative" to add instead of htp.
+// /fx/<n>/stop, /fx/clear
+// /stats/latency/dump : latency table to the log, /stats/latency/reset
+// /stats/frames/dump : output jitter and stalls, /stats/frames/reset
+// /stats/trace/start, /stats/trace/stop, /stats/trace/dump : chrome
+// trace to TRACE_FILE_DEFAULT, QONTREJOUR_TRACE builds only
+// Levels are coalesced by the engine till next tick. Feedback sends
+// /chan/<n>/level and /group/<n>/level f, only when they changed.
+class OscServer
+    : public QObject
+{
+
+  Q_OBJECT
+
+public :
+
+  explicit OscServer(DmxEngine *t_engine,
+                     QObject *parent = nullptr);
+
+  ~OscServer();
+
+  quint16 getPort() const{ return m_port; }
+  quint16 getFeedbackPort() const{ return m_feedbackPort; }
+  bool getIsReplyToSender() const{ return m_isReplyToSender; }
+
+  void setFeedbackPort(quint16 t_feedbackPort)
+  { m_feedbackPort = t_feedbackPort; }
+  // senders get feedback on getFeedbackPort()
+  void setIsReplyToSender(bool t_isReplyToSender)
+  { m_isReplyToSender = t_isReplyToSender; }
+
+  bool open(quint16 t_port = OSC_PORT_DEFAULT);
+  void close();
+
+  void addFeedbackTarget(const QHostAddress &t_address,
+                         quint16 t_port);
+  void clearFeedbackTargets();
+
+private slots :
+
+  void onReadyRead();
+  void onEngineTicked();
+
+private :
+
+  void parsePacket(const char *t_data,
+                   int t_size,
+                   int t_depth);
+  void dispatch(const OscMessage &t_message);
+  bool getLevelArg(const OscMessage &t_message,
+                   dmx &t_level,
+                   int t_index = 0) const;
+
+  // feedback
+  int writeLevelMessage(char *t_buffer,
+                        const char *t_format,
+                        id t_id,
+                        dmx t_level) const;
+  void queueChangedLevels(RootValue *t_rootValue,
+                          QList<int> &t_L_sentLevel,
+                          const char *t_format,
+                          int &t_messageCount);
+
+private :
+
+  DmxEngine *m_engine;
+  QUdpSocket *m_socket = nullptr;
+  quint16 m_port = OSC_PORT_DEFAULT;
+  quint16 m_feedbackPort = OSC_FEEDBACK_PORT_DEFAULT;
+  bool m_isReplyToSender = true;
+
+  // receive buffer, never reallocated
+  QByteArray m_datagram;
+  QHostAddress m_sender;
+
+  QList<QHostAddress> m_L_feedbackAddress;
+  QList<quint16> m_L_feedbackPort;
+  // last level sent per channel and group, -1 : never sent
+  QList<int> m_L_sentChannelLevel;
+  QList<int> m_L_sentGroupLevel;
+  // OSC_FEEDBACK_MESSAGE_MAX slots of OSC_MESSAGE_SIZE_MAX
+  QByteArray m_feedbackBuffer;
+  UdpDatagramBatch m_batch;
+
+};
+
+#endif // OSCSERVER_H
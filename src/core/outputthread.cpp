@@ -0,0 +1,324 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "outputthread.h"
+#include "networkoutput.h"
+#include "latencystats.h"
+#include "trace.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QDebug>
+#include <cstring>
+
+/****************************** DmxFrameBuffer ***************************/
+
+DmxFrameBuffer::DmxFrameBuffer(int t_universeCount,
+                               bool t_isInputTimeTaken)
+  : m_isInputTimeTaken(t_isInputTimeTaken)
+{
+  setUniverseCount(t_universeCount);
+}
+
+int DmxFrameBuffer::getUniverseCount() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_L_frame.size();
+}
+
+void DmxFrameBuffer::setUniverseCount(int t_universeCount)
+{
+  if (t_universeCount < 0)
+  {
+    qWarning() << "problem in DmxFrameBuffer::setUniverseCount";
+    return;
+  }
+  QMutexLocker locker(&m_mutex);
+  while (m_L_frame.size() < t_universeCount)
+  {
+    m_L_frame.append(QByteArray(UNIVERSE_OUTPUT_COUNT_DEFAULT,
+                                NULL_DMX));
+    m_L_isDirty.append(true);
+  }
+  m_L_frame.resize(t_universeCount);
+  m_L_isDirty.resize(t_universeCount);
+}
+
+void DmxFrameBuffer::setLevel(uid t_uid,
+                              id t_id,
+                              dmx t_level)
+{
+  QMutexLocker locker(&m_mutex);
+  if (t_uid < 0
+      || t_uid >= m_L_frame.size()
+      || t_id < 0
+      || t_id >= UNIVERSE_OUTPUT_COUNT_DEFAULT)
+  {
+    return;
+  }
+  m_L_frame[t_uid].data()[t_id] = static_cast<char>(t_level);
+  m_L_isDirty[t_uid] = true;
+  if (m_isInputTimeTaken
+      && !m_inputTime)
+  {
+    auto latencyStats = LatencyStats::instance();
+    if (latencyStats->isInputArmed())
+      m_inputTime = latencyStats->takeArmedInput();
+  }
+}
+
+bool DmxFrameBuffer::copyFrames(QList<QByteArray> &t_L_frame,
+                                QList<bool> &t_L_isChanged,
+                                qint64 *t_inputTime)
+{
+  QMutexLocker locker(&m_mutex);
+  if (t_inputTime)
+  {
+    *t_inputTime = m_inputTime;
+    m_inputTime = 0;
+  }
+  bool isChanged = false;
+  auto universeCount = m_L_frame.size();
+  if (t_L_frame.size() != universeCount)
+  {
+    t_L_frame.resize(universeCount);
+    t_L_isChanged.resize(universeCount);
+  }
+  for (qsizetype i = 0;
+       i < universeCount;
+       i++)
+  {
+    t_L_isChanged[i] = m_L_isDirty.at(i);
+    if (!m_L_isDirty.at(i))
+      continue;
+    auto &frame = t_L_frame[i];
+    if (frame.size() != UNIVERSE_OUTPUT_COUNT_DEFAULT)
+      frame.resize(UNIVERSE_OUTPUT_COUNT_DEFAULT);
+    std::memcpy(frame.data(),
+                m_L_frame.at(i).constData(),
+                UNIVERSE_OUTPUT_COUNT_DEFAULT);
+    m_L_isDirty[i] = false;
+    isChanged = true;
+  }
+  return isChanged;
+}
+
+/****************************** OutputThread *****************************/
+
+OutputThread::OutputThread(QObject *parent)
+  : QThread(parent)
+{}
+
+OutputThread::~OutputThread()
+{
+  stop();
+  // sinks never opened are still ours
+  QMutexLocker locker(&m_sinkMutex);
+  qDeleteAll(m_L_pendingSink);
+  m_L_pendingSink.clear();
+}
+
+void OutputThread::setRefreshRate(int t_refreshRate)
+{
+  if (t_refreshRate < 1) t_refreshRate = 1;
+  if (t_refreshRate > 1000) t_refreshRate = 1000;
+  m_refreshRate.storeRelaxed(t_refreshRate);
+}
+
+void OutputThread::setKeepAliveInterval(int t_keepAliveInterval)
+{
+  if (t_keepAliveInterval < 0) t_keepAliveInterval = 0;
+  m_keepAliveInterval.storeRelaxed(t_keepAliveInterval);
+}
+
+void OutputThread::addSink(DmxOutputSink *t_sink)
+{
+  if (!t_sink)
+  {
+    qWarning() << "can't OutputThread::addSink";
+    return;
+  }
+  QMutexLocker locker(&m_sinkMutex);
+  m_L_pendingSink.append(t_sink);
+}
+
+void OutputThread::stop()
+{
+  // a flag set in run() would be missed by a stop() before it
+  requestInterruption();
+  if (isRunning())
+    wait();
+}
+
+void OutputThread::resetFrameStats()
+{
+  m_jitterHistogram.reset();
+  m_frameCount.store(0,
+                     std::memory_order_relaxed);
+  m_missedFrameCount.store(0,
+                           std::memory_order_relaxed);
+}
+
+QString OutputThread::dumpFrameStats() const
+{
+  QString text;
+  QTextStream stream(&text);
+  stream << "frames " << getFrameCount()
+         << " missed " << getMissedFrameCount()
+         << " period " << 1000000 / getRefreshRate() << " µs\n"
+         << LatencyStats::getHistogramLine("jitter",
+                                           m_jitterHistogram);
+  return text;
+}
+
+void OutputThread::getMonitorFrames(QList<QByteArray> &t_L_frame) const
+{
+  QMutexLocker locker(&m_monitorMutex);
+  t_L_frame = m_L_monitorFrame;
+}
+
+void OutputThread::run()
+{
+  QList<QByteArray> L_frame;
+  QList<bool> L_isChanged;
+  QList<bool> L_isToSend;
+  QList<qint64> L_lastSendTime;
+
+  QElapsedTimer clock;
+  clock.start();
+  qint64 nextFrameNs = 0;
+  auto latencyStats = LatencyStats::instance();
+
+  while (!isInterruptionRequested())
+  {
+    openPendingSinks();
+
+    qint64 inputTime = 0;
+    bool isChanged;
+    {
+      TRACE_SCOPE("OutputThread::copyFrames");
+      isChanged = m_frameBuffer.copyFrames(L_frame,
+                                           L_isChanged,
+                                           &inputTime);
+    }
+    if (isChanged)
+    {
+      // no copy, next copyFrames detaches changed universes only
+      QMutexLocker locker(&m_monitorMutex);
+      m_L_monitorFrame = L_frame;
+    }
+
+    // a universe is sent when it changed or when keep alive is elapsed
+    auto universeCount = L_frame.size();
+    if (L_isToSend.size() != universeCount)
+    {
+      L_isToSend.resize(universeCount);
+      L_lastSendTime.resize(universeCount);
+    }
+    qint64 nowMs = clock.elapsed();
+    int keepAlive = getKeepAliveInterval();
+    bool isSomethingToSend = false;
+    for (qsizetype i = 0;
+         i < universeCount;
+         i++)
+    {
+      bool isToSend = L_isChanged.at(i)
+          || (keepAlive
+              && nowMs - L_lastSendTime.at(i) >= keepAlive);
+      L_isToSend[i] = isToSend;
+      if (isToSend)
+      {
+        L_lastSendTime[i] = nowMs;
+        isSomethingToSend = true;
+      }
+    }
+
+    if (inputTime)
+      latencyStats->addSample(FrameLatencyStage,
+                              inputTime);
+
+    // frame is on time when sent at its deadline
+    qint64 framePeriodNs = 1000000000LL / getRefreshRate();
+    qint64 lateNs = clock.nsecsElapsed() - nextFrameNs;
+    m_jitterHistogram.addSample(lateNs);
+    TRACE_COUNTER("output late us", lateNs / 1000);
+    m_frameCount.fetch_add(1,
+                           std::memory_order_relaxed);
+    if (lateNs >= framePeriodNs)
+      m_missedFrameCount.fetch_add(static_cast<quint64>(lateNs / framePeriodNs),
+                                   std::memory_order_relaxed);
+
+    if (isSomethingToSend)
+    {
+      TRACE_SCOPE("OutputThread::sendFrames");
+      for (const auto &item
+           : std::as_const(m_L_sink))
+      {
+        item->sendFrames(L_frame,
+                         L_isToSend);
+      }
+      if (inputTime
+          && !m_L_sink.isEmpty())
+      {
+        latencyStats->addSample(SendLatencyStage,
+                                inputTime);
+      }
+    }
+
+    // wait for next frame deadline
+    nextFrameNs += framePeriodNs;
+    qint64 remainingNs = nextFrameNs - clock.nsecsElapsed();
+    if (remainingNs > 0)
+      QThread::usleep(static_cast<unsigned long>(remainingNs / 1000));
+    else if (remainingNs < -framePeriodNs)
+      nextFrameNs = clock.nsecsElapsed(); // we're late, no burst to catch up
+  }
+
+  closeSinks();
+}
+
+void OutputThread::openPendingSinks()
+{
+  QMutexLocker locker(&m_sinkMutex);
+  if (m_L_pendingSink.isEmpty())
+    return;
+  for (const auto &item
+       : std::as_const(m_L_pendingSink))
+  {
+    if (item->open())
+    {
+      m_L_sink.append(item);
+    }
+    else
+    {
+      qWarning() << "can't open output sink" << item->getName();
+      delete item;
+    }
+  }
+  m_L_pendingSink.clear();
+}
+
+void OutputThread::closeSinks()
+{
+  for (const auto &item
+       : std::as_const(m_L_sink))
+  {
+    item->close();
+    delete item;
+  }
+  m_L_sink.clear();
+}
@@ -0,0 +1,142 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OUTPUTTHREAD_H
+#define OUTPUTTHREAD_H
+
+#include <QThread>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QList>
+#include <atomic>
+#include "../qontrejour.h"
+#include "latencystats.h"
+
+class DmxOutputSink;
+
+/****************************** DmxFrameBuffer ***************************/
+
+// whole universe frames, written by the engine side output per output,
+// read by the output thread once per frame.
+class DmxFrameBuffer
+{
+
+public :
+
+  // t_isInputTimeTaken : false for a second buffer, so the output
+  // thread one keeps the armed input
+  explicit DmxFrameBuffer(int t_universeCount = 1,
+                          bool t_isInputTimeTaken = true);
+
+  ~DmxFrameBuffer(){}
+
+  int getUniverseCount() const;
+  void setUniverseCount(int t_universeCount);
+
+  void setLevel(uid t_uid,
+                id t_id,
+                dmx t_level);
+
+  // copy universes written since last call into t_L_frame.
+  // t_L_frame is only reallocated when universe count changes.
+  // t_inputTime gets the LatencyStats time of the input these
+  // frames carry, 0 if none.
+  // return true if something changed
+  bool copyFrames(QList<QByteArray> &t_L_frame,
+                  QList<bool> &t_L_isChanged,
+                  qint64 *t_inputTime = nullptr);
+
+private :
+
+  mutable QMutex m_mutex;
+  QList<QByteArray> m_L_frame;
+  QList<bool> m_L_isDirty;
+  qint64 m_inputTime = 0; // taken from LatencyStats on write
+  bool m_isInputTimeTaken;
+
+};
+
+/****************************** OutputThread *****************************/
+
+class OutputThread
+    : public QThread
+{
+
+  Q_OBJECT
+
+public :
+
+  explicit OutputThread(QObject *parent = nullptr);
+
+  ~OutputThread();
+
+  DmxFrameBuffer *getFrameBuffer(){ return &m_frameBuffer; }
+  int getRefreshRate() const{ return m_refreshRate.loadRelaxed(); }
+  int getKeepAliveInterval() const{ return m_keepAliveInterval.loadRelaxed(); }
+  // ns, frame send time after its deadline
+  const LatencyHistogram &getJitterHistogram() const{ return m_jitterHistogram; }
+  quint64 getFrameCount() const{ return m_frameCount.load(std::memory_order_relaxed); }
+  // deadlines passed without a frame
+  quint64 getMissedFrameCount() const{ return m_missedFrameCount.load(std::memory_order_relaxed); }
+
+  // Hz, clamped between 1 and 1000
+  void setRefreshRate(int t_refreshRate);
+  // ms, 0 means never resend unchanged universes
+  void setKeepAliveInterval(int t_keepAliveInterval);
+
+  // sinks are owned by the thread and opened from it
+  void addSink(DmxOutputSink *t_sink);
+  void stop();
+  void resetFrameStats();
+  // frame and missed counts, then jitter line like LatencyStats::dump()
+  QString dumpFrameStats() const;
+
+  // frames of last send, for monitors. Universes are implicitly
+  // shared : one still shared with the previous call did not change
+  void getMonitorFrames(QList<QByteArray> &t_L_frame) const;
+
+protected :
+
+  void run() override;
+
+private :
+
+  void openPendingSinks();
+  void closeSinks();
+
+private :
+
+  DmxFrameBuffer m_frameBuffer;
+
+  mutable QMutex m_monitorMutex;
+  QList<QByteArray> m_L_monitorFrame;
+
+  QMutex m_sinkMutex;
+  QList<DmxOutputSink *> m_L_pendingSink; // waiting to be opened
+  QList<DmxOutputSink *> m_L_sink; // only touched from the output thread
+
+  QAtomicInt m_refreshRate{OUTPUT_REFRESH_RATE_DEFAULT};
+  QAtomicInt m_keepAliveInterval{OUTPUT_KEEPALIVE_INTERVAL_DEFAULT};
+
+  LatencyHistogram m_jitterHistogram;
+  std::atomic<quint64> m_frameCount{0};
+  std::atomic<quint64> m_missedFrameCount{0};
+
+};
+
+#endif // OUTPUTTHREAD_H
@@ -0,0 +1,154 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "selectionset.h"
+#include <utility>
+
+/****************************** SelectionSet ******************************/
+
+void SelectionSet::resize(int t_size)
+{
+  if (t_size < 0)
+    t_size = 0;
+  if (t_size < m_size)
+    removeRange(t_size,
+                m_size - 1);
+  m_L_word.resize((t_size + WORD_BIT_COUNT - 1) / WORD_BIT_COUNT,
+                  0);
+  m_size = t_size;
+}
+
+int SelectionSet::add(int t_index)
+{
+  if (t_index < 0)
+    return 0;
+  if (t_index >= m_size)
+    resize(t_index + 1);
+  auto &word = m_L_word[t_index / WORD_BIT_COUNT];
+  if (word & bit(t_index))
+    return 0;
+  word |= bit(t_index);
+  m_count++;
+  return 1;
+}
+
+int SelectionSet::remove(int t_index)
+{
+  if (!contains(t_index))
+    return 0;
+  m_L_word[t_index / WORD_BIT_COUNT] &= ~bit(t_index);
+  m_count--;
+  return 1;
+}
+
+int SelectionSet::addRange(int t_first,
+                           int t_last)
+{
+  if (t_first > t_last)
+    std::swap(t_first, t_last);
+  if (t_last < 0)
+    return 0;
+  if (t_last >= m_size)
+    resize(t_last + 1);
+  return applyRange(t_first,
+                    t_last,
+                    AddOperation);
+}
+
+int SelectionSet::removeRange(int t_first,
+                              int t_last)
+{
+  if (t_first > t_last)
+    std::swap(t_first, t_last);
+  if (t_last >= m_size)
+    t_last = m_size - 1;
+  return applyRange(t_first,
+                    t_last,
+                    RemoveOperation);
+}
+
+int SelectionSet::invert()
+{
+  return applyRange(0,
+                    m_size - 1,
+                    InvertOperation);
+}
+
+int SelectionSet::clear()
+{
+  int count = m_count;
+  m_L_word.fill(0);
+  m_count = 0;
+  return count;
+}
+
+QList<int> SelectionSet::getL_index() const
+{
+  QList<int> L_index;
+  L_index.reserve(m_count);
+  forEach([&L_index](int t_index)
+          { L_index.append(t_index); });
+  return L_index;
+}
+
+quint64 SelectionSet::mask(int t_first,
+                           int t_last)
+{
+  int bitCount = t_last - t_first + 1;
+  quint64 lowBits = bitCount == WORD_BIT_COUNT
+                        ? ~quint64(0)
+                        : (quint64(1) << bitCount) - 1;
+  return lowBits << t_first;
+}
+
+int SelectionSet::applyRange(int t_first,
+                             int t_last,
+                             RangeOperation t_operation)
+{
+  if (t_first < 0)
+    t_first = 0;
+  if (t_first > t_last)
+    return 0;
+  int changedCount = 0;
+  int firstWord = t_first / WORD_BIT_COUNT;
+  int lastWord = t_last / WORD_BIT_COUNT;
+  for (int i = firstWord;
+       i <= lastWord;
+       i++)
+  {
+    quint64 wordMask = mask(i == firstWord ? t_first % WORD_BIT_COUNT : 0,
+                            i == lastWord ? t_last % WORD_BIT_COUNT
+                                          : WORD_BIT_COUNT - 1);
+    auto &word = m_L_word[i];
+    quint64 before = word;
+    switch (t_operation)
+    {
+    case AddOperation :
+      word |= wordMask;
+      break;
+    case RemoveOperation :
+      word &= ~wordMask;
+      break;
+    case InvertOperation :
+      word ^= wordMask;
+      break;
+    }
+    changedCount += qPopulationCount(before ^ word);
+    m_count += qPopulationCount(word) - qPopulationCount(before);
+  }
+  return changedCount;
+}
@@ -0,0 +1,114 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SELECTIONSET_H
+#define SELECTIONSET_H
+
+#include <QList>
+#include <QtAlgorithms>
+
+/****************************** SelectionSet ******************************/
+
+// set of indexes, one bit each. Add, remove and contains are O(1),
+// ranges and invert work on whole words. Iteration goes up, over set
+// bits only. Grows on add, contains() is false past getSize().
+class SelectionSet
+{
+
+public :
+
+  SelectionSet(){}
+
+  ~SelectionSet(){}
+
+  int getSize() const{ return m_size; }
+  int getCount() const{ return m_count; }
+  bool isEmpty() const{ return m_count == 0; }
+
+  bool contains(int t_index) const
+  {
+    return t_index >= 0
+           && t_index < m_size
+           && (m_L_word.at(t_index / WORD_BIT_COUNT)
+               & bit(t_index)) != 0;
+  }
+
+  // indexes past t_size are dropped
+  void resize(int t_size);
+
+  // return how many indexes changed
+  int add(int t_index);
+  int remove(int t_index);
+  // t_first and t_last included, in any order
+  int addRange(int t_first,
+               int t_last);
+  int removeRange(int t_first,
+                  int t_last);
+  // over [0, getSize())
+  int invert();
+  int clear();
+
+  // t_function(int) for each set index, going up
+  template<typename Function>
+  void forEach(Function t_function) const
+  {
+    for (int i = 0;
+         i < m_L_word.size();
+         i++)
+    {
+      quint64 word = m_L_word.at(i);
+      while (word)
+      {
+        t_function(i * WORD_BIT_COUNT
+                   + static_cast<int>(qCountTrailingZeroBits(word)));
+        word &= word - 1;
+      }
+    }
+  }
+
+  QList<int> getL_index() const;
+
+private :
+
+  static constexpr int WORD_BIT_COUNT = 64;
+
+  enum RangeOperation
+  {
+    AddOperation,
+    RemoveOperation,
+    InvertOperation
+  };
+
+  static quint64 bit(int t_index)
+  { return quint64(1) << (t_index % WORD_BIT_COUNT); }
+  // bits t_first to t_last of one word
+  static quint64 mask(int t_first,
+                      int t_last);
+
+  int applyRange(int t_first,
+                 int t_last,
+                 RangeOperation t_operation);
+
+private :
+
+  QList<quint64> m_L_word;
+  int m_size = 0;
+  int m_count = 0;
+
+};
+
+#endif // SELECTIONSET_H
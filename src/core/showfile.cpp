@@ -0,0 +1,110 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "showfile.h"
+#include "dmxmanager.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDebug>
+
+/********************************* ShowFile ******************************/
+
+bool ShowFile::load(const QString &t_fileName)
+{
+  QFile file(t_fileName);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    qWarning() << "can't ShowFile::load" << t_fileName
+               << file.errorString();
+    return false;
+  }
+  QJsonParseError parseError;
+  auto document = QJsonDocument::fromJson(file.readAll(),
+                                          &parseError);
+  if (!document.isObject())
+  {
+    qWarning() << "can't ShowFile::load" << t_fileName
+               << parseError.errorString();
+    return false;
+  }
+
+  // reload : previous cues go in one pass. Running fades only
+  // hold channels
+  auto cueEngine = MANAGER->getDmxEngine()->getCueEngine();
+  cueEngine->stop();
+  cueEngine->clear();
+  MANAGER->getMainSequence()->clearScenes();
+  // effects aren't saved, channels go back to their levels next tick
+  MANAGER->getDmxEngine()->getEffectEngine()->clear();
+
+  m_cueCount = 0;
+  const auto L_cue = document.object().value("sequence").toArray();
+  for (const auto &item
+       : L_cue)
+  {
+    if (!loadCue(item.toObject()))
+      return false;
+    m_cueCount++;
+  }
+  cueEngine->setSelectedCueStep(0);
+  return true;
+}
+
+bool ShowFile::loadCue(const QJsonObject &t_cue)
+{
+  auto sceneId = static_cast<sceneID_f>(t_cue.value("id").toDouble());
+  if (sceneId <= 0.0f)
+  {
+    qWarning() << "can't ShowFile::loadCue, bad id" << sceneId;
+    return false;
+  }
+
+  QList<DmxChannel *> L_channel;
+  QHash<DmxChannel *, dmx> H_controledChannel_storedLevel;
+  const auto L_channelLevel = t_cue.value("channels").toArray();
+  for (const auto &item
+       : L_channelLevel)
+  {
+    const auto channelLevel = item.toArray();
+    auto channel = MANAGER->getChannel(static_cast<id>(channelLevel.at(0).toInt(NO_ID)));
+    if (!channel)
+    {
+      qWarning() << "can't ShowFile::loadCue, bad channel in cue" << sceneId;
+      return false;
+    }
+    L_channel.append(channel);
+    H_controledChannel_storedLevel.insert(channel,
+                                          static_cast<dmx>(qBound(0,
+                                                                  channelLevel.at(1).toInt(),
+                                                                  MAX_DMX)));
+  }
+
+  auto cueEngine = MANAGER->getDmxEngine()->getCueEngine();
+  auto scene = cueEngine->createScene(L_channel,
+                                      sceneId);
+  scene->setH_controledChannel_storedLevel(H_controledChannel_storedLevel);
+  scene->setName(t_cue.value("name").toString());
+  scene->setNotes(t_cue.value("notes").toString());
+  scene->setTimeIn(t_cue.value("timeIn").toDouble(scene->getTimeIn()));
+  scene->setTimeOut(t_cue.value("timeOut").toDouble(scene->getTimeOut()));
+  scene->setDelayIn(t_cue.value("delayIn").toDouble(scene->getDelayIn()));
+  scene->setDelayOut(t_cue.value("delayOut").toDouble(scene->getDelayOut()));
+  cueEngine->recordNewCueInMainSeq(scene,
+                                   sceneId);
+  return true;
+}
@@ -0,0 +1,58 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHOWFILE_H
+#define SHOWFILE_H
+
+#include <QString>
+#include <QJsonObject>
+#include "../qontrejour.h"
+
+/********************************* ShowFile ******************************/
+
+// json show, loaded into the main sequence of the manager :
+// { "sequence" : [ { "id" : 10, "name" : "", "notes" : "",
+//                    "timeIn" : 5, "timeOut" : 5,
+//                    "channels" : [ [ channel id, level ], ... ] },
+//                  ... ] }
+// channel ids start at 0, like in the engine. Cues of the main
+// sequence are cleared, then recorded in file order, step 0 is
+// selected when done.
+class ShowFile
+{
+
+public :
+
+  ShowFile(){}
+
+  ~ShowFile(){}
+
+  int getCueCount() const{ return m_cueCount; }
+
+  bool load(const QString &t_fileName);
+
+private :
+
+  bool loadCue(const QJsonObject &t_cue);
+
+private :
+
+  int m_cueCount = 0;
+
+};
+
+#endif // SHOWFILE_H
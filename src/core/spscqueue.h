@@ -0,0 +1,81 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+
+/******************************** SpscQueue ******************************/
+
+// lock free ring between one producer thread and one consumer thread.
+// T is copied in and out, keep it small and trivially copyable.
+template<typename T, int Capacity>
+class SpscQueue
+{
+
+  static_assert((Capacity & (Capacity - 1)) == 0,
+                "SpscQueue capacity must be a power of 2");
+
+public :
+
+  SpscQueue(){}
+
+  ~SpscQueue(){}
+
+  // producer side, false if full
+  bool push(const T &t_item)
+  {
+    auto head = m_head.load(std::memory_order_relaxed);
+    auto next = (head + 1) & (Capacity - 1);
+    if (next == m_tail.load(std::memory_order_acquire))
+      return false;
+    m_item[head] = t_item;
+    m_head.store(next,
+                 std::memory_order_release);
+    return true;
+  }
+
+  // consumer side, false if empty
+  bool pop(T &t_item)
+  {
+    auto tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_head.load(std::memory_order_acquire))
+      return false;
+    t_item = m_item[tail];
+    m_tail.store((tail + 1) & (Capacity - 1),
+                 std::memory_order_release);
+    return true;
+  }
+
+  bool isEmpty() const
+  {
+    return m_tail.load(std::memory_order_acquire)
+        == m_head.load(std::memory_order_acquire);
+  }
+
+private :
+
+  // head and tail on their own cache line, producer and consumer
+  // don't invalidate each other
+  alignas(64) std::atomic<int> m_head{0};
+  alignas(64) std::atomic<int> m_tail{0};
+  T m_item[Capacity];
+
+};
+
+#endif // SPSCQUEUE_H
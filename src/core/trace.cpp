@@ -0,0 +1,189 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trace.h"
+#include "latencystats.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QMutexLocker>
+#include <QFile>
+#include <QDebug>
+
+std::atomic<bool> Tracer::m_isEnabled{false};
+
+// µs with ns precision, chrome trace unit
+static QByteArray traceTime(qint64 t_time)
+{
+  return QByteArray::number(static_cast<double>(t_time) / 1000.0,
+                            'f',
+                            3);
+}
+
+/******************************** TraceBuffer ****************************/
+
+TraceBuffer::TraceBuffer(int t_threadId,
+                         const QString &t_threadName)
+  : m_threadId(t_threadId),
+    m_threadName(t_threadName)
+{}
+
+void TraceBuffer::copyEvents(QList<TraceEvent> &t_L_event) const
+{
+  auto end = m_writeIndex.load(std::memory_order_acquire);
+  auto begin = end > TRACE_BUFFER_SIZE ? end - TRACE_BUFFER_SIZE : 0;
+  auto first = t_L_event.size();
+  for (auto i = begin;
+       i < end;
+       i++)
+  {
+    t_L_event.append(m_L_event[i & (TRACE_BUFFER_SIZE - 1)]);
+  }
+  // writer went on meanwhile, oldest copied ones may be torn
+  auto after = m_writeIndex.load(std::memory_order_acquire);
+  auto firstValid = after > TRACE_BUFFER_SIZE ? after - TRACE_BUFFER_SIZE : 0;
+  if (firstValid > begin)
+    t_L_event.remove(first,
+                     static_cast<qsizetype>(qMin(firstValid, end) - begin));
+}
+
+/********************************** Tracer *******************************/
+
+Tracer *Tracer::instance()
+{
+  static Tracer inst;
+  return &inst;
+}
+
+Tracer::~Tracer()
+{
+  qDeleteAll(m_L_buffer);
+}
+
+TraceBuffer *Tracer::getThreadBuffer()
+{
+  thread_local TraceBuffer *buffer = nullptr;
+  if (!buffer)
+    buffer = instance()->createThreadBuffer();
+  return buffer;
+}
+
+qint64 Tracer::now()
+{
+  return LatencyStats::instance()->now();
+}
+
+void Tracer::clear()
+{
+  QMutexLocker locker(&m_mutex);
+  for (const auto &item
+       : std::as_const(m_L_buffer))
+  {
+    item->clear();
+  }
+}
+
+TraceBuffer *Tracer::createThreadBuffer()
+{
+  auto thread = QThread::currentThread();
+  QString threadName = thread->objectName();
+  if (threadName.isEmpty())
+  {
+    auto app = QCoreApplication::instance();
+    if (app
+        && app->thread() == thread)
+    {
+      threadName = "main";
+    }
+    else
+    {
+      threadName = thread->metaObject()->className();
+    }
+  }
+  // never deleted before the tracer : thread may be gone but its
+  // events are still to export
+  QMutexLocker locker(&m_mutex);
+  auto buffer = new TraceBuffer(m_L_buffer.size() + 1,
+                                threadName);
+  m_L_buffer.append(buffer);
+  return buffer;
+}
+
+QByteArray Tracer::toChromeJson() const
+{
+  QByteArray json("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  bool isFirst = true;
+  QList<TraceEvent> L_event;
+
+  QMutexLocker locker(&m_mutex);
+  for (const auto &item
+       : std::as_const(m_L_buffer))
+  {
+    auto tid = QByteArray::number(item->getThreadId());
+    auto threadName = item->getThreadName().toUtf8();
+    threadName.replace('\\', "\\\\").replace('"', "\\\"");
+    if (!isFirst)
+      json += ',';
+    isFirst = false;
+    json += "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid
+        + ",\"args\":{\"name\":\"" + threadName + "\"}}";
+
+    L_event.clear();
+    item->copyEvents(L_event);
+    for (const auto &event
+         : std::as_const(L_event))
+    {
+      json += ",\n{\"name\":\"";
+      json += event.m_name;
+      json += "\",\"cat\":\"qontrejour\",\"ph\":\"";
+      json += event.m_phase;
+      json += "\",\"ts\":" + traceTime(event.m_time)
+          + ",\"pid\":1,\"tid\":" + tid;
+      switch (event.m_phase)
+      {
+      case 'X' :
+        json += ",\"dur\":" + traceTime(event.m_value);
+        break;
+      case 'i' :
+        json += ",\"s\":\"t\"";
+        break;
+      case 'C' :
+        json += ",\"args\":{\"value\":" + QByteArray::number(event.m_value) + "}";
+        break;
+      case 'b' :
+      case 'e' :
+        json += ",\"id\":" + QByteArray::number(event.m_value);
+        break;
+      default :
+        break;
+      }
+      json += '}';
+    }
+  }
+  json += "\n]}\n";
+  return json;
+}
+
+bool Tracer::exportChromeJson(const QString &t_fileName) const
+{
+  QFile file(t_fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qWarning() << "can't Tracer::exportChromeJson" << file.errorString();
+    return false;
+  }
+  return file.write(toChromeJson()) != -1;
+}
@@ -0,0 +1,191 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <QList>
+#include <QMutex>
+#include <atomic>
+#include "../qontrejour.h"
+
+// trace points, built with -DQONTREJOUR_TRACE=ON only.
+// TRACE_SCOPE("name") : complete event till end of scope
+// TRACE_INSTANT("name") : one point in time
+// TRACE_COUNTER("name", value) : value track
+// TRACE_ASYNC_BEGIN / END("name", id) : span across calls, a fade
+// Names are string literals, they're kept as pointers.
+// Off at build, a point is nothing. Built in but not started, a
+// point is one relaxed load.
+
+/******************************** TraceEvent *****************************/
+
+struct TraceEvent
+{
+  const char *m_name;
+  qint64 m_time; // ns, LatencyStats clock
+  qint64 m_value; // duration for 'X', value for 'C', id for 'b' 'e'
+  char m_phase; // chrome trace phase
+};
+
+/******************************** TraceBuffer ****************************/
+
+// one per thread, created on its first event. Only that thread
+// writes, the ring overwrites oldest events.
+class TraceBuffer
+{
+
+public :
+
+  TraceBuffer(int t_threadId,
+              const QString &t_threadName);
+
+  ~TraceBuffer(){}
+
+  int getThreadId() const{ return m_threadId; }
+  QString getThreadName() const{ return m_threadName; }
+
+  void addEvent(const char *t_name,
+                char t_phase,
+                qint64 t_time,
+                qint64 t_value = 0)
+  {
+    auto index = m_writeIndex.load(std::memory_order_relaxed);
+    auto &event = m_L_event[index & (TRACE_BUFFER_SIZE - 1)];
+    event.m_name = t_name;
+    event.m_time = t_time;
+    event.m_value = t_value;
+    event.m_phase = t_phase;
+    m_writeIndex.store(index + 1,
+                       std::memory_order_release);
+  }
+
+  // events still in the ring, oldest first. Those the writer
+  // overwrote while copying are dropped
+  void copyEvents(QList<TraceEvent> &t_L_event) const;
+  // from the tracer, while no thread writes
+  void clear(){ m_writeIndex.store(0, std::memory_order_relaxed); }
+
+private :
+
+  int m_threadId;
+  QString m_threadName;
+  std::atomic<quint64> m_writeIndex{0};
+  TraceEvent m_L_event[TRACE_BUFFER_SIZE];
+
+};
+
+/********************************** Tracer *******************************/
+
+class Tracer
+{
+
+public :
+
+  static Tracer *instance();
+
+  ~Tracer();
+
+  static bool isEnabled()
+  { return m_isEnabled.load(std::memory_order_relaxed); }
+  // this thread's ring, created on first call
+  static TraceBuffer *getThreadBuffer();
+  static qint64 now();
+
+  void start(){ m_isEnabled.store(true, std::memory_order_relaxed); }
+  void stop(){ m_isEnabled.store(false, std::memory_order_relaxed); }
+  // stop first, writers may still run
+  void clear();
+
+  // chrome trace event format, opens in perfetto or about:tracing
+  QByteArray toChromeJson() const;
+  bool exportChromeJson(const QString &t_fileName) const;
+
+private :
+
+  Tracer(){}
+
+  TraceBuffer *createThreadBuffer();
+
+private :
+
+  static std::atomic<bool> m_isEnabled;
+
+  mutable QMutex m_mutex;
+  QList<TraceBuffer *> m_L_buffer;
+
+};
+
+/******************************** TraceScope *****************************/
+
+class TraceScope
+{
+
+public :
+
+  explicit TraceScope(const char *t_name)
+    : m_name(Tracer::isEnabled() ? t_name : nullptr),
+      m_startTime(m_name ? Tracer::now() : 0)
+  {}
+
+  ~TraceScope()
+  {
+    if (m_name)
+      Tracer::getThreadBuffer()->addEvent(m_name,
+                                          'X',
+                                          m_startTime,
+                                          Tracer::now() - m_startTime);
+  }
+
+private :
+
+  const char *m_name;
+  qint64 m_startTime;
+
+};
+
+/********************************** macros *******************************/
+
+#ifdef QONTREJOUR_TRACE
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#define TRACE_EVENT_(name, phase, value) \
+  do { \
+    if (Tracer::isEnabled()) \
+      Tracer::getThreadBuffer()->addEvent(name, phase, Tracer::now(), value); \
+  } while (0)
+
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_INSTANT(name) TRACE_EVENT_(name, 'i', 0)
+#define TRACE_COUNTER(name, value) TRACE_EVENT_(name, 'C', static_cast<qint64>(value))
+#define TRACE_ASYNC_BEGIN(name, asyncId) TRACE_EVENT_(name, 'b', static_cast<qint64>(asyncId))
+#define TRACE_ASYNC_END(name, asyncId) TRACE_EVENT_(name, 'e', static_cast<qint64>(asyncId))
+
+#else
+
+#define TRACE_SCOPE(name) do {} while (0)
+#define TRACE_INSTANT(name) do {} while (0)
+#define TRACE_COUNTER(name, value) do {} while (0)
+#define TRACE_ASYNC_BEGIN(name, asyncId) do {} while (0)
+#define TRACE_ASYNC_END(name, asyncId) do {} while (0)
+
+#endif // QONTREJOUR_TRACE
+
+#endif // TRACE_H
@@ -0,0 +1,84 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "valuearena.h"
+#include <QDebug>
+
+/******************************** ShowArena ******************************/
+
+ShowArena *ShowArena::instance()
+{
+  static ShowArena inst;
+  return &inst;
+}
+
+bool ShowArena::isValid(const LeveledValue *t_value) const
+{
+  if (!t_value)
+    return false;
+  auto handle = t_value->getHandle();
+  switch (t_value->getType())
+  {
+  case ValueType::ChannelType :
+    return m_channelArena.get(handle) == t_value;
+  case ValueType::ChannelGroup :
+    return m_groupArena.get(handle) == t_value;
+  case ValueType::Scene0 :
+  case ValueType::MainScene :
+    return m_sceneArena.get(handle) == t_value;
+  case ValueType::SubSceneType :
+    return m_subSceneArena.get(handle) == t_value;
+  default :
+    return false;
+  }
+}
+
+bool ShowArena::destroyValue(LeveledValue *t_value)
+{
+  // a value on the stack or from new has a null handle, but its
+  // slot may be taken by another one
+  if (!isValid(t_value))
+  {
+    qWarning() << "can't ShowArena::destroyValue";
+    return false;
+  }
+  auto handle = t_value->getHandle();
+  switch (t_value->getType())
+  {
+  case ValueType::ChannelType :
+    return m_channelArena.destroy(handle);
+  case ValueType::ChannelGroup :
+    return m_groupArena.destroy(handle);
+  case ValueType::Scene0 :
+  case ValueType::MainScene :
+    return m_sceneArena.destroy(handle);
+  case ValueType::SubSceneType :
+    return m_subSceneArena.destroy(handle);
+  default :
+    return false;
+  }
+}
+
+void ShowArena::clear()
+{
+  // scenes reference channels, they go first
+  m_subSceneArena.clear();
+  m_sceneArena.clear();
+  m_groupArena.clear();
+  m_channelArena.clear();
+}
@@ -0,0 +1,236 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VALUEARENA_H
+#define VALUEARENA_H
+
+#include <QList>
+#include <new>
+#include <utility>
+#include "dmxvalue.h"
+
+/******************************** ValueArena ******************************/
+
+// typed pool for show values. Slots are allocated by chunks of
+// VALUE_ARENA_CHUNK_SIZE and never move, so values keep their address
+// (they are QObjects). A freed slot is reused by the next create(),
+// with a new generation.
+// Values are created without QObject parent and never deleted : only
+// destroy() or clear() end them. Engine thread only.
+template<typename T>
+class ValueArena
+{
+
+public :
+
+  ValueArena(){}
+
+  ~ValueArena()
+  {
+    clear();
+    for (const auto &item
+         : std::as_const(m_L_chunk))
+    {
+      delete[] item;
+    }
+  }
+
+  ValueArena(const ValueArena &) = delete;
+  ValueArena &operator=(const ValueArena &) = delete;
+
+  int getSize() const{ return m_size; }
+  int getCapacity() const{ return m_L_chunk.size() * VALUE_ARENA_CHUNK_SIZE; }
+
+  template<typename... Args>
+  T *create(Args&&... t_args)
+  {
+    quint32 index;
+    if (!m_L_freeIndex.isEmpty())
+    {
+      index = m_L_freeIndex.takeLast();
+    }
+    else
+    {
+      index = m_slotCount++;
+      if (index % VALUE_ARENA_CHUNK_SIZE == 0)
+        m_L_chunk.append(new Slot[VALUE_ARENA_CHUNK_SIZE]);
+    }
+    auto &slot = getSlot(index);
+    auto value = new (slot.m_storage) T(std::forward<Args>(t_args)...);
+    Q_ASSERT(!value->parent());
+    slot.m_isAlive = true;
+    value->setHandle(ValueHandle(index,
+                                 slot.m_generation));
+    m_size++;
+    return value;
+  }
+
+  bool isValid(ValueHandle t_handle) const
+  {
+    if (t_handle.getIndex() >= m_slotCount)
+      return false;
+    const auto &slot = getSlot(t_handle.getIndex());
+    return slot.m_isAlive
+           && slot.m_generation == t_handle.getGeneration();
+  }
+
+  // nullptr if destroyed since
+  T *get(ValueHandle t_handle) const
+  {
+    if (!isValid(t_handle))
+      return nullptr;
+    return getValue(t_handle.getIndex());
+  }
+
+  bool destroy(ValueHandle t_handle)
+  {
+    if (!isValid(t_handle))
+      return false;
+    auto index = t_handle.getIndex();
+    auto &slot = getSlot(index);
+    // stale before destroyed() is emitted
+    slot.m_isAlive = false;
+    slot.m_generation++;
+    getValue(index)->~T();
+    m_L_freeIndex.append(index);
+    m_size--;
+    return true;
+  }
+
+  // live values in slot order, chunk after chunk
+  template<typename Function>
+  void forEach(Function t_function) const
+  {
+    for (quint32 i = 0;
+         i < m_slotCount;
+         i++)
+    {
+      if (getSlot(i).m_isAlive)
+        t_function(getValue(i));
+    }
+  }
+
+  // show closed or reloaded : every value at once, chunks are kept
+  // for the next show. Lowest slots are reused first
+  void clear()
+  {
+    for (quint32 i = 0;
+         i < m_slotCount;
+         i++)
+    {
+      auto &slot = getSlot(i);
+      if (!slot.m_isAlive)
+        continue;
+      slot.m_isAlive = false;
+      slot.m_generation++;
+      getValue(i)->~T();
+    }
+    m_L_freeIndex.clear();
+    m_L_freeIndex.reserve(m_slotCount);
+    for (quint32 i = m_slotCount;
+         i > 0;
+         i--)
+    {
+      m_L_freeIndex.append(i - 1);
+    }
+    m_size = 0;
+  }
+
+private :
+
+  struct Slot
+  {
+    alignas(T) unsigned char m_storage[sizeof(T)];
+    quint32 m_generation = 0;
+    bool m_isAlive = false;
+  };
+
+  Slot &getSlot(quint32 t_index) const
+  { return m_L_chunk.at(t_index / VALUE_ARENA_CHUNK_SIZE)
+        [t_index % VALUE_ARENA_CHUNK_SIZE]; }
+  T *getValue(quint32 t_index) const
+  { return std::launder(reinterpret_cast<T *>(getSlot(t_index).m_storage)); }
+
+private :
+
+  QList<Slot *> m_L_chunk;
+  QList<quint32> m_L_freeIndex;
+  quint32 m_slotCount = 0; // slots ever used
+  int m_size = 0; // live values
+
+};
+
+/******************************** ShowArena ******************************/
+
+// channels, groups, scenes and sub scenes of the show. Sequences keep
+// handles in step order : scenes are destroyed one by one on record
+// over or delete. Roots, groups and sub scenes keep pointers : channels
+// and groups only go all together with clear(), roots also hold the
+// outputs, which aren't in an arena.
+class ShowArena
+{
+
+public :
+
+  static ShowArena *instance();
+
+  ~ShowArena(){}
+
+  ValueArena<DmxChannel> *getChannelArena(){ return &m_channelArena; }
+  ValueArena<DmxChannelGroup> *getGroupArena(){ return &m_groupArena; }
+  ValueArena<DmxScene> *getSceneArena(){ return &m_sceneArena; }
+  ValueArena<SubScene> *getSubSceneArena(){ return &m_subSceneArena; }
+
+  DmxChannel *createChannel(){ return m_channelArena.create(); }
+  DmxChannelGroup *createChannelGroup()
+  { return m_groupArena.create(ValueType::ChannelGroup); }
+  DmxScene *createScene(ValueType t_type = ValueType::MainScene)
+  { return m_sceneArena.create(t_type); }
+  SubScene *createSubScene(DmxScene *t_parentScene)
+  { return m_subSceneArena.create(ValueType::SubSceneType,
+                                  t_parentScene); }
+
+  // arena from the value type, false if not from an arena or stale
+  bool isValid(const LeveledValue *t_value) const;
+  bool destroyValue(LeveledValue *t_value);
+  // close the show, outputs and roots are left
+  void clear();
+
+  // bumped when group or cue members, or the selected cue, change.
+  // Published with snapshots, views read members again on change
+  quint64 getMemberRevision() const{ return m_memberRevision; }
+  void bumpMemberRevision(){ m_memberRevision++; }
+
+private :
+
+  ShowArena(){}
+
+  ShowArena(const ShowArena &) = delete;
+  ShowArena &operator=(const ShowArena &) = delete;
+
+private :
+
+  ValueArena<DmxChannel> m_channelArena;
+  ValueArena<DmxChannelGroup> m_groupArena;
+  ValueArena<DmxScene> m_sceneArena;
+  ValueArena<SubScene> m_subSceneArena;
+  quint64 m_memberRevision = 0;
+
+};
+
+#endif // VALUEARENA_H
@@ -0,0 +1,49 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "virtualclock.h"
+#include <QCoreApplication>
+#include <QDebug>
+
+/*************************** VirtualAnimationDriver **********************/
+
+VirtualAnimationDriver::VirtualAnimationDriver(QObject *parent)
+  : QAnimationDriver(parent)
+{}
+
+VirtualAnimationDriver::~VirtualAnimationDriver()
+{}
+
+void VirtualAnimationDriver::advanceTo(qint64 t_elapsed)
+{
+  if (t_elapsed < m_elapsed)
+  {
+    qWarning() << "can't VirtualAnimationDriver::advanceTo" << t_elapsed;
+    return;
+  }
+  m_elapsed = t_elapsed;
+  // animations started since last call register through queued
+  // calls, which may start the driver at t_elapsed
+  QCoreApplication::sendPostedEvents();
+  advance();
+}
+
+void VirtualAnimationDriver::start()
+{
+  m_startTime = m_elapsed;
+  QAnimationDriver::start();
+}
@@ -0,0 +1,60 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VIRTUALCLOCK_H
+#define VIRTUALCLOCK_H
+
+#include <QAnimationDriver>
+#include "../qontrejour.h"
+
+/*************************** VirtualAnimationDriver **********************/
+
+// drives every animation of the thread (cue fades...) from a
+// clock we advance ourselves, not the wall clock. Once installed,
+// fades only move on advanceTo() : offline render, tests.
+class VirtualAnimationDriver
+    : public QAnimationDriver
+{
+
+  Q_OBJECT
+
+public :
+
+  explicit VirtualAnimationDriver(QObject *parent = nullptr);
+
+  ~VirtualAnimationDriver();
+
+  // ms, since the driver was started, like the default driver
+  qint64 elapsed() const override{ return m_elapsed - m_startTime; }
+  qint64 getTime() const{ return m_elapsed; }
+
+  // animations are updated at t_elapsed, ms. Animations started
+  // before the call start at t_elapsed. Time never goes back
+  void advanceTo(qint64 t_elapsed);
+
+protected :
+
+  void start() override;
+
+private :
+
+  qint64 m_elapsed = 0;
+  qint64 m_startTime = 0;
+
+};
+
+#endif // VIRTUALCLOCK_H
@@ -0,0 +1,194 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "watchdog.h"
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QDebug>
+
+/********************************* Heartbeat *****************************/
+
+Heartbeat::Heartbeat(const char *t_name)
+  : m_name(t_name)
+{
+  m_lastBeat.store(LatencyStats::instance()->now(),
+                   std::memory_order_relaxed);
+}
+
+void Heartbeat::beat()
+{
+  auto now = LatencyStats::instance()->now();
+  auto lastBeat = m_lastBeat.exchange(now,
+                                      std::memory_order_relaxed);
+  // only the watched thread beats, no need to compare exchange
+  if (now - lastBeat > m_maxGap.load(std::memory_order_relaxed))
+    m_maxGap.store(now - lastBeat,
+                   std::memory_order_relaxed);
+  m_beatCount.fetch_add(1,
+                        std::memory_order_relaxed);
+}
+
+/******************************* StallWatchdog ***************************/
+
+StallWatchdog::StallWatchdog(QObject *parent)
+  : QThread(parent)
+{}
+
+StallWatchdog::~StallWatchdog()
+{
+  stop();
+}
+
+QList<StallEvent> StallWatchdog::getL_stallEvent() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_L_stallEvent;
+}
+
+void StallWatchdog::addHeartbeat(Heartbeat *t_heartbeat)
+{
+  if (!t_heartbeat)
+  {
+    qWarning() << "can't StallWatchdog::addHeartbeat";
+    return;
+  }
+  QMutexLocker locker(&m_mutex);
+  if (m_L_heartbeat.contains(t_heartbeat))
+    return;
+  // it was maybe not beaten for long, don't flag it now
+  t_heartbeat->beat();
+  t_heartbeat->takeMaxGap();
+  m_L_heartbeat.append(t_heartbeat);
+  m_L_isStalled.append(false);
+}
+
+void StallWatchdog::removeHeartbeat(Heartbeat *t_heartbeat)
+{
+  QMutexLocker locker(&m_mutex);
+  auto index = m_L_heartbeat.indexOf(t_heartbeat);
+  if (index == -1)
+    return;
+  m_L_heartbeat.removeAt(index);
+  m_L_isStalled.removeAt(index);
+}
+
+void StallWatchdog::resetStats()
+{
+  QMutexLocker locker(&m_mutex);
+  m_L_stallEvent.clear();
+  m_stallCount.store(0,
+                     std::memory_order_relaxed);
+  m_stallHistogram.reset();
+}
+
+QString StallWatchdog::dump() const
+{
+  QString text;
+  QTextStream stream(&text);
+  stream << LatencyStats::getHistogramLine("stall",
+                                           m_stallHistogram);
+  const auto L_stallEvent = getL_stallEvent();
+  for (const auto &item
+       : L_stallEvent)
+  {
+    stream << item.m_name
+           << " at " << item.m_startTime / 1000000
+           << " ms, beat " << item.m_beatCount
+           << ", " << item.m_activity;
+    if (item.m_duration)
+      stream << ", " << item.m_duration / 1000000 << " ms";
+    else
+      stream << ", still stalled";
+    stream << "\n";
+  }
+  return text;
+}
+
+void StallWatchdog::stop()
+{
+  requestInterruption();
+  if (isRunning())
+    wait();
+}
+
+void StallWatchdog::run()
+{
+  auto latencyStats = LatencyStats::instance();
+  while (!isInterruptionRequested())
+  {
+    QThread::msleep(WATCHDOG_POLL_INTERVAL);
+
+    auto now = latencyStats->now();
+    qint64 thresholdNs = static_cast<qint64>(getThreshold()) * 1000000;
+    QMutexLocker locker(&m_mutex);
+    for (qsizetype i = 0;
+         i < m_L_heartbeat.size();
+         i++)
+    {
+      auto heartbeat = m_L_heartbeat.at(i);
+      auto lastBeat = heartbeat->getLastBeat();
+      if (now - lastBeat > thresholdNs)
+      {
+        if (m_L_isStalled.at(i))
+          continue;
+        // still stuck in there, warn now : the stalled thread
+        // may never come back
+        m_L_isStalled[i] = true;
+        StallEvent stallEvent;
+        stallEvent.m_name = heartbeat->getName();
+        stallEvent.m_activity = heartbeat->getActivity();
+        stallEvent.m_startTime = lastBeat;
+        stallEvent.m_beatCount = heartbeat->getBeatCount();
+        addStallEvent(stallEvent);
+        m_stallCount.fetch_add(1,
+                               std::memory_order_relaxed);
+        qWarning() << "stall in" << stallEvent.m_name
+                   << "thread, no heartbeat for" << (now - lastBeat) / 1000000
+                   << "ms, during" << stallEvent.m_activity;
+      }
+      else if (m_L_isStalled.at(i))
+      {
+        m_L_isStalled[i] = false;
+        auto duration = heartbeat->takeMaxGap();
+        m_stallHistogram.addSample(duration);
+        // last event of this heartbeat is the one ending
+        for (qsizetype j = m_L_stallEvent.size() - 1;
+             j >= 0;
+             j--)
+        {
+          auto &stallEvent = m_L_stallEvent[j];
+          if (stallEvent.m_name == heartbeat->getName())
+          {
+            if (!stallEvent.m_duration)
+              stallEvent.m_duration = duration;
+            break;
+          }
+        }
+        qWarning() << "stall in" << heartbeat->getName()
+                   << "thread ended after" << duration / 1000000 << "ms";
+      }
+    }
+  }
+}
+
+void StallWatchdog::addStallEvent(const StallEvent &t_stallEvent)
+{
+  // m_mutex is locked
+  if (m_L_stallEvent.size() >= WATCHDOG_STALL_EVENT_MAX)
+    m_L_stallEvent.removeFirst();
+  m_L_stallEvent.append(t_stallEvent);
+}
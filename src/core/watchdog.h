@@ -0,0 +1,154 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <QThread>
+#include <QMutex>
+#include <QList>
+#include <QString>
+#include <atomic>
+#include "../qontrejour.h"
+#include "latencystats.h"
+
+/********************************* Heartbeat *****************************/
+
+// beaten by a watched thread at each loop (engine tick, gui timer).
+// The thread also says what it's doing, so a stall shows where it
+// was stuck. Activities are string literals, never freed.
+class Heartbeat
+{
+
+public :
+
+  explicit Heartbeat(const char *t_name);
+
+  ~Heartbeat(){}
+
+  const char *getName() const{ return m_name; }
+  qint64 getLastBeat() const{ return m_lastBeat.load(std::memory_order_relaxed); }
+  quint64 getBeatCount() const{ return m_beatCount.load(std::memory_order_relaxed); }
+  const char *getActivity() const{ return m_activity.load(std::memory_order_relaxed); }
+
+  void beat();
+  // ns, longest time between two beats since last call
+  qint64 takeMaxGap(){ return m_maxGap.exchange(0, std::memory_order_relaxed); }
+  // returns previous activity
+  const char *setActivity(const char *t_activity)
+  { return m_activity.exchange(t_activity, std::memory_order_relaxed); }
+
+private :
+
+  const char *m_name;
+  std::atomic<qint64> m_lastBeat{0};
+  std::atomic<qint64> m_maxGap{0};
+  std::atomic<quint64> m_beatCount{0};
+  std::atomic<const char *> m_activity{"idle"};
+
+};
+
+// activity for the scope, previous one back after
+class HeartbeatActivity
+{
+
+public :
+
+  HeartbeatActivity(Heartbeat *t_heartbeat,
+                    const char *t_activity)
+    : m_heartbeat(t_heartbeat),
+      m_previousActivity(t_heartbeat->setActivity(t_activity))
+  {}
+
+  ~HeartbeatActivity(){ m_heartbeat->setActivity(m_previousActivity); }
+
+private :
+
+  Heartbeat *m_heartbeat;
+  const char *m_previousActivity;
+
+};
+
+/******************************** StallEvent *****************************/
+
+struct StallEvent
+{
+  const char *m_name = nullptr; // heartbeat
+  const char *m_activity = nullptr; // when the stall was seen
+  qint64 m_startTime = 0; // ns, LatencyStats clock, last beat before
+  qint64 m_duration = 0; // ns, 0 while still stalled
+  quint64 m_beatCount = 0; // beats before the stall
+};
+
+/******************************* StallWatchdog ***************************/
+
+// own thread, polls heartbeats every WATCHDOG_POLL_INTERVAL and
+// flags the ones silent for longer than the threshold. Warns as soon
+// as the stall is seen, from its own thread, and again with the
+// duration when the thread beats again.
+class StallWatchdog
+    : public QThread
+{
+
+  Q_OBJECT
+
+public :
+
+  explicit StallWatchdog(QObject *parent = nullptr);
+
+  ~StallWatchdog();
+
+  int getThreshold() const{ return m_threshold.load(std::memory_order_relaxed); }
+  quint64 getStallCount() const{ return m_stallCount.load(std::memory_order_relaxed); }
+  const LatencyHistogram &getStallHistogram() const{ return m_stallHistogram; }
+  // last WATCHDOG_STALL_EVENT_MAX stalls, oldest first
+  QList<StallEvent> getL_stallEvent() const;
+
+  // ms
+  void setThreshold(int t_threshold)
+  { m_threshold.store(t_threshold, std::memory_order_relaxed); }
+  // heartbeats must outlive the watchdog or be removed first
+  void addHeartbeat(Heartbeat *t_heartbeat);
+  void removeHeartbeat(Heartbeat *t_heartbeat);
+  void resetStats();
+  // stall durations line like LatencyStats::dump(), then last stalls
+  QString dump() const;
+
+  void stop();
+
+protected :
+
+  void run() override;
+
+private :
+
+  void addStallEvent(const StallEvent &t_stallEvent);
+
+private :
+
+  mutable QMutex m_mutex;
+  QList<Heartbeat *> m_L_heartbeat;
+  QList<bool> m_L_isStalled; // by heartbeat, watchdog thread side
+  QList<StallEvent> m_L_stallEvent;
+
+  std::atomic<int> m_threshold{WATCHDOG_STALL_THRESHOLD_DEFAULT};
+  std::atomic<quint64> m_stallCount{0};
+  LatencyHistogram m_stallHistogram;
+
+};
+
+#endif // WATCHDOG_H
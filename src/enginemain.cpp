@@ -0,0 +1,132 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// qontrejour-engine : same core as Qontrejour, no gui.
+// Controlled over osc (/chan, /group, /seq, /key), outputs to
+// Art-Net and / or sACN.
+
+#include "core/dmxmanager.h"
+#include "core/networkoutput.h"
+#include "core/oscserver.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLoggingCategory>
+#include <QHostAddress>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#endif
+
+// threads created afterwards (output, input, midi) inherit the mask,
+// call before anything starts
+static bool pinToCpu(int t_cpu)
+{
+#ifdef Q_OS_LINUX
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  CPU_SET(t_cpu, &cpuSet);
+  if (sched_setaffinity(0,
+                        sizeof(cpuSet),
+                        &cpuSet) == 0)
+  {
+    return true;
+  }
+#else
+  Q_UNUSED(t_cpu)
+#endif
+  qWarning() << "can't pinToCpu" << t_cpu;
+  return false;
+}
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication a(argc, argv);
+  QCoreApplication::setApplicationName("qontrejour-engine");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Qontrejour engine without gui");
+  parser.addHelpOption();
+
+  QCommandLineOption oscPortOption("osc-port",
+                                   "Osc control port.",
+                                   "port",
+                                   QString::number(OSC_PORT_DEFAULT));
+  QCommandLineOption artNetOption("artnet",
+                                  "Art-Net output to broadcast address.",
+                                  "address");
+  QCommandLineOption sacnOption("sacn",
+                                "sACN output.");
+  QCommandLineOption inputOption("input",
+                                 "Art-Net and sACN input, universe count.",
+                                 "count");
+  QCommandLineOption midiOption("midi",
+                                "Alsa midi input.");
+  QCommandLineOption refreshRateOption("refresh-rate",
+                                       "Output refresh rate.",
+                                       "Hz",
+                                       QString::number(OUTPUT_REFRESH_RATE_DEFAULT));
+  QCommandLineOption cpuOption("cpu",
+                               "Run engine and output threads on this cpu.",
+                               "cpu");
+  parser.addOption(oscPortOption);
+  parser.addOption(artNetOption);
+  parser.addOption(sacnOption);
+  parser.addOption(inputOption);
+  parser.addOption(midiOption);
+  parser.addOption(refreshRateOption);
+  parser.addOption(cpuOption);
+  parser.process(a);
+
+  // interpreter and engine debug output, nobody reads it on a server
+  QLoggingCategory::setFilterRules("default.debug=false");
+
+  if (parser.isSet(cpuOption))
+    pinToCpu(parser.value(cpuOption).toInt());
+
+  auto manager = MANAGER;
+  // nobody looks at channel views here
+  manager->getDmxEngine()->getSnapshotPublisher()->stop();
+  // after the publisher stops, its timer moves with the engine
+  manager->startEngineThread();
+
+  manager->getOutputThread()
+      ->setRefreshRate(parser.value(refreshRateOption).toInt());
+  if (parser.isSet(artNetOption))
+  {
+    manager->addOutputSink(new ArtNetOutputSink(
+        QHostAddress(parser.value(artNetOption))));
+  }
+  if (parser.isSet(sacnOption))
+    manager->addOutputSink(new SacnOutputSink());
+
+  if (parser.isSet(inputOption))
+    manager->startNetworkInput(parser.value(inputOption).toInt());
+  if (parser.isSet(midiOption))
+    manager->startMidiInput();
+
+  manager->startStallWatchdog();
+
+  if (!manager->startOscServer(parser.value(oscPortOption).toUShort()))
+  {
+    qWarning() << "can't start osc server";
+    return 1;
+  }
+
+  return a.exec();
+}
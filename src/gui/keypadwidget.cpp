@@ -40,7 +40,8 @@ PushButton::PushButton(const QString &text,
 /************************ KeypadWidget *****************************/
 
 KeypadWidget::KeypadWidget(QWidget *parent)
-    : QWidget{parent}
+    : QWidget{parent},
+    m_commandLineEdit(new QLineEdit(this))
 {
   populateWidget();
 }
@@ -237,6 +238,16 @@ void KeypadWidget::populateWidget()
   connect(moinsButton, &PushButton::clicked, [=]
           { emit buttonClicked(KeypadButton::Moins); });
 
+  /**********************************************/
+
+  m_commandLineEdit->setPlaceholderText("1 thru 48 @ 75");
+  layout->addWidget(m_commandLineEdit, 6, 0, 1, 6);
+  connect(m_commandLineEdit, &QLineEdit::returnPressed, [=]
+          {
+            emit commandEntered(m_commandLineEdit->text());
+            m_commandLineEdit->clear();
+          });
+
   setLayout(layout);
   layout->setSizeConstraint(QLayout::SetMaximumSize);
 }
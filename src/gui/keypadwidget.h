@@ -22,6 +22,7 @@
 #include <QPushButton>
 #include <QSlider>
 #include <QLabel>
+#include <QLineEdit>
 #include "../qontrejour.h"
 #include "../core/dmxmanager.h"
 
@@ -57,6 +58,12 @@ private :
 signals:
 
   void buttonClicked(KeypadButton buttonType);
+  // text command line, "1 thru 48 @ 75"
+  void commandEntered(const QString &t_command);
+
+private :
+
+  QLineEdit *m_commandLineEdit;
 };
 
 /****************************************************************/
@@ -0,0 +1,214 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "latencystatswidget.h"
+#include <QHeaderView>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QFileDialog>
+#include <QFile>
+#include <QDebug>
+#include "../core/latencystats.h"
+#include "../core/outputthread.h"
+#include "../core/watchdog.h"
+#include "../core/trace.h"
+
+// rows after the stages
+#define JITTER_ROW UnknownLatencyStage
+#define STALL_ROW (UnknownLatencyStage + 1)
+#define ROW_COUNT (UnknownLatencyStage + 2)
+
+/*************************** LatencyStatsWidget *************************/
+
+LatencyStatsWidget::LatencyStatsWidget(OutputThread *t_outputThread,
+                                       StallWatchdog *t_stallWatchdog,
+                                       QWidget *parent)
+  : QWidget(parent),
+    m_outputThread(t_outputThread),
+    m_stallWatchdog(t_stallWatchdog),
+    m_tableWidget(new QTableWidget(ROW_COUNT, 6, this)),
+    m_frameLabel(new QLabel(this)),
+    m_stallLabel(new QLabel(this)),
+    m_resetButton(new QPushButton(tr("Reset"), this)),
+    m_dumpButton(new QPushButton(tr("Dump"), this)),
+    m_traceButton(new QPushButton(tr("Trace"), this)),
+    m_timer(new QTimer(this))
+{
+  m_tableWidget->setHorizontalHeaderLabels(QStringList()
+                                           << "count" << "p50 µs" << "p90 µs"
+                                           << "p99 µs" << "max µs" << "avg µs");
+  QStringList L_stageName;
+  for (int i = 0;
+       i < UnknownLatencyStage;
+       i++)
+  {
+    L_stageName << LatencyStats::getStageName(static_cast<LatencyStage>(i));
+  }
+  L_stageName << "jitter" << "stall";
+  for (int i = 0;
+       i < ROW_COUNT;
+       i++)
+  {
+    for (int j = 0;
+         j < m_tableWidget->columnCount();
+         j++)
+    {
+      auto item = new QTableWidgetItem();
+      item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      item->setFlags(Qt::ItemIsEnabled);
+      m_tableWidget->setItem(i, j, item);
+    }
+  }
+  m_tableWidget->setVerticalHeaderLabels(L_stageName);
+  m_tableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+  m_tableWidget->setSelectionMode(QAbstractItemView::NoSelection);
+
+  auto buttonLayout = new QHBoxLayout();
+  buttonLayout->addWidget(m_frameLabel);
+  buttonLayout->addStretch();
+  buttonLayout->addWidget(m_resetButton);
+  buttonLayout->addWidget(m_dumpButton);
+  buttonLayout->addWidget(m_traceButton);
+  m_traceButton->setCheckable(true);
+#ifndef QONTREJOUR_TRACE
+  // no trace point in this build
+  m_traceButton->hide();
+#endif
+  auto layout = new QVBoxLayout();
+  layout->addWidget(m_tableWidget);
+  layout->addWidget(m_stallLabel);
+  layout->addLayout(buttonLayout);
+  setLayout(layout);
+
+  connect(m_resetButton,
+          SIGNAL(clicked()),
+          this,
+          SLOT(onResetClicked()));
+  connect(m_dumpButton,
+          SIGNAL(clicked()),
+          this,
+          SLOT(onDumpClicked()));
+  connect(m_traceButton,
+          SIGNAL(toggled(bool)),
+          this,
+          SLOT(onTraceToggled(bool)));
+  connect(m_timer,
+          SIGNAL(timeout()),
+          this,
+          SLOT(onTimeout()));
+  m_timer->start(LATENCY_STATS_REFRESH_INTERVAL);
+  onTimeout();
+}
+
+LatencyStatsWidget::~LatencyStatsWidget()
+{}
+
+void LatencyStatsWidget::onTimeout()
+{
+  // hidden dock, nothing to do
+  if (!isVisible())
+    return;
+
+  auto latencyStats = LatencyStats::instance();
+  for (int i = 0;
+       i < UnknownLatencyStage;
+       i++)
+  {
+    setRow(i,
+           latencyStats->getHistogram(static_cast<LatencyStage>(i)));
+  }
+  setRow(JITTER_ROW,
+         m_outputThread->getJitterHistogram());
+  setRow(STALL_ROW,
+         m_stallWatchdog->getStallHistogram());
+
+  // what "below a frame" means
+  m_frameLabel->setText(tr("frame : %1 µs, missed %2 / %3")
+                            .arg(1000000 / m_outputThread->getRefreshRate())
+                            .arg(m_outputThread->getMissedFrameCount())
+                            .arg(m_outputThread->getFrameCount()));
+
+  const auto L_stallEvent = m_stallWatchdog->getL_stallEvent();
+  if (L_stallEvent.isEmpty())
+  {
+    m_stallLabel->setText(tr("no stall"));
+  }
+  else
+  {
+    const auto &stallEvent = L_stallEvent.last();
+    m_stallLabel->setText(tr("stalls : %1, last in %2 during %3")
+                              .arg(m_stallWatchdog->getStallCount())
+                              .arg(QString::fromLatin1(stallEvent.m_name),
+                                   QString::fromLatin1(stallEvent.m_activity)));
+  }
+}
+
+void LatencyStatsWidget::setRow(int t_row,
+                                const LatencyHistogram &t_histogram)
+{
+  m_tableWidget->item(t_row, 0)->setText(QString::number(t_histogram.getCount()));
+  m_tableWidget->item(t_row, 1)->setText(QString::number(t_histogram.getPercentile(50) / 1000));
+  m_tableWidget->item(t_row, 2)->setText(QString::number(t_histogram.getPercentile(90) / 1000));
+  m_tableWidget->item(t_row, 3)->setText(QString::number(t_histogram.getPercentile(99) / 1000));
+  m_tableWidget->item(t_row, 4)->setText(QString::number(t_histogram.getMax() / 1000));
+  m_tableWidget->item(t_row, 5)->setText(QString::number(t_histogram.getAverage() / 1000));
+}
+
+void LatencyStatsWidget::onResetClicked()
+{
+  LatencyStats::instance()->reset();
+  m_outputThread->resetFrameStats();
+  m_stallWatchdog->resetStats();
+  onTimeout();
+}
+
+void LatencyStatsWidget::onDumpClicked()
+{
+  auto fileName = QFileDialog::getSaveFileName(this,
+                                               tr("Dump latency"),
+                                               "latency.txt");
+  if (fileName.isEmpty())
+    return;
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+  {
+    qWarning() << "can't LatencyStatsWidget::onDumpClicked" << file.errorString();
+    return;
+  }
+  file.write(LatencyStats::instance()->dump().toUtf8());
+  file.write(m_outputThread->dumpFrameStats().toUtf8());
+  file.write(m_stallWatchdog->dump().toUtf8());
+}
+
+void LatencyStatsWidget::onTraceToggled(bool t_isChecked)
+{
+  auto tracer = Tracer::instance();
+  if (t_isChecked)
+  {
+    tracer->clear();
+    tracer->start();
+    return;
+  }
+  tracer->stop();
+  auto fileName = QFileDialog::getSaveFileName(this,
+                                               tr("Save trace"),
+                                               TRACE_FILE_DEFAULT,
+                                               tr("Chrome trace (*.json)"));
+  if (fileName.isEmpty())
+    return;
+  tracer->exportChromeJson(fileName);
+}
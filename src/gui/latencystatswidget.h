@@ -0,0 +1,77 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LATENCYSTATSWIDGET_H
+#define LATENCYSTATSWIDGET_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QLabel>
+#include <QTimer>
+#include "../qontrejour.h"
+
+class OutputThread;
+class StallWatchdog;
+class LatencyHistogram;
+
+/*************************** LatencyStatsWidget *************************/
+
+// per stage latency from input to output, read from LatencyStats
+// at LATENCY_STATS_REFRESH_INTERVAL, then output frame jitter and
+// engine / gui stall durations. Dump writes the same tables as text.
+class LatencyStatsWidget
+    : public QWidget
+{
+
+  Q_OBJECT
+
+public :
+
+  explicit LatencyStatsWidget(OutputThread *t_outputThread,
+                              StallWatchdog *t_stallWatchdog,
+                              QWidget *parent = nullptr);
+
+  virtual ~LatencyStatsWidget();
+
+private :
+
+  void setRow(int t_row,
+              const LatencyHistogram &t_histogram);
+
+private slots :
+
+  void onTimeout();
+  void onResetClicked();
+  void onDumpClicked();
+  void onTraceToggled(bool t_isChecked);
+
+private :
+
+  OutputThread *m_outputThread;
+  StallWatchdog *m_stallWatchdog;
+  QTableWidget *m_tableWidget;
+  QLabel *m_frameLabel;
+  QLabel *m_stallLabel;
+  QPushButton *m_resetButton;
+  QPushButton *m_dumpButton;
+  QPushButton *m_traceButton;
+  QTimer *m_timer;
+
+};
+
+#endif // LATENCYSTATSWIDGET_H
@@ -18,24 +18,40 @@
 #include "mainwindow.h"
 #include <QDebug>
 #include <QDockWidget>
+#include <QScrollArea>
 #include "../core/dmxmanager.h"
 #include "../gui/keypadwidget.h"
+#include "../gui/outputmonitorwidget.h"
+#include "../gui/latencystatswidget.h"
 
 
 MainWindow::MainWindow(QWidget *parent)
   : QMainWindow(parent),
     m_channelTableWidget(new ValueTableWidget(this)),
     m_directChannelWidget(new DirectChannelWidget(this)),
-    m_universeWidgetContainerLayout(new QVBoxLayout())
+    m_universeWidgetContainerLayout(new QVBoxLayout()),
+    m_heartbeatTimer(new QTimer(this))
 {
-  MANAGER;
+  auto manager = MANAGER;
+  // before widgets connect to the engine and its values
+  manager->startEngineThread();
 
   createCentralWidget();
   createDockWidgets();
+
+  connect(m_heartbeatTimer,
+          SIGNAL(timeout()),
+          this,
+          SLOT(onHeartbeatTimeout()));
+  m_heartbeatTimer->start(GUI_REFRESH_INTERVAL);
+  manager->startStallWatchdog();
+  manager->getStallWatchdog()->addHeartbeat(&m_heartbeat);
 }
 
 MainWindow::~MainWindow()
-{}
+{
+  MANAGER->getStallWatchdog()->removeHeartbeat(&m_heartbeat);
+}
 
 void MainWindow::createCentralWidget()
 {
@@ -105,6 +121,10 @@ void MainWindow::createDockWidgets()
           SIGNAL(buttonClicked(KeypadButton)),
           manager,
           SLOT(keypadToInterpreter(KeypadButton)));
+  connect(keypadWidget,
+          SIGNAL(commandEntered(QString)),
+          manager,
+          SLOT(commandToInterpreter(QString)));
 
   auto grandMasterWidget = new GrandMasterWidget(this);
   auto playbackWidget = new PlaybackWidget(this);
@@ -126,6 +146,31 @@ void MainWindow::createDockWidgets()
   addDockWidget(Qt::RightDockWidgetArea, rightDock);
 
 
+  // monitor frames come from the output thread, with or without sink
+  manager->startOutputThread();
+  auto outputMonitorWidget = new OutputMonitorWidget(manager->getOutputThread(),
+                                                     this);
+  auto outputMonitorScrollArea = new QScrollArea(this);
+  outputMonitorScrollArea->setWidgetResizable(true);
+  outputMonitorScrollArea->setWidget(outputMonitorWidget);
+
+  auto leftDock = new QDockWidget(tr("Output"), this);
+  leftDock->setAllowedAreas(Qt::LeftDockWidgetArea);
+  leftDock->setWidget(outputMonitorScrollArea);
+  leftDock->setFeatures(QDockWidget::DockWidgetFloatable);
+  addDockWidget(Qt::LeftDockWidgetArea, leftDock);
+
+  auto latencyStatsWidget = new LatencyStatsWidget(manager->getOutputThread(),
+                                                   manager->getStallWatchdog(),
+                                                   this);
+  auto latencyDock = new QDockWidget(tr("Latency"), this);
+  latencyDock->setAllowedAreas(Qt::LeftDockWidgetArea);
+  latencyDock->setWidget(latencyStatsWidget);
+  latencyDock->setFeatures(QDockWidget::DockWidgetFloatable);
+  addDockWidget(Qt::LeftDockWidgetArea, latencyDock);
+  tabifyDockWidget(leftDock, latencyDock);
+  leftDock->raise();
+
   setCorner(Qt::TopLeftCorner, Qt::LeftDockWidgetArea);
   setCorner(Qt::BottomLeftCorner, Qt::LeftDockWidgetArea);
   setCorner(Qt::TopRightCorner, Qt::RightDockWidgetArea);
@@ -154,3 +199,8 @@ void MainWindow::removeUniverseWidget()
     // ou bien faire un slot qui réagit à un signal du manager ?
   }
 }
+
+void MainWindow::onHeartbeatTimeout()
+{
+  m_heartbeat.beat();
+}
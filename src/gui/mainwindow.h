@@ -21,6 +21,8 @@
 #include <QMainWindow>
 #include <QList>
 #include <QPushButton>
+#include <QTimer>
+#include "../core/watchdog.h"
 #include "universewidget.h"
 #include "sequencerwidget.h"
 #include "valuesliderswidget.h"
@@ -49,6 +51,7 @@ private slots :
 
   void addUniverseWidget();
   void removeUniverseWidget();
+  void onHeartbeatTimeout();
 
 private :
 
@@ -58,5 +61,9 @@ private :
 
   ValueTableWidget *m_channelTableWidget;
 
+  // gui thread stalls, watched by the manager stall watchdog
+  Heartbeat m_heartbeat{"gui"};
+  QTimer *m_heartbeatTimer;
+
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,193 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "outputmonitorwidget.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QColor>
+#include <QDebug>
+#include <cstring>
+#include "../core/outputthread.h"
+
+/************************* OutputMonitorWidget **************************/
+
+OutputMonitorWidget::OutputMonitorWidget(OutputThread *t_outputThread,
+                                         QWidget *parent)
+  : QWidget(parent),
+    m_outputThread(t_outputThread),
+    m_timer(new QTimer(this))
+{
+  // black, orange at 2/3, white at full
+  QColor orange(ORANGE_COLOR);
+  for (int i = 0;
+       i <= MAX_DMX;
+       i++)
+  {
+    if (i < 170)
+    {
+      m_L_colorTable.append(qRgb(orange.red() * i / 170,
+                                 orange.green() * i / 170,
+                                 orange.blue() * i / 170));
+    }
+    else
+    {
+      auto ratio = i - 170;
+      m_L_colorTable.append(qRgb(orange.red() + (255 - orange.red()) * ratio / 85,
+                                 orange.green() + (255 - orange.green()) * ratio / 85,
+                                 orange.blue() + (255 - orange.blue()) * ratio / 85));
+    }
+  }
+
+  setAttribute(Qt::WA_OpaquePaintEvent);
+  setMinimumWidth(OUTPUT_MONITOR_TILE_WIDTH_MIN + 2 * OUTPUT_MONITOR_TILE_SPACING);
+
+  m_timer->setTimerType(Qt::PreciseTimer);
+  connect(m_timer,
+          SIGNAL(timeout()),
+          this,
+          SLOT(onTimeout()));
+  m_timer->start(1000 / m_outputThread->getRefreshRate());
+}
+
+OutputMonitorWidget::~OutputMonitorWidget()
+{}
+
+QRect OutputMonitorWidget::getTileRect(int t_uid) const
+{
+  auto column = t_uid % m_tileColumnCount;
+  auto row = t_uid / m_tileColumnCount;
+  return QRect(OUTPUT_MONITOR_TILE_SPACING
+                   + column * (m_tileSize.width() + OUTPUT_MONITOR_TILE_SPACING),
+               OUTPUT_MONITOR_TILE_SPACING
+                   + row * (m_tileSize.height() + OUTPUT_MONITOR_TILE_SPACING),
+               m_tileSize.width(),
+               m_tileSize.height());
+}
+
+void OutputMonitorWidget::updateTileSize()
+{
+  auto availableWidth = width() - OUTPUT_MONITOR_TILE_SPACING;
+  m_tileColumnCount = qMax(1,
+                           availableWidth / (OUTPUT_MONITOR_TILE_WIDTH_MIN
+                                             + OUTPUT_MONITOR_TILE_SPACING));
+  auto tileWidth = availableWidth / m_tileColumnCount
+                   - OUTPUT_MONITOR_TILE_SPACING;
+  // keep image ratio
+  m_tileSize = QSize(tileWidth,
+                     tileWidth * OUTPUT_MONITOR_IMAGE_HEIGHT
+                         / OUTPUT_MONITOR_IMAGE_WIDTH);
+  // grows down, a scroll area shows what doesn't fit
+  auto rowCount = qMax(1,
+                       static_cast<int>((m_L_image.size() + m_tileColumnCount - 1)
+                                        / m_tileColumnCount));
+  setMinimumHeight(OUTPUT_MONITOR_TILE_SPACING
+                   + rowCount * (m_tileSize.height() + OUTPUT_MONITOR_TILE_SPACING));
+}
+
+void OutputMonitorWidget::resizeEvent(QResizeEvent *event)
+{
+  QWidget::resizeEvent(event);
+  updateTileSize();
+}
+
+void OutputMonitorWidget::onTimeout()
+{
+  // follow output refresh rate if it changed
+  auto interval = 1000 / m_outputThread->getRefreshRate();
+  if (interval != m_timer->interval())
+    m_timer->setInterval(interval);
+
+  QList<QByteArray> L_frame;
+  m_outputThread->getMonitorFrames(L_frame);
+
+  if (L_frame.size() != m_L_image.size())
+  {
+    m_L_image.clear();
+    for (qsizetype i = 0;
+         i < L_frame.size();
+         i++)
+    {
+      QImage image(OUTPUT_MONITOR_IMAGE_WIDTH,
+                   OUTPUT_MONITOR_IMAGE_HEIGHT,
+                   QImage::Format_Indexed8);
+      image.setColorTable(m_L_colorTable);
+      image.fill(0);
+      m_L_image.append(image);
+    }
+    m_L_frame.clear();
+    m_L_frame.resize(L_frame.size());
+    updateTileSize();
+    update();
+  }
+
+  for (qsizetype i = 0;
+       i < L_frame.size();
+       i++)
+  {
+    const auto &frame = L_frame.at(i);
+    // still shared : output thread did not write it again
+    if (frame.isSharedWith(m_L_frame.at(i))
+        || frame.size() < UNIVERSE_OUTPUT_COUNT_DEFAULT)
+    {
+      continue;
+    }
+    auto &image = m_L_image[i];
+    auto lineSize = image.bytesPerLine();
+    if (lineSize == OUTPUT_MONITOR_IMAGE_WIDTH)
+    {
+      std::memcpy(image.bits(),
+                  frame.constData(),
+                  UNIVERSE_OUTPUT_COUNT_DEFAULT);
+    }
+    else
+    {
+      for (int j = 0;
+           j < OUTPUT_MONITOR_IMAGE_HEIGHT;
+           j++)
+      {
+        std::memcpy(image.scanLine(j),
+                    frame.constData() + j * OUTPUT_MONITOR_IMAGE_WIDTH,
+                    OUTPUT_MONITOR_IMAGE_WIDTH);
+      }
+    }
+    update(getTileRect(i));
+  }
+  m_L_frame = L_frame;
+}
+
+void OutputMonitorWidget::paintEvent(QPaintEvent *event)
+{
+  QPainter painter(this);
+  painter.fillRect(event->rect(),
+                   Qt::black);
+  painter.setPen(Qt::white);
+  for (qsizetype i = 0;
+       i < m_L_image.size();
+       i++)
+  {
+    auto rect = getTileRect(i);
+    if (!event->rect().intersects(rect))
+      continue;
+    // no smoothing, one slot is one block
+    painter.drawImage(rect,
+                      m_L_image.at(i));
+    painter.drawText(rect.adjusted(2, 0, 0, 0),
+                     Qt::AlignTop | Qt::AlignLeft,
+                     QString::number(i + 1));
+  }
+}
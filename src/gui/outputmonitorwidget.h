@@ -0,0 +1,75 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OUTPUTMONITORWIDGET_H
+#define OUTPUTMONITORWIDGET_H
+
+#include <QWidget>
+#include <QImage>
+#include <QTimer>
+#include <QList>
+#include "../qontrejour.h"
+
+class OutputThread;
+
+/************************* OutputMonitorWidget **************************/
+
+// every slot of every universe, one indexed image per universe.
+// Reads what the output thread sent, at its refresh rate, and
+// repaints only universes that changed.
+class OutputMonitorWidget
+    : public QWidget
+{
+
+  Q_OBJECT
+
+public :
+
+  explicit OutputMonitorWidget(OutputThread *t_outputThread,
+                               QWidget *parent = nullptr);
+
+  virtual ~OutputMonitorWidget();
+
+protected :
+
+  virtual void paintEvent(QPaintEvent *event) override;
+  virtual void resizeEvent(QResizeEvent *event) override;
+
+private :
+
+  QRect getTileRect(int t_uid) const;
+  void updateTileSize();
+
+private slots :
+
+  void onTimeout();
+
+private :
+
+  OutputThread *m_outputThread;
+  QTimer *m_timer;
+
+  QList<QRgb> m_L_colorTable; // level to heat color
+  QList<QByteArray> m_L_frame; // last read, shared with output thread
+  QList<QImage> m_L_image; // by universe
+
+  int m_tileColumnCount = 1;
+  QSize m_tileSize;
+
+};
+
+#endif // OUTPUTMONITORWIDGET_H
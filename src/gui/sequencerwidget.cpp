@@ -16,7 +16,10 @@
  */
 
 #include "sequencerwidget.h"
+#include "../core/dmxmanager.h"
 #include <QLayout>
+#include <QHeaderView>
+#include <QWheelEvent>
 #include <QDebug>
 
 /********************** SequencerWidget ****************************/
@@ -35,6 +38,20 @@ SequencerWidget::SequencerWidget(Sequence *t_seq,
   m_treeViewBottom->setModel(m_model);
   m_treeViewBottom->setHeaderHidden(true);
 
+  // top shows selected cue only, bottom is scrolled to next cue.
+  // No hidden rows, a go only scrolls
+  for (const auto &item
+       : {m_treeViewTop, m_treeViewBottom})
+  {
+    item->setUniformRowHeights(true);
+    item->setVerticalScrollMode(QAbstractItemView::ScrollPerItem);
+  }
+  m_treeViewTop->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+  m_treeViewTop->setIsWheelEnabled(false);
+  m_treeViewTop->setFixedHeight(m_treeViewTop->header()->sizeHint().height()
+                                + m_treeViewTop->sizeHintForRow(0)
+                                + 2 * m_treeViewTop->frameWidth());
+
   updateTableViews();
 
   layout->addWidget(m_treeViewTop);
@@ -59,20 +76,16 @@ SequencerWidget::~SequencerWidget()
 
 void SequencerWidget::updateTableViews()
 {
-  qsizetype seqSize = m_model->getRootItem()->getL_childScene().size();
-  for (qsizetype i = 1;
-       i < seqSize;
-       i++)
-  {
-    m_treeViewTop->setRowHidden(i,
-                                QModelIndex(),
-                                true);
-  }
-
-  m_treeViewBottom->setRowHidden(0,
-                                 QModelIndex(),
-                                 true);
-
+  auto selectedStep = m_model->getSelectedStepId();
+  m_treeViewTop->scrollTo(m_model->getStepIndex(selectedStep),
+                          QAbstractItemView::PositionAtTop);
+
+  auto nextIndex = m_model->getStepIndex(selectedStep + 1);
+  if (nextIndex.isValid())
+    m_treeViewBottom->scrollTo(nextIndex,
+                               QAbstractItemView::PositionAtTop);
+  else
+    m_treeViewBottom->scrollToBottom();
 }
 
 /********************** SequencerTimeWidget**************************/
@@ -92,106 +105,336 @@ SequencerTreeView::SequencerTreeView(QWidget *parent)
 SequencerTreeView::~SequencerTreeView()
 {}
 
+void SequencerTreeView::wheelEvent(QWheelEvent *event)
+{
+  if (!m_isWheelEnabled)
+  {
+    event->ignore();
+    return;
+  }
+  QTreeView::wheelEvent(event);
+}
+
 /********************* SequencerTreeModel **************************/
 
 SequencerTreeModel::SequencerTreeModel(Sequence *t_seq,
                                        QAbstractItemModel *parent)
   : QAbstractItemModel(parent),
     m_rootItem(t_seq)
-{}
+{
+  // copy and connections in one engine thread call :
+  // no change slips between them
+  MANAGER->runInEngineThread([this]()
+  {
+    const auto L_scene = m_rootItem->getL_childScene();
+    for (const auto &item
+         : L_scene)
+    {
+      m_L_row.append(createRow(item));
+    }
+    m_selectedStepId = m_rootItem->getSelectedStepId();
+    connectSequence();
+  });
+}
 
+// sequence belongs to the manager. Relays run in the engine thread :
+// disconnected there, none is left running on a dead model. What they
+// already queued to us goes with this object
 SequencerTreeModel::~SequencerTreeModel()
 {
-  m_rootItem->deleteLater();
+  MANAGER->runInEngineThread([this]()
+  {
+    for (const auto &item
+         : std::as_const(m_L_sequenceConnection))
+    {
+      disconnect(item);
+    }
+  });
+}
+
+void SequencerTreeModel::formatScene(const DmxScene *t_scene,
+                                     QStringList &t_L_text,
+                                     QVariantList &t_L_value)
+{
+  t_L_text = QStringList(HeaderFieldCount);
+  t_L_value = QVariantList(HeaderFieldCount);
+  t_L_value[IDField] = t_scene->getSceneID();
+  t_L_value[NameField] = t_scene->getName();
+  t_L_value[NoteField] = t_scene->getNotes();
+  t_L_value[InField] = t_scene->getTimeIn();
+  t_L_value[OutField] = t_scene->getTimeOut();
+  t_L_value[DelayInField] = t_scene->getDelayIn();
+  t_L_value[DelayOutField] = t_scene->getDelayOut();
+  t_L_text[IDField] = QString::number(t_scene->getSceneID());
+  t_L_text[NameField] = t_scene->getName();
+  t_L_text[NoteField] = t_scene->getNotes();
+  t_L_text[InField] = QString::number(t_scene->getTimeIn(), 'f', 1);
+  t_L_text[OutField] = QString::number(t_scene->getTimeOut(), 'f', 1);
+  t_L_text[DelayInField] = QString::number(t_scene->getDelayIn(), 'f', 1);
+  t_L_text[DelayOutField] = QString::number(t_scene->getDelayOut(), 'f', 1);
+}
+
+SequencerRow SequencerTreeModel::createRow(const DmxScene *t_scene)
+{
+  SequencerRow row;
+  if (!t_scene)
+    return row;
+  formatScene(t_scene,
+              row.m_L_text,
+              row.m_L_value);
+  const auto L_subScene = t_scene->getL_subScene();
+  for (const auto &item
+       : L_subScene)
+  {
+    QStringList L_text;
+    QVariantList L_value;
+    formatScene(item,
+                L_text,
+                L_value);
+    row.m_L_subText.append(L_text);
+    row.m_L_subValue.append(L_value);
+  }
+  return row;
+}
+
+void SequencerTreeModel::connectSequence()
+{
+  // relays run in the engine thread where the sequence emits,
+  // they copy the row there and hand it to the gui thread
+  auto sequence = m_rootItem;
+  m_L_sequenceConnection
+      << connect(sequence, &Sequence::sceneInserted, sequence, [this, sequence](id t_step)
+  {
+    auto row = createRow(sequence->getScene(t_step));
+    QMetaObject::invokeMethod(this, [this, t_step, row]()
+    {
+      insertSceneRow(t_step,
+                row);
+    });
+  })
+      << connect(sequence, &Sequence::sceneRemoved, sequence, [this](id t_step)
+  {
+    QMetaObject::invokeMethod(this, [this, t_step]()
+    {
+      removeSceneRow(t_step);
+    });
+  })
+      << connect(sequence, &Sequence::sceneReplaced, sequence, [this, sequence](id t_step)
+  {
+    auto row = createRow(sequence->getScene(t_step));
+    QMetaObject::invokeMethod(this, [this, t_step, row]()
+    {
+      replaceSceneRow(t_step,
+                 row);
+    });
+  })
+      << connect(sequence, &Sequence::stepNumberChanged, sequence, [this](id t_step)
+  {
+    QMetaObject::invokeMethod(this, [this, t_step]()
+    {
+      updateStepNumbers(t_step);
+    });
+  })
+      << connect(sequence, &Sequence::scenesCleared, sequence, [this, sequence]()
+  {
+    auto row = createRow(sequence->getScene(static_cast<id>(0)));
+    QMetaObject::invokeMethod(this, [this, row]()
+    {
+      resetSceneRows(row);
+    });
+  });
 }
 
-DmxValue *SequencerTreeModel::getDmxValue(const QModelIndex &index) const
+const QStringList *SequencerTreeModel::getText(const QModelIndex &t_index) const
 {
-  if (!index.isValid()) return m_rootItem;
+  if (!t_index.isValid())
+    return nullptr;
+  if (!t_index.internalId())
+  {
+    if (t_index.row() >= m_L_row.size())
+      return nullptr;
+    return &m_L_row.at(t_index.row()).m_L_text;
+  }
+  auto parentRow = static_cast<qsizetype>(t_index.internalId() - 1);
+  if (parentRow >= m_L_row.size()
+      || t_index.row() >= m_L_row.at(parentRow).m_L_subText.size())
+  {
+    return nullptr;
+  }
+  return &m_L_row.at(parentRow).m_L_subText.at(t_index.row());
+}
 
-  auto scene = static_cast<DmxScene *>(index.internalPointer());
-  if (scene) return scene;
-  return nullptr;
+const QVariantList *SequencerTreeModel::getValue(const QModelIndex &t_index) const
+{
+  if (!t_index.isValid())
+    return nullptr;
+  if (!t_index.internalId())
+  {
+    if (t_index.row() >= m_L_row.size())
+      return nullptr;
+    return &m_L_row.at(t_index.row()).m_L_value;
+  }
+  auto parentRow = static_cast<qsizetype>(t_index.internalId() - 1);
+  if (parentRow >= m_L_row.size()
+      || t_index.row() >= m_L_row.at(parentRow).m_L_subValue.size())
+  {
+    return nullptr;
+  }
+  return &m_L_row.at(parentRow).m_L_subValue.at(t_index.row());
 }
 
 void SequencerTreeModel::updateModel(id t_selectedId)
 {
-  m_seqSize = m_rootItem->getSize();
-  if (t_selectedId < m_seqSize)
-    m_selectedStepId = t_selectedId;
+  if (t_selectedId < 0
+      || t_selectedId >= m_L_row.size()
+      || t_selectedId == m_selectedStepId)
+  {
+    return;
+  }
+  m_selectedStepId = t_selectedId;
   emit viewChange();
 }
 
+void SequencerTreeModel::insertSceneRow(id t_step,
+                                   const SequencerRow &t_row)
+{
+  if (t_step < 0
+      || t_step > m_L_row.size())
+  {
+    qWarning() << "can't SequencerTreeModel::insertRow";
+    return;
+  }
+  beginInsertRows(QModelIndex(),
+                  t_step,
+                  t_step);
+  m_L_row.insert(t_step,
+                 t_row);
+  endInsertRows();
+}
 
-QModelIndex SequencerTreeModel::index(int row, int column, const QModelIndex &parent) const
+void SequencerTreeModel::removeSceneRow(id t_step)
 {
-  if (parent.isValid() && parent.column() !=0) return QModelIndex();
+  if (t_step < 0
+      || t_step >= m_L_row.size())
+  {
+    qWarning() << "can't SequencerTreeModel::removeRow";
+    return;
+  }
+  beginRemoveRows(QModelIndex(),
+                  t_step,
+                  t_step);
+  m_L_row.removeAt(t_step);
+  if (m_selectedStepId >= m_L_row.size())
+    m_selectedStepId = m_L_row.size() - 1;
+  endRemoveRows();
+}
 
-  auto parentValue = getDmxValue(parent);
-  if (!parentValue) return QModelIndex();
-  // si c'est le rootitem
-  auto rootItem = qobject_cast<Sequence *>(parentValue);
-  if (rootItem)
+void SequencerTreeModel::replaceSceneRow(id t_step,
+                                    const SequencerRow &t_row)
+{
+  if (t_step < 0
+      || t_step >= m_L_row.size())
   {
-    if (row >= m_seqSize) return QModelIndex();
-    id stepToPass = (row
-                     + m_selectedStepId)
-                    % m_seqSize;
-    auto childScene = m_rootItem->getScene(stepToPass);
-    return createIndex(row,
-                       column,
-                       childScene);
+    qWarning() << "can't SequencerTreeModel::replaceRow";
+    return;
   }
-  // si c'est une main scene
-  auto parentScene = qobject_cast<DmxScene *>(parentValue);
-  if (parentScene)
+  // sub scenes may differ, rebuild them
+  auto parentIndex = index(t_step, 0, QModelIndex());
+  auto subRowCount = m_L_row.at(t_step).m_L_subText.size();
+  if (subRowCount)
   {
-    auto childScene = parentScene->getL_subScene().at(row);
-    if (childScene)
-      return createIndex(row,
-                         column,
-                         childScene);
-
+    beginRemoveRows(parentIndex,
+                    0,
+                    subRowCount - 1);
+    m_L_row[t_step].m_L_subText.clear();
+    m_L_row[t_step].m_L_subValue.clear();
+    endRemoveRows();
   }
-  return QModelIndex();
+  subRowCount = t_row.m_L_subText.size();
+  if (subRowCount)
+    beginInsertRows(parentIndex,
+                    0,
+                    subRowCount - 1);
+  m_L_row[t_step] = t_row;
+  if (subRowCount)
+    endInsertRows();
+  emit dataChanged(index(t_step, 0, QModelIndex()),
+                   index(t_step, HeaderFieldCount - 1, QModelIndex()));
 }
 
-QModelIndex SequencerTreeModel::parent(const QModelIndex &child) const
+void SequencerTreeModel::updateStepNumbers(id t_step)
 {
-  if (!child.isValid()) return QModelIndex();
+  if (t_step < 0
+      || t_step >= m_L_row.size())
+  {
+    return;
+  }
+  emit dataChanged(index(t_step, StepField, QModelIndex()),
+                   index(m_L_row.size() - 1, StepField, QModelIndex()));
+}
 
-  auto childValue = getDmxValue(child);
+void SequencerTreeModel::resetSceneRows(const SequencerRow &t_firstRow)
+{
+  beginResetModel();
+  m_L_row.clear();
+  m_L_row.append(t_firstRow);
+  m_selectedStepId = 0;
+  endResetModel();
+}
 
-  // si c'est une scene
-  auto mainScene = qobject_cast<DmxScene *>(childValue);
-  if (mainScene) return QModelIndex();
+QModelIndex SequencerTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+  if (row < 0
+      || column < 0
+      || column >= HeaderFieldCount)
+  {
+    return QModelIndex();
+  }
+  // main scene, internal id 0
+  if (!parent.isValid())
+  {
+    if (row >= m_L_row.size()) return QModelIndex();
+    return createIndex(row,
+                       column,
+                       static_cast<quintptr>(0));
+  }
+  // sub scene, internal id is parent row + 1
+  if (parent.internalId()
+      || parent.column() != 0
+      || parent.row() >= m_L_row.size())
+  {
+    return QModelIndex();
+  }
+  if (row >= m_L_row.at(parent.row()).m_L_subText.size()) return QModelIndex();
+  return createIndex(row,
+                     column,
+                     static_cast<quintptr>(parent.row() + 1));
+}
 
-  // si c'est une subscene
-  auto subScene = qobject_cast<SubScene *>(childValue);
-  if (subScene)
+QModelIndex SequencerTreeModel::parent(const QModelIndex &child) const
+{
+  if (!child.isValid()
+      || !child.internalId())
   {
-    auto parentScene = subScene->getParentScene();
-    return createIndex(parentScene->getStepNumber(),
-                       0,
-                       parentScene);
+    return QModelIndex();
   }
-  return QModelIndex();
+  return createIndex(static_cast<int>(child.internalId() - 1),
+                     0,
+                     static_cast<quintptr>(0));
 }
 
 int SequencerTreeModel::rowCount(const QModelIndex &parent) const
 {
-  auto parentValue = getDmxValue(parent);
-  auto rootItem = qobject_cast<Sequence *>(parentValue);
-  if (rootItem)
+  // follows the queued changes, not the live sequence
+  if (!parent.isValid())
+    return m_L_row.size();
+  if (parent.internalId()
+      || parent.column() != 0
+      || parent.row() >= m_L_row.size())
   {
-    qsizetype size = rootItem->getSize();
-    return size;
+    return 0;
   }
-
-  auto parentScene = qobject_cast<DmxScene *>(parentValue);
-  if (parentScene) return parentScene->getL_subScene().size();
-
-  return 0;
+  return m_L_row.at(parent.row()).m_L_subText.size();
 }
 
 int SequencerTreeModel::columnCount(const QModelIndex &parent) const
@@ -210,25 +453,19 @@ QVariant SequencerTreeModel::data(const QModelIndex &index, int role) const
   if (role != Qt::DisplayRole && role != Qt::EditRole)
     return QVariant();
 
-  auto scene = qobject_cast<DmxScene *>(getDmxValue(index));
+  int col = index.column();
+  // step is the row, sequence renumbers on each change
+  if (col == StepField)
+    return role == Qt::DisplayRole ? QVariant(QString::number(index.row()))
+                                   : QVariant(index.row());
 
-  if (scene)
+  if (role == Qt::DisplayRole)
   {
-    int col = index.column();
-    switch(col)
-    {
-    case StepField : return scene->getStepNumber(); break;
-    case IDField : return scene->getSceneID(); break;
-    case NameField : return scene->getName(); break;
-    case NoteField : return scene->getNotes(); break;
-    case InField : return scene->getTimeIn(); break;
-    case OutField : return scene->getTimeOut(); break;
-    case DelayInField : return scene->getDelayIn(); break;
-    case DelayOutField : return scene->getDelayOut(); break;
-    default : break;
-    }
+    auto L_text = getText(index);
+    return L_text ? QVariant(L_text->at(col)) : QVariant();
   }
-  return QVariant();
+  auto L_value = getValue(index);
+  return L_value ? L_value->at(col) : QVariant();
 }
 
 bool SequencerTreeModel::setData(const QModelIndex &index, const QVariant &value, int role)
@@ -239,22 +476,55 @@ bool SequencerTreeModel::setData(const QModelIndex &index, const QVariant &value
   if (!index.isValid() || !(index.flags().testFlag(Qt::ItemIsEditable)))
     return false;
 
-  auto scene = qobject_cast<DmxScene *>(getDmxValue(index));
-  if (!scene) return false;
+  auto L_value = getValue(index);
+  if (!L_value)
+    return false;
 
   int col = index.column();
-  switch(col)
+  bool isSubScene = index.internalId() != 0;
+  id step = isSubScene ? static_cast<id>(index.internalId() - 1)
+                       : static_cast<id>(index.row());
+  int subRow = index.row();
+  // the scene we show, queued changes may not be there yet
+  auto sceneId = L_value->at(IDField).toFloat();
+  bool isSet = false;
+  SequencerRow row;
+  // the cue engine reads times while fading. Gui waits for the
+  // engine here, the engine never waits for the gui
+  MANAGER->runInEngineThread([&]()
   {
-  case IDField : scene->setSceneID(value.toInt()); emit dataChanged(index,index); return true; break;
-  case NameField : scene->setName(value.toString()); emit dataChanged(index,index); return true; break;
-  case NoteField : scene->setNotes(value.toString()); emit dataChanged(index,index); return true; break;
-  case InField : scene->setTimeIn(value.toFloat()); emit dataChanged(index,index); return true; break;
-  case OutField : scene->setTimeOut(value.toFloat()); emit dataChanged(index,index); return true; break;
-  case DelayInField : scene->setDelayIn(value.toFloat()); emit dataChanged(index,index); return true; break;
-  case DelayOutField : scene->setDelayOut(value.toFloat()); emit dataChanged(index,index); return true; break;
-  default : break;
-  }
-  return false;
+    DmxScene *scene = m_rootItem->getScene(step);
+    if (scene
+        && isSubScene)
+    {
+      const auto L_subScene = scene->getL_subScene();
+      scene = subRow < L_subScene.size() ? L_subScene.at(subRow) : nullptr;
+    }
+    if (!scene
+        || scene->getSceneID() != sceneId)
+    {
+      return;
+    }
+    isSet = true;
+    switch(col)
+    {
+    case IDField : scene->setSceneID(value.toInt()); break;
+    case NameField : scene->setName(value.toString()); break;
+    case NoteField : scene->setNotes(value.toString()); break;
+    case InField : scene->setTimeIn(value.toFloat()); break;
+    case OutField : scene->setTimeOut(value.toFloat()); break;
+    case DelayInField : scene->setDelayIn(value.toFloat()); break;
+    case DelayOutField : scene->setDelayOut(value.toFloat()); break;
+    default : isSet = false; break;
+    }
+    if (isSet)
+      row = createRow(m_rootItem->getScene(step));
+  });
+  if (!isSet)
+    return false;
+  m_L_row[step] = row;
+  emit dataChanged(index,index);
+  return true;
 }
 
 QVariant SequencerTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
@@ -314,10 +584,10 @@ Qt::ItemFlags SequencerTreeModel::flags(const QModelIndex &index) const
   if (!index.isValid())
     return Qt::NoItemFlags;
 
-  auto scene = qobject_cast<DmxScene *>(getDmxValue(index));
-  if (scene)
-    if (scene->getStepNumber() == 0)
-      return Qt::ItemIsEnabled/* | Qt::ItemIsSelectable*/;
+  // step 0 is the blank scene
+  if (!index.internalId()
+      && index.row() == 0)
+    return Qt::ItemIsEnabled/* | Qt::ItemIsSelectable*/;
 
   if (index.column() == 0)
     return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
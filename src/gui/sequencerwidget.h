@@ -88,10 +88,34 @@ public :
 
   virtual ~SequencerTreeView();
 
+  void setIsWheelEnabled(bool t_isWheelEnabled)
+  { m_isWheelEnabled = t_isWheelEnabled; }
+
+protected :
+
+  virtual void wheelEvent(QWheelEvent *event) override;
+
+protected :
+
+  bool m_isWheelEnabled = true;
+
 };
 
 /********************* SequencerTreeModel **************************/
 
+// one main scene as views show it, built in the engine thread.
+// Sub scenes are one level deep
+struct SequencerRow
+{
+  QStringList m_L_text; // display, by HeaderField
+  QVariantList m_L_value; // edit, by HeaderField
+  QList<QStringList> m_L_subText;
+  QList<QVariantList> m_L_subValue;
+};
+
+// never reads the sequence from the gui thread : rows are copied
+// in the engine thread and each change comes queued with its row.
+// The engine never waits for the gui, only setData() waits for it.
 class SequencerTreeModel
     : public QAbstractItemModel
 {
@@ -107,18 +131,44 @@ public :
 
   virtual ~SequencerTreeModel();
 
-  DmxValue *getDmxValue(const QModelIndex &index) const;
   Sequence *getRootItem() const{ return m_rootItem; }
+  id getSelectedStepId() const{ return m_selectedStepId; }
+  QModelIndex getStepIndex(id t_step) const
+  { return index(t_step, 0, QModelIndex()); }
+
+private :
+
+  // engine thread only
+  static void formatScene(const DmxScene *t_scene,
+                          QStringList &t_L_text,
+                          QVariantList &t_L_value);
+  static SequencerRow createRow(const DmxScene *t_scene);
+  void connectSequence();
+
+  // null if index is out of rows
+  const QStringList *getText(const QModelIndex &t_index) const;
+  const QVariantList *getValue(const QModelIndex &t_index) const;
 
 signals :
 
+  // selected step moved
   void viewChange();
 
 public slots :
 
-  void setRootItem(Sequence *t_rootItem){ m_rootItem = t_rootItem; }
   void updateModel(id t_selectedId);
 
+private :
+
+  // queued from the engine thread, in sequence order
+  void insertSceneRow(id t_step,
+                 const SequencerRow &t_row);
+  void removeSceneRow(id t_step);
+  void replaceSceneRow(id t_step,
+                  const SequencerRow &t_row);
+  void updateStepNumbers(id t_step);
+  void resetSceneRows(const SequencerRow &t_firstRow);
+
 protected :
 
   virtual QModelIndex index(int row, int column, const QModelIndex &parent) const override;
@@ -138,8 +188,9 @@ protected :
 protected :
 
   Sequence *m_rootItem;
-  qsizetype m_seqSize = 1;
   id m_selectedStepId = 0;
+  QList<SequencerRow> m_L_row; // by step
+  QList<QMetaObject::Connection> m_L_sequenceConnection;
 
 };
 
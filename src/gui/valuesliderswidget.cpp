@@ -24,105 +24,214 @@
 
 ValueSlidersWidget::ValueSlidersWidget(QWidget *parent)
   : QWidget(parent),
-    m_stackedLayout(new QStackedLayout()),
     m_changePageComboBox(new QComboBox(this))
 {
-  auto totalLayout = new QVBoxLayout();
-  totalLayout->addWidget(m_changePageComboBox);
-  totalLayout->addLayout(m_stackedLayout);
-  setLayout(totalLayout);
-
   setMinimumHeight(200);
 
   connect(m_changePageComboBox,
           &QComboBox::activated,
-          m_stackedLayout,
-          &QStackedLayout::setCurrentIndex);
+          this,
+          &ValueSlidersWidget::setPage);
+
+  // no per value connection, engine publishes at gui rate
+  connect(MANAGER->getDmxEngine()->getSnapshotPublisher(),
+          &SnapshotPublisher::snapshotPublished,
+          this,
+          &ValueSlidersWidget::onSnapshotPublished);
 }
 
 void ValueSlidersWidget::setRootValue(RootValue *t_rootValue)
 {
   m_rootValue = t_rootValue;
+  auto snapshotPublisher = MANAGER->getDmxEngine()->getSnapshotPublisher();
+  QList<LeveledValue *> L_value;
+  QStringList L_name;
+  // children are added in the engine thread, copy them there
+  MANAGER->runInEngineThread([&]()
+  {
+    auto valueCount = m_rootValue->getL_childValueSize();
+    for (int i = 0;
+         i < valueCount;
+         i++)
+    {
+      auto value = m_rootValue->getChildValue(i);
+      L_value.append(value);
+      L_name.append(value->getName());
+    }
+    m_snapshot = snapshotPublisher->getSnapshot();
+  });
+  m_valueCount = L_value.size();
   populateWidget();
-  connectSliders();
+  connectSliders(L_value,
+                 L_name);
+}
+
+void ValueSlidersWidget::onSnapshotPublished(const ChannelSnapshot &t_snapshot)
+{
+  m_snapshot = t_snapshot;
+  updateSliderLevels();
+}
+
+void ValueSlidersWidget::createBank(int t_sliderCount,
+                                    int t_slotCount)
+{
+  m_L_slotValue.fill(nullptr,
+                     t_slotCount);
+  m_L_slotValueId.fill(NO_ID,
+                       t_slotCount);
+  m_L_slotName.fill(QString(),
+                    t_slotCount);
+
+  auto pageLayout = new QHBoxLayout();
+  for (int i = 0;
+       i < t_sliderCount;
+       i++)
+  {
+    auto slider = new ValueSlider(this);
+    slider->setID(i);
+    m_L_sliders.append(slider);
+
+    auto idLabel = new QLabel("", this);
+    idLabel->setAlignment(Qt::AlignHCenter);
+    m_L_idLabels.append(idLabel);
+
+    auto nameLabel = new QLabel("", this);
+    nameLabel->setAlignment(Qt::AlignHCenter);
+    nameLabel->setWordWrap(true);
+    m_L_nameLabels.append(nameLabel);
+
+    auto layout = new QVBoxLayout();
+    layout->addWidget(slider);
+    layout->addWidget(idLabel);
+    layout->addWidget(nameLabel);
+    layout->setAlignment(slider,
+                         Qt::AlignHCenter);
+    pageLayout->addLayout(layout);
+  }
+
+  auto totalLayout = new QVBoxLayout();
+  totalLayout->addWidget(m_changePageComboBox);
+  totalLayout->addLayout(pageLayout);
+  setLayout(totalLayout);
+}
+
+void ValueSlidersWidget::bindSlider(int t_sliderID)
+{
+  auto slotID = m_currentPage * m_L_sliders.size() + t_sliderID;
+  auto value = getSlotValue(slotID);
+  m_L_sliders.at(t_sliderID)->setDmxValue(value);
+  m_L_idLabels.at(t_sliderID)->setText(slotID < m_L_slotValue.size()
+                                           ? QString::number(slotID + 1)
+                                           : QString());
+  m_L_nameLabels.at(t_sliderID)->setText(m_L_slotName.value(slotID));
+  if (value)
+    m_L_sliders.at(t_sliderID)->showLevel(getSnapshotLevel(m_snapshot,
+                                                           m_L_slotValueId.at(slotID)));
+}
+
+void ValueSlidersWidget::updateSliderLevels()
+{
+  for (int i = 0;
+       i < m_L_sliders.size();
+       i++)
+  {
+    auto slotID = m_currentPage * m_L_sliders.size() + i;
+    if (!getSlotValue(slotID))
+      continue;
+    m_L_sliders.at(i)->showLevel(getSnapshotLevel(m_snapshot,
+                                                  m_L_slotValueId.at(slotID)));
+  }
 }
 
-void ValueSlidersWidget::connectSliders()
+void ValueSlidersWidget::connectSliders(const QList<LeveledValue *> &t_L_value,
+                                        const QStringList &t_L_name)
 {
   for (int i = 0;
-       i < m_L_sliders.size()
-       && i < m_rootValue->getL_childValueSize();
+       i < m_L_slotValue.size()
+       && i < t_L_value.size();
        i++)
   {
-    connectSlider(i,i);
+    m_L_slotValue[i] = t_L_value.at(i);
+    m_L_slotValueId[i] = static_cast<id>(i);
+    m_L_slotName[i] = t_L_name.at(i);
+  }
+  setPage(m_currentPage);
+}
+
+void ValueSlidersWidget::setPage(int t_page)
+{
+  // same widgets, new targets
+  m_currentPage = t_page;
+  for (int i = 0;
+       i < m_L_sliders.size();
+       i++)
+  {
+    bindSlider(i);
   }
 }
 
 void ValueSlidersWidget::connectSlider(int t_sliderID,
-                                       LeveledValue *t_value)
+                                       LeveledValue *t_value,
+                                       id t_valueId,
+                                       const QString &t_name)
 {
   if (t_sliderID < 0
-      || t_sliderID >= m_L_sliders.size()
+      || t_sliderID >= m_L_slotValue.size()
       || (!t_value))
   {
     qDebug() << "problem in ValueSlidersWidget::connectSlider";
     return;
   }
 
-  auto slider = m_L_sliders.at(t_sliderID);
-  auto label = m_L_nameLabels.at(t_sliderID);
-
-  if (slider->getIsConnected())
+  m_L_slotValue[t_sliderID] = t_value;
+  m_L_slotValueId[t_sliderID] = t_valueId;
+  m_L_slotName[t_sliderID] = t_name;
+  auto bankID = t_sliderID - m_currentPage * m_L_sliders.size();
+  if (bankID >= 0
+      && bankID < m_L_sliders.size())
   {
-    disconnectSlider(t_sliderID);
+    bindSlider(bankID);
   }
-
-  label->setText(t_value->getName());
-  slider->setDmxValue(t_value);
-
 }
 
 void ValueSlidersWidget::connectSlider(int t_sliderID,
                                        id valueID)
 {
-  auto value = m_rootValue->getChildValue(valueID);
+  LeveledValue *value = nullptr;
+  QString name;
+  MANAGER->runInEngineThread([&]()
+  {
+    value = m_rootValue->getChildValue(valueID);
+    if (value)
+      name = value->getName();
+  });
   if (value)
   {
     return connectSlider(t_sliderID,
-                         value);
+                         value,
+                         valueID,
+                         name);
   }
 }
 
 void ValueSlidersWidget::disconnectSlider(int t_sliderID)
 {
   if (t_sliderID < 0
-      || t_sliderID >= m_L_sliders.size())
+      || t_sliderID >= m_L_slotValue.size())
   {
     qDebug() << "problem in ValueSlidersWidget::disConnectSlider";
     return;
   }
-  auto slider = m_L_sliders.at(t_sliderID);
-  if (t_sliderID < m_L_nameLabels.size())
+
+  m_L_slotValue[t_sliderID] = nullptr;
+  m_L_slotValueId[t_sliderID] = NO_ID;
+  m_L_slotName[t_sliderID].clear();
+  auto bankID = t_sliderID - m_currentPage * m_L_sliders.size();
+  if (bankID >= 0
+      && bankID < m_L_sliders.size())
   {
-    auto label = m_L_nameLabels.at(t_sliderID);
-    label->setText("");
+    bindSlider(bankID);
   }
-
-  disconnect(slider,
-             SIGNAL(valueChanged(int)),
-             slider,
-             SLOT(updateLevel(int)));
-
-  auto value = slider->getDmxValue();
-
-  disconnect(value,
-             SIGNAL(levelChanged(id,dmx)),
-             slider,
-             SLOT(onValueLevelChanged(id,dmx)));
-
-  slider->setIsConnected(false);
-  value->setAssignedWidget(nullptr);
-
 }
 
 /************************** DirectChannelWidget ************************/
@@ -146,58 +255,31 @@ DirectChannelWidget::DirectChannelWidget(QWidget *parent)
 
 void DirectChannelWidget::populateWidget()
 {
-  // on crée les sliders
-  // TODO : vider avant ?
+  // one bank of sliders, rebound on page change
+  auto channelCount = m_valueCount;
+  int page_count = channelCount / SLIDERS_PER_PAGE;
+  if (channelCount > page_count * SLIDERS_PER_PAGE)
+    page_count++;
+
+  createBank(SLIDERS_PER_PAGE,
+             page_count * SLIDERS_PER_PAGE);
 
-  auto L_dmxChannel = m_rootValue->getL_childValue();
   for (const auto &item
-       : std::as_const(L_dmxChannel))
+       : std::as_const(m_L_sliders))
   {
-    auto directChannelSlider = new ValueSlider(item,
-                                               this);
-
-    connect(directChannelSlider,
+    item->setTickInterval(10);
+    item->setTickPosition(QSlider::TicksBothSides);
+    // coalesced by the engine, one update per tick. Pushed
+    // from the gui thread, no queued event
+    connect(item,
             SIGNAL(valueSliderMoved(id,dmx)),
-            MANAGER->getDmxEngine()->getChannelEngine(),
-            SLOT(onChannelLevelChangedFromSliderChannel(id,dmx)));
-
-    m_L_sliders.append(directChannelSlider);
+            MANAGER->getDmxEngine(),
+            SLOT(requestChannelLevel(id,dmx)),
+            Qt::DirectConnection);
   }
 
-  // on crée le 1er widget pour contenir 32 sliders
-  int page_count = m_L_sliders.size() / SLIDERS_PER_PAGE;
-  if (m_L_sliders.size() > page_count * SLIDERS_PER_PAGE)
-    page_count++;
-
-  // TODO : probably crashes with with non 512ch universe.
   for (int i = 0; i < page_count; i++) // for each page
   {
-    auto widget = new QWidget(this);
-    auto pageLayout = new QHBoxLayout();
-
-    for (int j = 0; j < SLIDERS_PER_PAGE; j++) // for each slider
-    {
-      auto nameLabel = new QLabel("", this);
-      nameLabel->setAlignment(Qt::AlignHCenter);
-      nameLabel->setWordWrap(true);
-      m_L_nameLabels.append(nameLabel);
-
-      auto layout = new QVBoxLayout();
-      auto label = new QLabel(QString::number(j + (i * SLIDERS_PER_PAGE) + 1),
-                              widget);
-      label->setAlignment(Qt::AlignHCenter);
-      auto slider = m_L_sliders.at(j + (i * SLIDERS_PER_PAGE));
-      slider->setID(j + (i * SLIDERS_PER_PAGE));
-
-      layout->addWidget(slider);
-      layout->addWidget(label);
-      layout->addWidget(nameLabel);
-      layout->setAlignment(slider,
-                           Qt::AlignHCenter);
-      pageLayout->addLayout(layout);
-    }
-    widget->setLayout(pageLayout);
-    m_stackedLayout->addWidget(widget);
     m_changePageComboBox->addItem(tr("page %1 --> Ch %2 - %3")
                                   .arg(i + 1)
                                   .arg((i * SLIDERS_PER_PAGE) + 1)
@@ -229,58 +311,35 @@ SubmasterWidget::SubmasterWidget(QWidget *parent)
 bool SubmasterWidget::getIsSLiderConnected(int t_sliderID)
 {
   if (t_sliderID < 0
-      || t_sliderID >= m_L_sliders.size())
+      || t_sliderID >= m_L_slotValue.size())
   {
     qDebug() << "SubmasterWidget::getIsSLiderConnected";
     return false;
   }
-  auto slider = m_L_sliders.at(t_sliderID);
-  return slider->getIsConnected();
+  return m_L_slotValue.at(t_sliderID) != nullptr;
 
 }
 
 void SubmasterWidget::populateWidget()
 {
+  createBank(SUBMASTER_SLIDERS_COUNT_PER_PAGE,
+             SUBMASTER_SLIDERS_PAGE_COUNT * SUBMASTER_SLIDERS_COUNT_PER_PAGE);
+
+  for (const auto &item
+       : std::as_const(m_L_sliders))
+  {
+    // group level is set at next tick, its levelChanged does the merge
+    connect(item,
+            SIGNAL(valueSliderMoved(id,dmx)),
+            MANAGER->getDmxEngine(),
+            SLOT(requestGroupLevel(id,dmx)),
+            Qt::DirectConnection);
+  }
+
   for (int i = 0;
        i < SUBMASTER_SLIDERS_PAGE_COUNT;
        i++) // for each page
   {
-    auto widget = new QWidget(this);
-    auto pageLayout = new QHBoxLayout();
-
-    for (int j = 0;
-         j < SUBMASTER_SLIDERS_COUNT_PER_PAGE;
-         j++) // for each slider
-    {
-      auto submasterSlider = new ValueSlider(this);
-      submasterSlider->setID(i);
-      m_L_sliders.append(submasterSlider);
-
-      connect(submasterSlider,
-              SIGNAL(valueSliderMoved(id,dmx)),
-              MANAGER->getDmxEngine()->getGroupEngine(),
-              SLOT(groupLevelChanged(id,dmx)));
-
-
-      auto nameLabel = new QLabel("", this);
-      nameLabel->setAlignment(Qt::AlignHCenter);
-      nameLabel->setWordWrap(true);
-      m_L_nameLabels.append(nameLabel);
-
-      auto layout = new QVBoxLayout();
-      auto idLabel = new QLabel(QString::number(j + (i * SUBMASTER_SLIDERS_COUNT_PER_PAGE) + 1),
-                                widget);
-      idLabel->setAlignment(Qt::AlignHCenter);
-
-      layout->addWidget(submasterSlider);
-      layout->addWidget(idLabel);
-      layout->addWidget(nameLabel);
-      layout->setAlignment(submasterSlider,
-                           Qt::AlignHCenter);
-      pageLayout->addLayout(layout);
-    }
-    widget->setLayout(pageLayout);
-    m_stackedLayout->addWidget(widget);
     m_changePageComboBox->addItem(tr("page %1 --> Channel Group %2 - %3")
                                   .arg(i + 1)
                                   .arg((i * SUBMASTER_SLIDERS_COUNT_PER_PAGE) + 1)
@@ -291,19 +350,21 @@ void SubmasterWidget::populateWidget()
 /************************** ValueSlider ************************/
 
 ValueSlider::ValueSlider(QWidget *parent)
-  :QSlider(parent),
-    m_isConnected(false)
+  :QSlider(parent)
 {
   setMinimum(0);
   setMaximum(255);
+  connect(this,
+          SIGNAL(valueChanged(int)),
+          this,
+          SLOT(updateLevel(int)));
+  setEnabled(false);
 }
 
 ValueSlider::ValueSlider(LeveledValue *t_dmxValue,
                          QWidget *parent)
-  : QSlider(parent)
+  : ValueSlider(parent)
 {
-  setMinimum(0);
-  setMaximum(255);
   setTickInterval(10);
   setTickPosition(QSlider::TicksBothSides);
   setDmxValue(t_dmxValue);
@@ -314,33 +375,43 @@ ValueSlider::~ValueSlider()
 
 void ValueSlider::setDmxValue(LeveledValue *t_dmxValue)
 {
-  m_dmxValue = t_dmxValue;
-  connect(this,
-          SIGNAL(valueChanged(int)),
-          this,
-          SLOT(updateLevel(int)));
+  if (t_dmxValue == m_dmxValue)
+    return;
 
-  connect(m_dmxValue,
-          SIGNAL(levelChanged(id,dmx)),
-          this,
-          SLOT(onValueLevelChanged(id,dmx)));
+  if (m_dmxValue
+      && m_dmxValue->getAssignedWidget() == this)
+  {
+    m_dmxValue->setAssignedWidget(nullptr);
+  }
 
+  // level is set by the widget, from its snapshot
+  m_dmxValue = t_dmxValue;
+  m_isConnected = m_dmxValue != nullptr;
+  setEnabled(m_isConnected);
+  if (!m_dmxValue)
+  {
+    showLevel(NULL_DMX);
+    return;
+  }
   m_dmxValue->setAssignedWidget(this);
-  m_isConnected = true;
 }
 
 void ValueSlider::updateLevel(int t_level)
 {
+  if (!m_dmxValue)
+    return;
   if (t_level < 0) t_level = 0;
   if (t_level > 255) t_level = 255;
-  emit valueSliderMoved(m_ID,
+  // value id, not bank position : same slider, many targets
+  emit valueSliderMoved(m_dmxValue->getid(),
                         t_level);
 }
 
-void ValueSlider::onValueLevelChanged(id t_id,
-                                      dmx t_level)
+void ValueSlider::showLevel(dmx t_level)
 {
-  Q_UNUSED(t_id)
+  // snapshot may be older than the hand on the slider
+  if (isSliderDown())
+    return;
   blockSignals(true);
   this->setValue(t_level);
   blockSignals(false);
@@ -19,10 +19,11 @@
 #define VALUESLIDERSWIDGET_H
 
 #include <QWidget>
-#include <QStackedLayout>
 #include <QComboBox>
+#include <QSlider>
 #include <QLabel>
 #include "../core/dmxvalue.h"
+#include "../core/enginesnapshot.h"
 
 /************************** ValueSlidersWidget ************************/
 
@@ -39,33 +40,67 @@ public :
   explicit ValueSlidersWidget(QWidget *parent = nullptr);
 
   // getters
+  // physical bank, one page of sliders
   QList<ValueSlider *> getL_sliders() const { return m_L_sliders; }
   RootValue *getRootValue() const{ return m_rootValue; }
+  int getCurrentPage() const{ return m_currentPage; }
+  // slot is page * sliders per page + slider in bank
+  LeveledValue *getSlotValue(int t_slotID) const
+  { return m_L_slotValue.value(t_slotID, nullptr); }
 
 //public slots :
 
   virtual void populateWidget() = 0;
+  // children are copied in the engine thread, levels come from snapshots
   void setRootValue(RootValue *t_rootValue);
 
+public slots :
+
+  void onSnapshotPublished(const ChannelSnapshot &t_snapshot);
+
+protected :
+
+  // creates the fixed bank, whatever the value count
+  void createBank(int t_sliderCount,
+                  int t_slotCount);
+  // binds bank slider to what its slot on current page holds
+  void bindSlider(int t_sliderID);
+  void updateSliderLevels();
+  // level of value t_valueId in t_snapshot
+  virtual dmx getSnapshotLevel(const ChannelSnapshot &t_snapshot,
+                               id t_valueId) const = 0;
+
 protected slots :
 
-  void connectSliders();
+  void connectSliders(const QList<LeveledValue *> &t_L_value,
+                      const QStringList &t_L_name);
+  void setPage(int t_page);
 
   void connectSlider(int t_sliderID,
-                     LeveledValue *t_value);
+                     LeveledValue *t_value,
+                     id t_valueId,
+                     const QString &t_name);
   void connectSlider(int t_sliderID,
                      id valueID);
   void disconnectSlider(int t_sliderID);
 
 protected :
 
-  QStackedLayout *m_stackedLayout;
   QComboBox *m_changePageComboBox;
 
   RootValue *m_rootValue;
   QList<ValueSlider *> m_L_sliders;
+  QList<QLabel *> m_L_idLabels;
   QList<QLabel *> m_L_nameLabels;
 
+  QList<LeveledValue *> m_L_slotValue; // every page, nullptr when free
+  QList<id> m_L_slotValueId; // copied with the value, read in gui thread
+  QStringList m_L_slotName;
+  int m_currentPage = 0;
+  int m_valueCount = 0; // root children when set
+
+  ChannelSnapshot m_snapshot;
+
 };
 
 /************************** DirectChannelWidget ************************/
@@ -82,6 +117,13 @@ public :
 
   void populateWidget() override;
 
+protected :
+
+  dmx getSnapshotLevel(const ChannelSnapshot &t_snapshot,
+                       id t_valueId) const override
+  { return t_snapshot.isValidId(t_valueId) ? t_snapshot.getLevel(t_valueId)
+                                           : NULL_DMX; }
+
 };
 
 /************************** SubmasterWidget ************************/
@@ -106,6 +148,12 @@ public slots:
 
   void populateWidget() override;
 
+protected :
+
+  dmx getSnapshotLevel(const ChannelSnapshot &t_snapshot,
+                       id t_valueId) const override
+  { return t_snapshot.getGroupLevel(t_valueId); }
+
 
 };
 
@@ -130,7 +178,10 @@ public :
   id getid() const{ return m_ID; }
   bool getIsConnected() const{ return m_isConnected; }
 
+  // rebinds, nullptr leaves slider free
   void setDmxValue(LeveledValue *t_dmxValue);
+  // feedback, ignored while the user holds the slider
+  void showLevel(dmx t_level);
   void setIsConnected(bool t_isConnected){ m_isConnected = t_isConnected; }
   void setID(id t_ID){ m_ID = t_ID; }
 
@@ -142,14 +193,12 @@ signals :
 protected slots :
 
   virtual void updateLevel(int t_level);
-  virtual void onValueLevelChanged(id t_id,
-                                   dmx t_level);
 
 protected :
 
-  LeveledValue *m_dmxValue;
-  bool m_isConnected;
-  id m_ID;
+  LeveledValue *m_dmxValue = nullptr;
+  bool m_isConnected = false;
+  id m_ID = NO_ID; // position in bank
 
 };
 
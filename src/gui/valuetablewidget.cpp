@@ -21,6 +21,8 @@
 #include <QHeaderView>
 #include <QPainter>
 #include <QMouseEvent>
+#include <QResizeEvent>
+#include <algorithm>
 #include <QDebug>
 #include "../qontrejour.h"
 #include "../core/dmxmanager.h"
@@ -31,52 +33,88 @@ ValueTableWidget::ValueTableWidget(QWidget *parent)
   : QWidget(parent),
     m_tableView(new ValueTableView(this)),
     m_model(new ValueTableModel(this)),
-    m_channelDelegate(new ChannelDelegate(this))
+    m_channelDelegate(new ChannelDelegate(this)),
+    m_filterComboBox(new QComboBox(this)),
+    m_groupSpinBox(new QSpinBox(this))
 {
   auto dmxEngine = MANAGER->getDmxEngine();
   auto channelEngine = dmxEngine->getChannelEngine();
   setChannelEngine(channelEngine);
-  setRootValue(MANAGER->getRootChannel());
+
+  // published snapshots are ours, the working one is the engine's
+  auto snapshotPublisher = dmxEngine->getSnapshotPublisher();
+  ChannelSnapshot snapshot;
+  MANAGER->runInEngineThread([&]()
+  {
+    snapshot = snapshotPublisher->getSnapshot();
+  });
+
+  m_filterComboBox->addItem(tr("all channels"), AllChannelView);
+  m_filterComboBox->addItem(tr("non zero"), NonNullChannelView);
+  m_filterComboBox->addItem(tr("selected"), SelectedChannelView);
+  m_filterComboBox->addItem(tr("group"), GroupChannelView);
+  m_filterComboBox->addItem(tr("next cue"), NextCueChannelView);
+  m_groupSpinBox->setRange(1,
+                           qMax(1, snapshot.getGroupCount()));
+  m_groupSpinBox->setPrefix(tr("group "));
+  m_groupSpinBox->setEnabled(false);
+
+  auto filterLayout = new QHBoxLayout();
+  filterLayout->addWidget(m_filterComboBox);
+  filterLayout->addWidget(m_groupSpinBox);
+  filterLayout->addStretch();
 
   auto totalLayout = new QVBoxLayout();
+  totalLayout->addLayout(filterLayout);
   totalLayout->addWidget(m_tableView);
 
   setLayout(totalLayout);
 
   m_tableView->setSortingEnabled(false);
   m_tableView->setUpdatesEnabled(true);
-  m_tableView->horizontalHeader()->setMinimumSectionSize(CHANNEL_TABLE_ITEM_SIZE);
-  m_tableView->verticalHeader()->setMinimumSectionSize(CHANNEL_TABLE_ITEM_SIZE);
-  m_tableView->horizontalHeader()->hide();
-  m_tableView->verticalHeader()->hide();
+  // fixed sections : no cell is ever measured, position to index is
+  // a division, only visible rows are painted
+  for (const auto &item
+       : {m_tableView->horizontalHeader(),
+          m_tableView->verticalHeader()})
+  {
+    item->setMinimumSectionSize(CHANNEL_TABLE_ITEM_SIZE);
+    item->setDefaultSectionSize(CHANNEL_TABLE_ITEM_SIZE);
+    item->setSectionResizeMode(QHeaderView::Fixed);
+    item->hide();
+  }
+  m_tableView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+  m_tableView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
 
   m_tableView->setModel(m_model);
   m_tableView->setItemDelegate(m_channelDelegate);
 
-  m_tableView->resizeColumnsToContents();
-  m_tableView->resizeRowsToContents();
+  // no per channel connection, engine publishes at gui rate
+  m_model->setSnapshot(snapshot);
+  connect(snapshotPublisher,
+          &SnapshotPublisher::snapshotPublished,
+          this,
+          &ValueTableWidget::onSnapshotPublished);
 
-  connect(channelEngine,
-          &ChannelEngine::sigToUpdateChannelView,
+  connect(m_filterComboBox,
+          &QComboBox::activated,
+          this,
+          &ValueTableWidget::onFilterChanged);
+  connect(m_groupSpinBox,
+          &QSpinBox::valueChanged,
           this,
-          &ValueTableWidget::repaintTableView);
+          &ValueTableWidget::onFilterChanged);
 }
 
 ValueTableWidget::~ValueTableWidget()
 {}
 
-void ValueTableWidget::setRootValue(RootValue *t_rootValue)
+void ValueTableWidget::resizeEvent(QResizeEvent *event)
 {
-  // we connect to update views
-  auto L_dmxChannel = t_rootValue->getL_childValue();
-  for (const auto &item
-       : std::as_const(L_dmxChannel))
-  {
-    connect(item,
-            SIGNAL(levelChanged(id,dmx)),
-            this,
-            SLOT(repaintTableView()));
-  }
+  QWidget::resizeEvent(event);
+  auto width = m_tableView->viewport()->width();
+  m_model->setColumnCount(qMax(1,
+                               width / CHANNEL_TABLE_ITEM_SIZE));
 }
 
 void ValueTableWidget::setChannelEngine(ChannelEngine *t_cdEngine)
@@ -85,9 +123,79 @@ void ValueTableWidget::setChannelEngine(ChannelEngine *t_cdEngine)
   m_tableView->setChannelEngine(t_cdEngine);
 }
 
-void ValueTableWidget::repaintTableView()
+void ValueTableWidget::onSnapshotPublished(const ChannelSnapshot &t_snapshot)
 {
-  emit m_model->layoutChanged();
+  m_model->setSnapshot(t_snapshot);
+  if (t_snapshot.isGroupDirty())
+    m_groupSpinBox->setMaximum(qMax(1, t_snapshot.getGroupCount()));
+  if (t_snapshot.getMemberRevision() != m_memberRevision)
+    updateFilterMember(false);
+}
+
+void ValueTableWidget::onFilterChanged()
+{
+  auto filter = static_cast<ChannelViewFilter>(m_filterComboBox
+                                                   ->currentData().toInt());
+  m_groupSpinBox->setEnabled(filter == GroupChannelView);
+  if (filter == GroupChannelView
+      || filter == NextCueChannelView)
+  {
+    updateFilterMember(true);
+    return;
+  }
+  m_L_memberId.clear();
+  m_model->setFilter(filter);
+}
+
+void ValueTableWidget::updateFilterMember(bool t_isForced)
+{
+  m_memberRevision = m_model->getSnapshot().getMemberRevision();
+  auto filter = static_cast<ChannelViewFilter>(m_filterComboBox
+                                                   ->currentData().toInt());
+  if (filter != GroupChannelView
+      && filter != NextCueChannelView)
+  {
+    return;
+  }
+  auto groupId = m_groupSpinBox->value() - 1;
+
+  // groups and cues are edited in the engine thread, read there.
+  // Only on filter change or when a member revision is published
+  QList<id> L_memberId;
+  MANAGER->runInEngineThread([&]()
+  {
+    const DmxChannelGroup *group = nullptr;
+    if (filter == GroupChannelView)
+    {
+      auto rootGroup = MANAGER->getRootChannelGroup();
+      if (groupId < rootGroup->getL_childValueSize())
+        group = static_cast<DmxChannelGroup *>(rootGroup->getChildValue(groupId));
+    }
+    else
+    {
+      group = MANAGER->getDmxEngine()->getCueEngine()->getNextScene();
+    }
+    if (!group)
+      return;
+    auto H_channel = group->getH_controledChannel_storedLevel();
+    for (auto it = H_channel.cbegin();
+         it != H_channel.cend();
+         ++it)
+    {
+      L_memberId.append(it.key()->getid());
+    }
+  });
+  // hash order, same members may come in another one
+  std::sort(L_memberId.begin(),
+            L_memberId.end());
+  if (!t_isForced
+      && L_memberId == m_L_memberId)
+  {
+    return;
+  }
+  m_L_memberId = L_memberId;
+  m_model->setFilter(filter,
+                     L_memberId);
 }
 
 /************************* ValueTableView ******************************/
@@ -101,29 +209,32 @@ ValueTableView::~ValueTableView()
 
 void ValueTableView::mousePressEvent(QMouseEvent *event)
 {
+  // what is shown, from the snapshot
+  const auto &snapshot = getValueModel()->getSnapshot();
+  int valueID = getChannelIdFromIndex(indexAt(event->pos()));
+  if (!snapshot.isValidId(valueID))
+  {
+    QTableView::mousePressEvent(event);
+    return;
+  }
   if (event->button() == Qt::LeftButton)
   {
     m_isEditing = true;
     m_originEditingPoint = event->pos();
+    m_channelIdEdited = valueID;
+    m_editedLevel = snapshot.getLevel(valueID);
     return;
   }
   if (event->button() == Qt::RightButton)
   {
-    int valueID = getChannelIdFromIndex(indexAt(event->pos()));
-    if (valueID < 0 || valueID >= 512)
-    {
-      qDebug() << "bluk !";
-      return;
-    }
-    else
+    MANAGER->runInEngineThread([&]()
     {
-      auto channel = m_channelEngine->getChannel(valueID);
-      if (channel->getIsSelected())
+      if (m_channelEngine->getSelection().contains(valueID))
         m_channelEngine->removeIdFromL_select(valueID);
       else
         m_channelEngine->addIdToL_select(valueID);
-      return;
-    }
+    });
+    return;
   }
   QTableView::mousePressEvent(event);
 }
@@ -131,7 +242,10 @@ void ValueTableView::mousePressEvent(QMouseEvent *event)
 void ValueTableView::mouseReleaseEvent(QMouseEvent *event)
 {
   if (m_isEditing)
+  {
     m_isEditing = false;
+    m_channelIdEdited = NO_ID;
+  }
   QTableView::mouseReleaseEvent(event);
 }
 
@@ -144,14 +258,28 @@ void ValueTableView::mouseMoveEvent(QMouseEvent *event)
 {
   if (m_isEditing)
   {
-    auto channelDelegate = static_cast<ChannelDelegate*>(itemDelegate());
-    auto yValue = event->pos().y()
-                  - m_originEditingPoint.y();
-    if (yValue > 0)
-      channelDelegate->recieveValuePlusFromMouse(false);
-    else if (yValue < 0)
-      channelDelegate->recieveValuePlusFromMouse(true);
-    m_originEditingPoint = event->pos();
+    // up is plus. Only requests, engine applies the sum once per tick
+    auto step = (m_originEditingPoint.y() - event->pos().y())
+                / CHANNEL_TABLE_DRAG_STEP;
+    if (!step)
+      return;
+    m_originEditingPoint.ry() -= step * CHANNEL_TABLE_DRAG_STEP;
+
+    auto dmxEngine = MANAGER->getDmxEngine();
+    const auto &snapshot = getValueModel()->getSnapshot();
+    if (snapshot.isValidId(m_channelIdEdited)
+        && snapshot.getIsSelected(m_channelIdEdited))
+    {
+      dmxEngine->requestDirectChannelDelta(step);
+    }
+    else
+    {
+      m_editedLevel = qBound(NULL_DMX,
+                             m_editedLevel + step,
+                             MAX_DMX);
+      dmxEngine->requestChannelLevel(m_channelIdEdited,
+                                     static_cast<dmx>(m_editedLevel));
+    }
     return;
   }
   QTableView::mouseMoveEvent(event);
@@ -159,92 +287,346 @@ void ValueTableView::mouseMoveEvent(QMouseEvent *event)
 
 int ValueTableView::getChannelIdFromIndex(QModelIndex t_index)
 {
-  int valueID = ((t_index.row()
-                  * DMX_VALUE_TABLE_MODEL_COLUMNS_COUNT_DEFAULT)
-                 + t_index.column());
-  return valueID;
+  return getValueModel()->getChannelIdFromIndex(t_index);
+}
+
+/************************* ValueTableModel ******************************/
+
+QVariant ValueTableModel::data(const QModelIndex &index,
+                               int role) const
+{
+  auto channelId = getChannelIdFromIndex(index);
+  if (role != Qt::DisplayRole
+      || !m_snapshot.isValidId(channelId))
+  {
+    return QVariant();
+  }
+  return m_snapshot.getLevel(channelId);
+}
+
+void ValueTableModel::setColumnCount(int t_columnCount)
+{
+  if (t_columnCount == m_columnCount)
+    return;
+  beginResetModel();
+  m_columnCount = t_columnCount;
+  endResetModel();
+}
+
+QModelIndex ValueTableModel::getIndexFromChannelId(id t_id) const
+{
+  int position = m_filter == AllChannelView
+      ? t_id
+      : m_L_position.value(t_id, NO_ID);
+  if (position < 0)
+    return QModelIndex();
+  return index(position / m_columnCount,
+               position % m_columnCount);
+}
+
+id ValueTableModel::getChannelIdFromIndex(const QModelIndex &t_index) const
+{
+  if (!t_index.isValid())
+    return NO_ID;
+  int position = t_index.row() * m_columnCount + t_index.column();
+  if (m_filter == AllChannelView)
+    return static_cast<id>(position);
+  return position < m_L_visibleId.size()
+      ? m_L_visibleId.at(position)
+      : static_cast<id>(NO_ID);
+}
+
+void ValueTableModel::setFilter(ChannelViewFilter t_filter,
+                                const QList<id> &t_L_memberId)
+{
+  beginResetModel();
+  m_filter = t_filter;
+  m_L_isMember.fill(false,
+                    m_channelCount);
+  for (const auto &item
+       : std::as_const(t_L_memberId))
+  {
+    if (item >= 0
+        && item < m_channelCount)
+    {
+      m_L_isMember[item] = true;
+    }
+  }
+  rebuildVisible();
+  endResetModel();
+}
+
+bool ValueTableModel::isShown(id t_id) const
+{
+  switch (m_filter)
+  {
+  case NonNullChannelView :
+    return m_snapshot.getLevel(t_id) != NULL_DMX;
+  case SelectedChannelView :
+    return m_snapshot.getIsSelected(t_id);
+  case GroupChannelView :
+  case NextCueChannelView :
+    return m_L_isMember.at(t_id);
+  default :
+    return true;
+  }
+}
+
+void ValueTableModel::rebuildVisible()
+{
+  // one full pass, only when filter or channel count changes
+  m_L_visibleId.clear();
+  m_L_position.fill(NO_ID,
+                    m_channelCount);
+  m_L_isMember.resize(m_channelCount,
+                      false);
+  if (m_filter == AllChannelView)
+    return;
+  for (int i = 0;
+       i < m_channelCount;
+       i++)
+  {
+    if (isShown(i))
+    {
+      m_L_position[i] = m_L_visibleId.size();
+      m_L_visibleId.append(static_cast<id>(i));
+    }
+  }
+}
+
+bool ValueTableModel::updateVisible(id t_id)
+{
+  bool isShownNow = isShown(t_id);
+  if (isShownNow == (m_L_position.at(t_id) != NO_ID))
+    return false;
+  // positions after this one are fixed by caller
+  auto it = std::lower_bound(m_L_visibleId.begin(),
+                             m_L_visibleId.end(),
+                             t_id);
+  if (isShownNow)
+  {
+    m_L_visibleId.insert(it,
+                         t_id);
+    m_L_position[t_id] = 0;
+  }
+  else
+  {
+    m_L_visibleId.erase(it);
+    m_L_position[t_id] = NO_ID;
+  }
+  return true;
+}
+
+void ValueTableModel::setSnapshot(const ChannelSnapshot &t_snapshot)
+{
+  auto channelCount = qMin(t_snapshot.getChannelCount(),
+                           CHANNEL_TABLE_CHANNEL_COUNT_MAX);
+  if (channelCount != m_channelCount)
+  {
+    beginResetModel();
+    m_snapshot = t_snapshot;
+    m_channelCount = channelCount;
+    rebuildVisible();
+    endResetModel();
+    return;
+  }
+  m_snapshot = t_snapshot;
+  if (!m_snapshot.isDirty())
+    return;
+
+  auto L_dirtyId = m_snapshot.getL_dirtyId();
+  auto dirtyFirst = m_snapshot.getDirtyFirst();
+  auto dirtyLast = qMin(static_cast<int>(m_snapshot.getDirtyLast()),
+                        m_channelCount - 1);
+
+  if (m_filter != AllChannelView)
+  {
+    // cells move if one dirty channel enters or leaves the view
+    bool isMoved = false;
+    if (!m_snapshot.isRangeOnly())
+    {
+      for (const auto &item
+           : std::as_const(L_dirtyId))
+      {
+        if (item < m_channelCount
+            && isShown(item) != (m_L_position.at(item) != NO_ID))
+        {
+          isMoved = true;
+          break;
+        }
+      }
+    }
+    else
+    {
+      for (int i = dirtyFirst;
+           i <= dirtyLast && !isMoved;
+           i++)
+      {
+        isMoved = isShown(i) != (m_L_position.at(i) != NO_ID);
+      }
+    }
+
+    if (isMoved)
+    {
+      emit layoutAboutToBeChanged();
+      if (!m_snapshot.isRangeOnly())
+      {
+        for (const auto &item
+             : std::as_const(L_dirtyId))
+        {
+          if (item < m_channelCount)
+            updateVisible(item);
+        }
+      }
+      else
+      {
+        for (int i = dirtyFirst;
+             i <= dirtyLast;
+             i++)
+        {
+          updateVisible(i);
+        }
+      }
+      // positions only move from first dirty channel on
+      auto it = std::lower_bound(m_L_visibleId.cbegin(),
+                                 m_L_visibleId.cend(),
+                                 dirtyFirst);
+      for (auto i = it - m_L_visibleId.cbegin();
+           i < m_L_visibleId.size();
+           i++)
+      {
+        m_L_position[m_L_visibleId.at(i)] = i;
+      }
+      emit layoutChanged();
+      return;
+    }
+  }
+
+  if (!m_snapshot.isRangeOnly())
+  {
+    // few cells, repaint each one
+    for (const auto &item
+         : std::as_const(L_dirtyId))
+    {
+      auto cellIndex = getIndexFromChannelId(item);
+      if (cellIndex.isValid())
+        emit dataChanged(cellIndex,
+                         cellIndex);
+    }
+    return;
+  }
+  // many cells, repaint the rows in dirty range.
+  // The view clips to what is visible
+  int firstPosition = dirtyFirst;
+  int lastPosition = dirtyLast;
+  if (m_filter != AllChannelView)
+  {
+    firstPosition = std::lower_bound(m_L_visibleId.cbegin(),
+                                     m_L_visibleId.cend(),
+                                     dirtyFirst) - m_L_visibleId.cbegin();
+    lastPosition = std::upper_bound(m_L_visibleId.cbegin(),
+                                    m_L_visibleId.cend(),
+                                    dirtyLast) - m_L_visibleId.cbegin() - 1;
+  }
+  if (firstPosition > lastPosition)
+    return;
+  emit dataChanged(index(firstPosition / m_columnCount, 0),
+                   index(lastPosition / m_columnCount,
+                         m_columnCount - 1));
 }
 
 /************************* ChannelDelegate ******************************/
 
 ChannelDelegate::ChannelDelegate(QObject *parent)
     : QStyledItemDelegate(parent)
-{}
+{
+  m_L_flagColor.resize(UnknownFlag + 1,
+                       QColor(LIGHT_GREY_COLOR));
+  m_L_flagColor[SelectedSceneFlag] = QColor(LIGHT_GREEN_COLOR);
+  m_L_flagColor[DirectChannelFlag] = QColor(LIGHT_YELLOW_COLOR);
+  m_L_flagColor[ChannelGroupFlag] = QColor(LIGHT_BLUE_COLOR);
+  m_L_flagColor[ParkedFlag] = QColor(RED_COLOR);
+  m_L_flagColor[IndependantFlag] = QColor(PURPLE_COLOR);
+  m_L_flagColor[NetworkInputFlag] = QColor(ORANGE_COLOR);
+  m_L_flagColor[EffectFlag] = QColor(LIGHT_BROWN_COLOR);
+}
 
 void ChannelDelegate::paint(QPainter *painter,
                             const QStyleOptionViewItem &option,
                             const QModelIndex &index) const
 {
-  int valueID = ((index.row() * DMX_VALUE_TABLE_MODEL_COLUMNS_COUNT_DEFAULT)
-                 + index.column());
-  if (valueID < 0
-      || valueID >= m_channelEngine
-                        ->getRootChannel()->getL_childValueSize())
+  // paint what was published, never read the engine here
+  auto model = static_cast<const ValueTableModel *>(index.model());
+  const auto &snapshot = model->getSnapshot();
+  auto valueID = model->getChannelIdFromIndex(index);
+  if (!snapshot.isValidId(valueID))
+    return; // not published yet
+
+  if (m_L_levelText.isEmpty()
+      || painter->font() != m_textFont)
   {
-    qDebug() << "bluk !";
-    return;
+    prepareText(painter->font());
   }
-  auto channel = m_channelEngine->getChannel(valueID);
-  ChannelDataFlag flag = channel->getChannelDataFlag();
-  QColor dmxColor;
-  switch(flag)
-  {
-  case SelectedSceneFlag :
-    dmxColor = QColor(LIGHT_GREEN_COLOR);
-    break;
-  case DirectChannelFlag :
-    dmxColor = QColor(LIGHT_YELLOW_COLOR);
-    break;
-  case ChannelGroupFlag :
-    dmxColor = QColor(LIGHT_BLUE_COLOR);
-    break;
-  case ParkedFlag :
-    dmxColor = QColor(RED_COLOR);
-    break;
-  case IndependantFlag :
-    dmxColor = QColor(PURPLE_COLOR);
-    break;
-  default :
-    dmxColor = QColor(LIGHT_GREY_COLOR);
-    break;
-  }
-
-  QColor backGroundColor(Qt::black);
-  if (channel->getIsSelected())
-    backGroundColor = DARK_ORANGE_COLOR;
-
-  painter->save();
-  painter->fillRect(option.rect,
-                    backGroundColor);
-  painter->restore();
-
-  painter->save();
-  QPen dmxPen(dmxColor);
-  dmxPen.setWidth(3);
-  painter->setPen(dmxPen);
-  QTextOption textOption;
-  textOption.setAlignment(Qt::AlignBottom | Qt::AlignHCenter);
-  painter->drawText(option.rect,
-                    QString::number(channel->getLevel()),
-                    textOption);
-  painter->restore();
-
-  painter->save();
-  QPen idPen(Qt::white);
-  idPen.setWidth(3);
-  painter->setPen(idPen);
-  textOption.setAlignment(Qt::AlignTop | Qt::AlignHCenter);
-  painter->drawText(option.rect,
-                    QString::number(channel->getid() + 1),
-                    textOption);
-  painter->restore();
+
+  const auto &rect = option.rect;
+  painter->fillRect(rect,
+                    snapshot.getIsSelected(valueID)
+                        ? QColor(DARK_ORANGE_COLOR)
+                        : QColor(Qt::black));
+
+  // only pen changes, no save/restore, no text layout
+  auto pen = painter->pen();
+  const auto &idText = getIdText(valueID);
+  painter->setPen(Qt::white);
+  painter->drawStaticText(rect.center().x() - qRound(idText.size().width() / 2),
+                          rect.top(),
+                          idText);
+
+  const auto &levelText = m_L_levelText.at(snapshot.getLevel(valueID));
+  painter->setPen(m_L_flagColor.at(snapshot.getFlag(valueID)));
+  painter->drawStaticText(rect.center().x() - qRound(levelText.size().width() / 2),
+                          rect.bottom() + 1 - qRound(levelText.size().height()),
+                          levelText);
+  painter->setPen(pen);
+}
+
+void ChannelDelegate::prepareText(const QFont &t_font) const
+{
+  m_textFont = t_font;
+  m_L_levelText.resize(MAX_DMX + 1);
+  for (int i = 0;
+       i <= MAX_DMX;
+       i++)
+  {
+    auto &staticText = m_L_levelText[i];
+    staticText.setText(QString::number(i));
+    staticText.setPerformanceHint(QStaticText::AggressiveCaching);
+    staticText.prepare(QTransform(),
+                       t_font);
+  }
+  m_L_idText.clear(); // rebuilt on demand with new font
+}
+
+const QStaticText &ChannelDelegate::getIdText(id t_id) const
+{
+  while (m_L_idText.size() <= t_id)
+  {
+    QStaticText staticText(QString::number(m_L_idText.size() + 1));
+    staticText.setPerformanceHint(QStaticText::AggressiveCaching);
+    staticText.prepare(QTransform(),
+                       m_textFont);
+    m_L_idText.append(staticText);
+  }
+  return m_L_idText.at(t_id);
 }
 
 QSize ChannelDelegate::sizeHint(const QStyleOptionViewItem &option,
                                 const QModelIndex &index) const
 {
-  return QStyledItemDelegate::sizeHint(option,
-                                       index);
+  Q_UNUSED(option)
+  Q_UNUSED(index)
+  return QSize(CHANNEL_TABLE_ITEM_SIZE,
+               CHANNEL_TABLE_ITEM_SIZE);
 }
 
 void ChannelDelegate::recieveValuePlusFromMouse(const bool t_isPlus)
@@ -21,10 +21,12 @@
 #include <QWidget>
 #include <QLabel>
 #include <QSpinBox>
+#include <QComboBox>
 #include <QPushButton>
 #include <QTableView>
 #include <QAbstractTableModel>
 #include <QStyledItemDelegate>
+#include <QStaticText>
 #include <QEvent>
 #include "../core/dmxvalue.h"
 // #include "../core/channeldataengine.h"
@@ -46,9 +48,10 @@ public :
 
   virtual ~ValueTableWidget();
 
-private :
+protected :
 
-  void setRootValue(RootValue *t_rootValue);
+  // column count follows widget width
+  virtual void resizeEvent(QResizeEvent *event) override;
 
 public slots :
 
@@ -56,7 +59,15 @@ public slots :
 
 protected slots :
 
-  void repaintTableView();
+  // gui rate, from SnapshotPublisher
+  void onSnapshotPublished(const ChannelSnapshot &t_snapshot);
+  void onFilterChanged();
+
+private :
+
+  // group and cue members, only read again when the snapshot
+  // member revision moved
+  void updateFilterMember(bool t_isForced);
 
 protected :
 
@@ -64,6 +75,12 @@ protected :
   ValueTableModel *m_model;
   ChannelDelegate *m_channelDelegate;
 
+  QComboBox *m_filterComboBox;
+  QSpinBox *m_groupSpinBox;
+  // members shown, sorted, and the revision they were read at
+  QList<id> m_L_memberId;
+  quint64 m_memberRevision = 0;
+
 };
 
 /************************* ValueTableView ******************************/
@@ -93,6 +110,8 @@ protected :
 private :
 
   int getChannelIdFromIndex(QModelIndex t_index);
+  ValueTableModel *getValueModel() const
+  { return static_cast<ValueTableModel *>(model()); }
 
 signals :
 
@@ -107,6 +126,7 @@ protected :
   bool m_isEditing = false;
   QPoint m_originEditingPoint;
   id m_channelIdEdited = NO_ID;
+  int m_editedLevel = NULL_DMX; // unselected channel, follows the mouse
 
 };
 
@@ -127,15 +147,34 @@ public :
 
   virtual ~ValueTableModel(){}
 
+  const ChannelSnapshot &getSnapshot() const{ return m_snapshot; }
+  int getChannelCount() const{ return m_channelCount; }
+  int getColumnCount() const{ return m_columnCount; }
+  ChannelViewFilter getFilter() const{ return m_filter; }
+  // cells shown, all channels or filtered ones
+  int getVisibleCount() const
+  { return m_filter == AllChannelView ? m_channelCount : m_L_visibleId.size(); }
+  QModelIndex getIndexFromChannelId(id t_id) const;
+  id getChannelIdFromIndex(const QModelIndex &t_index) const;
+
+  // keeps the snapshot, emits dataChanged for changed cells only.
+  // Filtered views are updated from dirty ids, never rescanned
+  void setSnapshot(const ChannelSnapshot &t_snapshot);
+  void setColumnCount(int t_columnCount);
+  // t_L_memberId for group and next cue views
+  void setFilter(ChannelViewFilter t_filter,
+                 const QList<id> &t_L_memberId = QList<id>());
+
 protected :
 
   int rowCount(const QModelIndex &parent) const override
-  { return parent.isValid() ? 0 : DMX_VALUE_TABLE_MODEL_ROWS_COUNT_DEFAULT; }
+  { return parent.isValid()
+          ? 0
+          : (getVisibleCount() + m_columnCount - 1) / m_columnCount; }
   int columnCount(const QModelIndex &parent) const override
-  { return parent.isValid() ? 0 : DMX_VALUE_TABLE_MODEL_COLUMNS_COUNT_DEFAULT; }
+  { return parent.isValid() ? 0 : m_columnCount; }
   QVariant data(const QModelIndex &index,
-                int role) const override
-  { return QVariant(); }
+                int role) const override;
   bool setData(const QModelIndex &index,
                const QVariant &value,
                int role) override
@@ -153,8 +192,28 @@ protected :
   { return false; }
 
   Qt::ItemFlags flags(const QModelIndex &index) const override
-  { if (!index.isValid()) return Qt::NoItemFlags;
+  { if (!m_snapshot.isValidId(getChannelIdFromIndex(index)))
+      return Qt::NoItemFlags;
     return Qt::ItemIsEnabled;}
+
+private :
+
+  bool isShown(id t_id) const;
+  void rebuildVisible();
+  // return true if visibility changed
+  bool updateVisible(id t_id);
+
+private :
+
+  ChannelSnapshot m_snapshot;
+  int m_channelCount = 0;
+  int m_columnCount = DMX_VALUE_TABLE_MODEL_COLUMNS_COUNT_DEFAULT;
+
+  ChannelViewFilter m_filter = AllChannelView;
+  QList<bool> m_L_isMember; // by channel id
+  QList<id> m_L_visibleId; // sorted
+  QList<int> m_L_position; // by channel id, NO_ID when hidden
+
 };
 
 /************************* ChannelDelegate ******************************/
@@ -172,6 +231,7 @@ public:
   virtual void paint(QPainter *painter,
                      const QStyleOptionViewItem &option,
                      const QModelIndex &index) const override;
+  // fixed, the view never measures cells
   virtual QSize sizeHint(const QStyleOptionViewItem &option,
                          const QModelIndex &index) const override;
 
@@ -180,9 +240,20 @@ public:
   void setChannelEngine(ChannelEngine *t_channelEngine)
   { m_channelEngine = t_channelEngine; }
 
+private :
+
+  // static texts are laid out once, rebuilt only if font changes
+  void prepareText(const QFont &t_font) const;
+  const QStaticText &getIdText(id t_id) const;
+
 private :
 
   ChannelEngine *m_channelEngine;
+
+  QList<QColor> m_L_flagColor; // by ChannelDataFlag
+  mutable QFont m_textFont;
+  mutable QList<QStaticText> m_L_levelText; // 0 - 255
+  mutable QList<QStaticText> m_L_idText; // channel id + 1, grows on demand
 };
 
 #endif // VALUETABLEWIDGET_H
@@ -36,6 +36,8 @@
 #define SLIDERS_PER_PAGE 32
 
 #define CHANNEL_TABLE_ITEM_SIZE 43
+#define CHANNEL_TABLE_CHANNEL_COUNT_MAX 32767 // id is qint16
+#define CHANNEL_TABLE_DRAG_STEP 3 // pixels per dmx step
 
 #define DEFAULT_IN_TIME 5.0f
 #define DEFAULT_OUT_TIME 5.0f
@@ -85,6 +87,7 @@ typedef quint8 percent;
 #define NULL_DMX 0
 #define NULL_DMX_OFFSET 0
 #define NULL_UID_ID Uid_Id(NO_UID,NO_ID)
+#define NO_HANDLE_INDEX 0xFFFFFFFFu
 #define MAX_DMX 255
 
 #define DEFAULT_OUTPUT_NAME "OUT"
@@ -101,9 +104,92 @@ typedef quint8 percent;
 
 #define DMX_INCREMENT_MIN 1
 #define DMX_INCREMENT_DEFAULT 13
+#define OVERDMX_MAX 0x7fff // overdmx is qint16
+#define NO_FAN_LEVEL -1
+#define SCALE_PERCENT_MAX (100 * MAX_DMX) // a level of 1 goes to full
 
 #define MS_TO_S 1000
 
+// output thread
+#define OUTPUT_REFRESH_RATE_DEFAULT 44 // Hz
+#define OUTPUT_KEEPALIVE_INTERVAL_DEFAULT 1000 // ms, resend unchanged universes
+
+#define NETWORK_SEND_BUFFER_SIZE (4 * 1024 * 1024)
+
+// Art-Net
+#define ARTNET_PORT 6454
+#define ARTNET_HEADER_SIZE 18
+#define ARTNET_PROTOCOL_VERSION 14
+#define ARTNET_OPCODE_DMX 0x5000
+
+// sACN (E1.31)
+#define SACN_PORT 5568
+#define SACN_PACKET_SIZE 638 // with 512 slots
+#define SACN_DMX_OFFSET 126 // first slot after start code
+#define SACN_PRIORITY_DEFAULT 100
+#define SACN_PRIORITY_MAX 200
+#define SACN_SOURCE_NAME_SIZE 64
+#define SACN_TERMINATED_PACKET_COUNT 3
+#define SACN_MULTICAST_TTL 8
+
+// network input
+#define NETWORK_INPUT_SOURCE_MAX 4 // merged sources per universe
+#define NETWORK_INPUT_SOURCE_TIMEOUT 2500 // ms
+#define NETWORK_INPUT_TIMEOUT_CHECK_INTERVAL 250 // ms
+#define NETWORK_INPUT_DATAGRAM_SIZE_MAX 1500
+#define NETWORK_RECEIVE_BUFFER_SIZE (4*1024*1024)
+#define SACN_SEQUENCE_REJECT_RANGE 20 // E1.31 6.7.2
+
+// osc
+#define OSC_PORT_DEFAULT 8000
+#define OSC_FEEDBACK_PORT_DEFAULT 9000
+#define OSC_PACKET_SIZE_MAX 8192
+#define OSC_BUNDLE_DEPTH_MAX 4
+#define OSC_MESSAGE_SIZE_MAX 64 // feedback message
+#define OSC_FEEDBACK_MESSAGE_MAX 256 // per tick and target
+
+// midi
+#define MIDI_CLIENT_NAME "Qontrejour"
+#define MIDI_PORT_NAME "Qontrejour in"
+#define MIDI_QUEUE_SIZE 1024 // power of 2
+#define MIDI_POLL_TIMEOUT 100 // ms
+#define MIDI_CHANNEL_COUNT 16
+#define MIDI_NUMBER_COUNT 128
+
+// engine
+#define ENGINE_TICK_INTERVAL 23 // ms, ~44 Hz
+#define ENGINE_COMMAND_QUEUE_SIZE 4096 // power of 2, also max drained per tick
+
+// latency
+#define LATENCY_SUB_BUCKET_COUNT 4 // histogram buckets per power of 2
+#define LATENCY_BUCKET_COUNT 160 // up to 2^40 ns, ~18 min
+#define LATENCY_STATS_REFRESH_INTERVAL 500 // ms, stats dock
+
+// watchdog
+#define WATCHDOG_POLL_INTERVAL 10 // ms
+#define WATCHDOG_STALL_THRESHOLD_DEFAULT 100 // ms without heartbeat
+#define WATCHDOG_STALL_EVENT_MAX 32 // last stalls kept
+
+// effects
+#define EFFECT_RATE_DEFAULT 1.0f // Hz, cycles per second
+#define EFFECT_PHASE_SPREAD_DEFAULT 1.0f // cycles across the channels
+#define EFFECT_SEED_DEFAULT 0x2545f491u // random waveform
+
+// show arena
+#define VALUE_ARENA_CHUNK_SIZE 256 // slots per chunk, values never move
+
+// trace
+#define TRACE_BUFFER_SIZE 65536 // events per thread, power of 2
+#define TRACE_FILE_DEFAULT "qontrejour-trace.json"
+
+// gui
+#define GUI_REFRESH_INTERVAL 33 // ms, ~30 Hz
+#define SNAPSHOT_DIRTY_ID_MAX 64 // above, views repaint the dirty range
+#define OUTPUT_MONITOR_IMAGE_WIDTH 32 // slots per image line
+#define OUTPUT_MONITOR_IMAGE_HEIGHT 16 // 32 x 16 = 512 slots
+#define OUTPUT_MONITOR_TILE_WIDTH_MIN 96 // px
+#define OUTPUT_MONITOR_TILE_SPACING 4 // px
+
 enum KeypadButton
 {
   Zero, One, Two, Three, Four, Five, Six, Seven, Eight, Nine, Dot,
@@ -113,6 +199,7 @@ enum KeypadButton
   Patch, Unpatch,
   Plus, Moins, Clear, All, Thru,
   Pluspc, Moinspc, ArobaseDmx, ArobasePercent,
+  Scale, Fan, Vfan,
   Step, Goto,
   Help,
   UnknownButton
@@ -149,9 +236,82 @@ enum ChannelDataFlag
   ChannelGroupFlag,
   ParkedFlag,
   IndependantFlag,
+  NetworkInputFlag,
+  EffectFlag,
   UnknownFlag
 };
 
+enum MidiEventType
+{
+  MidiControlChange,
+  MidiNote,
+  UnknownMidiEvent
+};
+
+enum MidiTargetType
+{
+  NoMidiTarget,
+  MidiGroupTarget, // submaster
+  MidiChannelTarget, // direct channel
+  MidiPlayBackTarget
+};
+
+enum InputMergeMode
+{
+  HtpMerge, // highest takes precedence
+  LtpMerge // latest takes precedence
+};
+
+enum EffectWaveform
+{
+  SineWave,
+  RampWave,
+  SquareWave,
+  RandomWave, // new level each cycle
+  StepWave, // chase, one channel after the other with full spread
+  UnknownWaveform
+};
+
+// how the effect layer goes over channel levels
+enum EffectMergeMode
+{
+  HtpEffect, // 0 to size, highest takes precedence
+  RelativeEffect // -size / 2 to size / 2, added
+};
+
+enum ChannelViewFilter
+{
+  AllChannelView,
+  NonNullChannelView,
+  SelectedChannelView,
+  GroupChannelView, // members of one group
+  NextCueChannelView, // channels stored in next cue of main seq
+  UnknownChannelView
+};
+
+// what an EngineCommand carries in its value
+enum EngineCommandType
+{
+  ChannelLevelCommand, // level
+  GroupLevelCommand, // level
+  DirectChannelDeltaCommand, // delta on selected channels
+  KeypadCommand, // KeypadButton
+  PlayBackCommand, // PlayBackButton
+  UnknownEngineCommand
+};
+
+// every stage is measured from the input event (keypad, slider,
+// midi, osc, go) which caused it
+enum LatencyStage
+{
+  EngineLatencyStage, // engine tick takes the input
+  InterpreterLatencyStage, // keypad buttons interpreted
+  MergeLatencyStage, // levels merged, outputs and hardware written
+  FrameLatencyStage, // output thread built the frame
+  SendLatencyStage, // frame sent by network sinks
+  UnknownLatencyStage
+};
+
 enum HwPortType
 {
   HwInput,
@@ -165,6 +325,13 @@ enum WidgetType
   UnknownWidgetType
 };
 
+// levels spread across the selection, first to last selected
+enum FanMode
+{
+  LinearFan, // first level to last level
+  SymmetricFan // first level at the middle, last level at both ends
+};
+
 enum SelectionType
 {
   ChannelSelectionType,
@@ -435,6 +602,37 @@ private :
   sceneID_f m_sceneId;
 };
 
+/******************************** ValueHandle *********************************/
+
+// slot of a value in its arena, and the slot generation when the value
+// was created. A destroyed slot gets a new generation : handles kept
+// on the old value are stale, checked in O(1)
+class ValueHandle
+{
+public :
+
+  explicit ValueHandle(quint32 t_index = NO_HANDLE_INDEX,
+                       quint32 t_generation = 0)
+      : m_index(t_index),
+      m_generation(t_generation)
+  {}
+
+  bool operator==(const ValueHandle t_handle) const
+  { return ((t_handle.getIndex() == m_index)
+            && (t_handle.getGeneration() == m_generation)); }
+  bool operator!=(const ValueHandle t_handle) const
+  { return !(*this == t_handle); }
+
+  bool isNull() const{ return m_index == NO_HANDLE_INDEX; }
+  quint32 getIndex() const{ return m_index; }
+  quint32 getGeneration() const{ return m_generation; }
+
+private :
+
+  quint32 m_index;
+  quint32 m_generation;
+};
+
 /******************************* static methods *******************************/
 
 
@@ -0,0 +1,347 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// qontrejour-receive : loopback check of our own output.
+// qontrejour-engine --artnet 127.0.0.1 (or --sacn) on one side,
+// qontrejour-receive --artnet (or --sacn) on the other. Every packet
+// header is checked, sequence must go up by one per universe, frame
+// rate must stay under --rate and no universe may be silent longer
+// than keep alive.
+// Exit code is 1 if something was wrong or nothing was received.
+
+#include "qontrejour.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QUdpSocket>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QTextStream>
+#include <QMap>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+
+// silence allowed between two packets of a universe,
+// keep alive with some margin for the receiver side
+#define RECEIVE_GAP_MAX (OUTPUT_KEEPALIVE_INTERVAL_DEFAULT * 3 / 2) // ms
+#define RECEIVE_RATE_TOLERANCE 1.1
+
+struct ReceiveUniverse
+{
+  int m_lastSequence = -1;
+  quint64 m_frameCount = 0;
+  quint64 m_sequenceErrorCount = 0;
+  qint64 m_firstTime = -1; // ms
+  qint64 m_lastTime = -1;
+  qint64 m_gapMax = 0;
+};
+
+class ReceiveStats
+{
+
+public :
+
+  explicit ReceiveStats(const QString &t_name)
+    : m_name(t_name)
+  { m_clock.start(); }
+
+  void addBadPacket(){ m_badPacketCount++; }
+  // next packet of this universe starts a new sequence
+  void endStream(int t_universe)
+  { m_M_universe[t_universe].m_lastSequence = -1; }
+
+  // t_nextSequence : expected sequence after t_lastSequence
+  void addFrame(int t_universe,
+                int t_sequence,
+                int (*t_nextSequence)(int))
+  {
+    auto now = m_clock.elapsed();
+    auto &universe = m_M_universe[t_universe];
+    if (universe.m_lastSequence >= 0
+        && t_sequence != t_nextSequence(universe.m_lastSequence))
+    {
+      universe.m_sequenceErrorCount++;
+    }
+    universe.m_lastSequence = t_sequence;
+    if (universe.m_firstTime < 0)
+      universe.m_firstTime = now;
+    else
+      universe.m_gapMax = qMax(universe.m_gapMax,
+                               now - universe.m_lastTime);
+    universe.m_lastTime = now;
+    universe.m_frameCount++;
+  }
+
+  // print one line per universe, return true if everything went right
+  bool dump(QTextStream &t_stream,
+            int t_rateMax) const
+  {
+    bool isOk = !m_M_universe.isEmpty()
+        && !m_badPacketCount;
+    if (m_M_universe.isEmpty())
+      t_stream << m_name << " : nothing received\n";
+    if (m_badPacketCount)
+      t_stream << m_name << " : " << m_badPacketCount << " bad packets\n";
+
+    for (auto i = m_M_universe.cbegin();
+         i != m_M_universe.cend();
+         ++i)
+    {
+      const auto &universe = i.value();
+      auto duration = universe.m_lastTime - universe.m_firstTime;
+      double rate = duration > 0
+          ? (universe.m_frameCount - 1) * 1000.0 / duration
+          : 0;
+      bool isRateOk = rate <= t_rateMax * RECEIVE_RATE_TOLERANCE;
+      bool isGapOk = universe.m_gapMax <= RECEIVE_GAP_MAX;
+      t_stream << m_name << " universe " << i.key()
+               << " : frames " << universe.m_frameCount
+               << " rate " << QString::number(rate, 'f', 1) << " Hz"
+               << (isRateOk ? "" : " (too fast)")
+               << " gap max " << universe.m_gapMax << " ms"
+               << (isGapOk ? "" : " (too long)")
+               << " sequence errors " << universe.m_sequenceErrorCount
+               << "\n";
+      isOk = isOk
+          && isRateOk
+          && isGapOk
+          && !universe.m_sequenceErrorCount;
+    }
+    return isOk;
+  }
+
+private :
+
+  QString m_name;
+  QElapsedTimer m_clock;
+  QMap<int, ReceiveUniverse> m_M_universe;
+  quint64 m_badPacketCount = 0;
+
+};
+
+// Art-Net sequence goes 1 to 255, 0 means disabled
+static int nextArtNetSequence(int t_sequence)
+{
+  return t_sequence == 255 ? 1 : t_sequence + 1;
+}
+
+static void parseArtNet(const char *t_data,
+                        qint64 t_size,
+                        ReceiveStats &t_stats)
+{
+  if (t_size < ARTNET_HEADER_SIZE
+      || std::memcmp(t_data, "Art-Net", 8) != 0)
+  {
+    t_stats.addBadPacket();
+    return;
+  }
+  if (qFromLittleEndian<quint16>(t_data + 8) != ARTNET_OPCODE_DMX)
+    return; // poll, sync... not our business
+  int length = qFromBigEndian<quint16>(t_data + 16);
+  if (qFromBigEndian<quint16>(t_data + 10) < ARTNET_PROTOCOL_VERSION
+      || length < 2
+      || length > UNIVERSE_OUTPUT_COUNT_DEFAULT
+      || length & 1
+      || t_size != ARTNET_HEADER_SIZE + length)
+  {
+    t_stats.addBadPacket();
+    return;
+  }
+  auto sequence = static_cast<quint8>(t_data[12]);
+  if (!sequence)
+  {
+    t_stats.addBadPacket(); // we always send sequenced
+    return;
+  }
+  auto universe = qFromLittleEndian<quint16>(t_data + 14) & 0x7fff;
+  t_stats.addFrame(universe,
+                   sequence,
+                   nextArtNetSequence);
+}
+
+// sACN sequence goes 0 to 255
+static int nextSacnSequence(int t_sequence)
+{
+  return (t_sequence + 1) & 0xff;
+}
+
+static void parseSacn(const char *t_data,
+                      qint64 t_size,
+                      ReceiveStats &t_stats)
+{
+  if (t_size <= SACN_DMX_OFFSET
+      || qFromBigEndian<quint16>(t_data) != 0x0010 // preamble size
+      || std::memcmp(t_data + 4, "ASC-E1.17\0\0\0", 12) != 0
+      || qFromBigEndian<quint32>(t_data + 18) != 0x00000004 // root : data
+      || qFromBigEndian<quint32>(t_data + 40) != 0x00000002 // framing : dmp
+      || t_data[117] != 0x02 // dmp : set property
+      || static_cast<quint8>(t_data[118]) != 0xa1
+      || t_data[125] != 0x00) // start code
+  {
+    t_stats.addBadPacket();
+    return;
+  }
+  // property value count includes start code
+  int length = qFromBigEndian<quint16>(t_data + 123) - 1;
+  auto priority = static_cast<quint8>(t_data[108]);
+  auto sequence = static_cast<quint8>(t_data[111]);
+  auto options = static_cast<quint8>(t_data[112]);
+  auto universe = qFromBigEndian<quint16>(t_data + 113);
+  if (length < 1
+      || length > UNIVERSE_OUTPUT_COUNT_DEFAULT
+      || t_size != SACN_DMX_OFFSET + length
+      || priority > SACN_PRIORITY_MAX
+      || universe < 1)
+  {
+    t_stats.addBadPacket();
+    return;
+  }
+  if (options & 0x40) // stream terminated, sent in a burst on close
+  {
+    t_stats.endStream(universe);
+    return;
+  }
+  t_stats.addFrame(universe,
+                   sequence,
+                   nextSacnSequence);
+}
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication a(argc, argv);
+  QCoreApplication::setApplicationName("qontrejour-receive");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Check Qontrejour network output");
+  parser.addHelpOption();
+
+  QCommandLineOption artNetOption("artnet",
+                                  "Receive Art-Net.");
+  QCommandLineOption sacnOption("sacn",
+                                "Receive sACN, multicast universes 1 to count.",
+                                "count");
+  QCommandLineOption bindOption("bind",
+                                "Address to listen on.",
+                                "address",
+                                "0.0.0.0");
+  QCommandLineOption durationOption("duration",
+                                    "Receive during.",
+                                    "s",
+                                    "5");
+  QCommandLineOption rateOption("rate",
+                                "Sender refresh rate.",
+                                "Hz",
+                                QString::number(OUTPUT_REFRESH_RATE_DEFAULT));
+  parser.addOption(artNetOption);
+  parser.addOption(sacnOption);
+  parser.addOption(bindOption);
+  parser.addOption(durationOption);
+  parser.addOption(rateOption);
+  parser.process(a);
+
+  bool isArtNet = parser.isSet(artNetOption);
+  bool isSacn = parser.isSet(sacnOption);
+  if (!isArtNet
+      && !isSacn)
+  {
+    parser.showHelp(1);
+  }
+
+  QByteArray datagram(NETWORK_INPUT_DATAGRAM_SIZE_MAX, 0);
+  ReceiveStats artNetStats("Art-Net");
+  ReceiveStats sacnStats("sACN");
+
+  QUdpSocket artNetSocket;
+  if (isArtNet
+      && !artNetSocket.bind(QHostAddress(parser.value(bindOption)),
+                         ARTNET_PORT,
+                         QUdpSocket::ShareAddress
+                             | QUdpSocket::ReuseAddressHint))
+  {
+    qWarning() << "can't bind Art-Net" << artNetSocket.errorString();
+    return 1;
+  }
+  QObject::connect(&artNetSocket, &QUdpSocket::readyRead, [&]
+  {
+    while (artNetSocket.hasPendingDatagrams())
+    {
+      auto size = artNetSocket.readDatagram(datagram.data(),
+                                            datagram.size());
+      if (size < 0)
+        break;
+      parseArtNet(datagram.constData(),
+                  size,
+                  artNetStats);
+    }
+  });
+
+  // multicast needs any address, --bind 127.0.0.1 only gets unicast
+  QUdpSocket sacnSocket;
+  if (isSacn
+      && !sacnSocket.bind(QHostAddress(parser.value(bindOption)),
+                          SACN_PORT,
+                          QUdpSocket::ShareAddress
+                              | QUdpSocket::ReuseAddressHint))
+  {
+    qWarning() << "can't bind sACN" << sacnSocket.errorString();
+    return 1;
+  }
+  if (isSacn)
+  {
+    auto universeCount = parser.value(sacnOption).toInt();
+    for (int i = 1;
+         i <= universeCount;
+         i++)
+    {
+      auto group = QHostAddress(0xefff0000u | static_cast<quint32>(i));
+      if (!sacnSocket.joinMulticastGroup(group))
+        qWarning() << "can't join sACN multicast group" << group.toString();
+    }
+  }
+  QObject::connect(&sacnSocket, &QUdpSocket::readyRead, [&]
+  {
+    while (sacnSocket.hasPendingDatagrams())
+    {
+      auto size = sacnSocket.readDatagram(datagram.data(),
+                                          datagram.size());
+      if (size < 0)
+        break;
+      parseSacn(datagram.constData(),
+                size,
+                sacnStats);
+    }
+  });
+
+  QTimer::singleShot(parser.value(durationOption).toInt() * 1000,
+                     &a,
+                     &QCoreApplication::quit);
+  a.exec();
+
+  QTextStream stream(stdout);
+  auto rateMax = parser.value(rateOption).toInt();
+  bool isOk = true;
+  if (isArtNet)
+    isOk = artNetStats.dump(stream,
+                            rateMax);
+  if (isSacn)
+    isOk = sacnStats.dump(stream,
+                          rateMax)
+        && isOk;
+  stream << (isOk ? "ok\n" : "failed\n");
+  return isOk ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+/*
+ * (c) 2024 Michaël Creusy -- creusy(.)michael(@)gmail(.)com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// qontrejour-render : plays a show against a virtual clock and writes
+// every output frame, faster than real time. Same show and gos give
+// the same file : golden data for regression and performance checks.
+// Output is raw, each frame is every universe one after the other,
+// UNIVERSE_OUTPUT_COUNT_DEFAULT slots each.
+
+#include "core/dmxmanager.h"
+#include "core/showfile.h"
+#include "core/virtualclock.h"
+#include "core/trace.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLoggingCategory>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QFile>
+#include <QDebug>
+#include <algorithm>
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication a(argc, argv);
+  QCoreApplication::setApplicationName("qontrejour-render");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Render a show offline at a fixed timestep");
+  parser.addHelpOption();
+  parser.addPositionalArgument("show",
+                               "Json show file.");
+
+  QCommandLineOption outputOption(QStringList() << "o" << "output",
+                                  "Raw frame file.",
+                                  "file");
+  QCommandLineOption goOption("go",
+                              "Go times, comma separated.",
+                              "s,s...");
+  QCommandLineOption rateOption("rate",
+                                "Frames per second.",
+                                "Hz",
+                                QString::number(OUTPUT_REFRESH_RATE_DEFAULT));
+  QCommandLineOption durationOption("duration",
+                                    "Stop at, default is when last go fade ends.",
+                                    "s");
+  parser.addOption(outputOption);
+  parser.addOption(goOption);
+  parser.addOption(rateOption);
+  QCommandLineOption traceOption("trace",
+                                 "Chrome trace of the render, QONTREJOUR_TRACE builds only.",
+                                 "file");
+  QCommandLineOption scriptOption("script",
+                                  "Text commands run as one batch once the show is loaded.",
+                                  "file");
+  parser.addOption(durationOption);
+  parser.addOption(traceOption);
+  parser.addOption(scriptOption);
+  parser.process(a);
+
+  if (parser.positionalArguments().size() != 1
+      || !parser.isSet(outputOption))
+  {
+    parser.showHelp(1);
+  }
+  auto rate = parser.value(rateOption).toInt();
+  if (rate < 1)
+  {
+    qWarning() << "can't render, bad rate";
+    return 1;
+  }
+  // ms
+  QList<qint64> L_goTime;
+  const auto L_goString = parser.value(goOption).split(',',
+                                                       Qt::SkipEmptyParts);
+  for (const auto &item
+       : L_goString)
+  {
+    L_goTime.append(qRound64(item.toDouble() * MS_TO_S));
+  }
+  std::sort(L_goTime.begin(),
+            L_goTime.end());
+  qint64 duration = parser.isSet(durationOption)
+      ? qRound64(parser.value(durationOption).toDouble() * MS_TO_S)
+      : -1;
+
+  // interpreter and engine debug output
+  QLoggingCategory::setFilterRules("default.debug=false");
+
+  // before any fade starts
+  VirtualAnimationDriver driver;
+  driver.install();
+
+  auto manager = MANAGER;
+  auto dmxEngine = manager->getDmxEngine();
+  auto cueEngine = dmxEngine->getCueEngine();
+  dmxEngine->getSnapshotPublisher()->stop();
+
+  ShowFile showFile;
+  if (!showFile.load(parser.positionalArguments().at(0)))
+    return 1;
+  if (parser.isSet(scriptOption))
+  {
+    QFile scriptFile(parser.value(scriptOption));
+    if (!scriptFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+      qWarning() << "can't read script" << scriptFile.fileName()
+                 << scriptFile.errorString();
+      return 1;
+    }
+    if (manager->commandToInterpreter(QString::fromUtf8(scriptFile.readAll())) < 0)
+      return 1;
+  }
+
+  QFile outputFile(parser.value(outputOption));
+  if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qWarning() << "can't render to" << outputFile.fileName()
+               << outputFile.errorString();
+    return 1;
+  }
+
+  auto frameBuffer = manager->getOutputThread()->getFrameBuffer();
+  QList<QByteArray> L_frame;
+  QList<bool> L_isChanged;
+  if (parser.isSet(traceOption))
+    Tracer::instance()->start();
+  QElapsedTimer wallClock;
+  wallClock.start();
+
+  qint64 frameCount = 0;
+  qsizetype goIndex = 0;
+  for (;;)
+  {
+    qint64 frameTime = frameCount * MS_TO_S / rate;
+    if (duration >= 0)
+    {
+      if (frameTime > duration)
+        break;
+    }
+    else if (goIndex == L_goTime.size()
+             && cueEngine->state() == QAbstractAnimation::Stopped)
+    {
+      break;
+    }
+
+    while (goIndex < L_goTime.size()
+           && L_goTime.at(goIndex) <= frameTime)
+    {
+      cueEngine->goGo();
+      goIndex++;
+    }
+    driver.advanceTo(frameTime);
+    dmxEngine->onTick();
+
+    frameBuffer->copyFrames(L_frame,
+                            L_isChanged);
+    for (auto &item
+         : L_frame)
+    {
+      // universe never written yet
+      if (item.size() != UNIVERSE_OUTPUT_COUNT_DEFAULT)
+        item.fill(static_cast<char>(NULL_DMX),
+                  UNIVERSE_OUTPUT_COUNT_DEFAULT);
+      outputFile.write(item);
+    }
+    frameCount++;
+  }
+  outputFile.close();
+
+  auto wallTime = wallClock.elapsed();
+  auto renderTime = frameCount * MS_TO_S / rate;
+  QTextStream(stdout) << "cues " << showFile.getCueCount()
+                      << " frames " << frameCount
+                      << " universes " << L_frame.size()
+                      << " rendered " << renderTime << " ms"
+                      << " in " << wallTime << " ms"
+                      << " x" << (wallTime ? renderTime / wallTime : renderTime)
+                      << Qt::endl;
+
+  if (parser.isSet(traceOption))
+  {
+    Tracer::instance()->stop();
+    if (!Tracer::instance()->exportChromeJson(parser.value(traceOption)))
+      return 1;
+  }
+  return 0;
+}